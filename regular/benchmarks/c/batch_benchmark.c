@@ -0,0 +1,118 @@
+/**
+ * batch_benchmark.c - BetterString批量转换性能测试
+ * 
+ * 比较逐个调用bs_string_to_lower/bs_string_trim_ex（每个结果单独分配）与
+ * bs_string_array_to_lower/bs_string_array_trim（结果写入一块连续内存），
+ * 批量版本分别使用单线程和不同大小的线程池
+ * 用法: c_batch_benchmark [字符串数量]
+ */
+
+#include "better_string.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_seconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t next_random(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static bs_string_array* make_records(size_t count) {
+    static const char* fields[] = {"User-Agent", "Content-Type", "X-Request-ID", "Accept-Language"};
+    bs_string_array* array = (bs_string_array*)malloc(sizeof(bs_string_array));
+    if (!array) {
+        return NULL;
+    }
+    array->items = (bs_string**)calloc(count, sizeof(bs_string*));
+    array->length = count;
+    if (!array->items) {
+        free(array);
+        return NULL;
+    }
+    
+    uint64_t state = 88172645463325252ULL;
+    char buffer[256];
+    for (size_t i = 0; i < count; i++) {
+        uint64_t r = next_random(&state);
+        int length = snprintf(buffer, sizeof(buffer), "  %s: Mozilla/5.0 (Session-%08X; Build %u) Gecko/%u \t",
+                              fields[r % 4], (unsigned)(r >> 16), (unsigned)(r >> 48) % 1000,
+                              (unsigned)(r >> 8) % 100000);
+        array->items[i] = bs_string_new_len(buffer, (size_t)length);
+    }
+    return array;
+}
+
+static void run_single(const char* label, bs_string_array* source, bool lower) {
+    // 结果保留到计时结束，和批量版本一样持有全部输出
+    bs_string** results = (bs_string**)malloc(source->length * sizeof(bs_string*));
+    if (!results) {
+        return;
+    }
+    double start = now_seconds();
+    size_t total = 0;
+    for (size_t i = 0; i < source->length; i++) {
+        results[i] = lower ? bs_string_to_lower(source->items[i])
+                           : bs_string_trim_ex(source->items[i], BS_TRIM_BOTH);
+        total += results[i] ? results[i]->byte_length : 0;
+    }
+    double elapsed = now_seconds() - start;
+    printf("  %-40s %8.1f ms (%zu 字节)\n", label, elapsed * 1000, total);
+    for (size_t i = 0; i < source->length; i++) {
+        bs_string_free(results[i]);
+    }
+    free(results);
+}
+
+static void run_batch(const char* name, bs_string_array* source, bool lower, size_t threads) {
+    bs_thread_pool* pool = threads == 1 ? NULL : bs_thread_pool_new(threads);
+    char label[64];
+    if (threads == 1) {
+        snprintf(label, sizeof(label), "%s(单线程)", name);
+    } else {
+        snprintf(label, sizeof(label), "%s(%zu 线程)", name, bs_thread_pool_size(pool));
+    }
+    
+    double start = now_seconds();
+    bs_compact_array* result = lower ? bs_string_array_to_lower(source, pool)
+                                     : bs_string_array_trim(source, BS_TRIM_BOTH, pool);
+    double elapsed = now_seconds() - start;
+    printf("  %-40s %8.1f ms (%zu 字节)\n", label, elapsed * 1000,
+           result ? result->offsets[result->length] : 0);
+    bs_compact_array_free(result);
+    bs_thread_pool_free(pool);
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 2000000;
+    printf("==== BetterString 批量转换性能测试 ====\n\n");
+    
+    bs_string_array* records = make_records(count);
+    if (!records) {
+        return 1;
+    }
+    
+    static const size_t threads[] = {1, 2, 4, 0};
+    printf("转小写（%zu 个）\n", count);
+    run_single("逐个 bs_string_to_lower", records, true);
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+        run_batch("bs_string_array_to_lower", records, true, threads[t]);
+    }
+    
+    printf("修剪空白（%zu 个）\n", count);
+    run_single("逐个 bs_string_trim_ex", records, false);
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+        run_batch("bs_string_array_trim", records, false, threads[t]);
+    }
+    
+    bs_string_array_free(records);
+    return 0;
+}
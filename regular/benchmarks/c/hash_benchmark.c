@@ -0,0 +1,78 @@
+/**
+ * hash_benchmark.c - BetterString哈希性能测试
+ * 
+ * 比较bs_hash与逐字节的FNV-1a在不同输入长度下的吞吐量
+ */
+
+#include "better_string.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TOTAL_BYTES (256u << 20)
+
+static double now_seconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t fnv1a(const void* data, size_t length) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+int main(void) {
+    printf("==== BetterString 哈希性能测试 ====\n\n");
+    
+    size_t buffer_size = 1u << 20;
+    uint8_t* buffer = (uint8_t*)malloc(buffer_size);
+    if (!buffer) {
+        return 1;
+    }
+    uint64_t state = 88172645463325252ULL;
+    for (size_t i = 0; i < buffer_size; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        buffer[i] = (uint8_t)state;
+    }
+    
+    static const size_t lengths[] = {8, 16, 32, 64, 256, 4096, 1u << 20};
+    printf("%10s %16s %16s\n", "长度", "bs_hash", "FNV-1a");
+    
+    uint64_t checksum = 0;
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        size_t length = lengths[l];
+        size_t iterations = TOTAL_BYTES / length;
+        // 短输入在缓冲区内错开起点，避免每次都是同一份数据
+        size_t span = buffer_size - length;
+        
+        double start = now_seconds();
+        for (size_t i = 0; i < iterations; i++) {
+            size_t offset = span ? (i * 64) % span : 0;
+            checksum += bs_hash(buffer + offset, length, i);
+        }
+        double bs_time = now_seconds() - start;
+        
+        start = now_seconds();
+        for (size_t i = 0; i < iterations; i++) {
+            size_t offset = span ? (i * 64) % span : 0;
+            checksum += fnv1a(buffer + offset, length);
+        }
+        double fnv_time = now_seconds() - start;
+        
+        printf("%10zu %11.2f GB/s %11.2f GB/s\n", length,
+               (double)TOTAL_BYTES / bs_time / 1e9, (double)TOTAL_BYTES / fnv_time / 1e9);
+    }
+    
+    printf("\n校验值: %llu\n", (unsigned long long)checksum);
+    free(buffer);
+    return 0;
+}
@@ -0,0 +1,74 @@
+/**
+ * join_benchmark.c - BetterString连接性能测试
+ * 
+ * 比较一次分配的bs_string_join与逐段bs_string_append的耗时
+ */
+
+#include "better_string.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define FIELD_COUNT 1000000
+#define APPEND_FIELD_COUNT 20000
+
+static double now_seconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+int main(void) {
+    printf("==== BetterString 连接性能测试 ====\n");
+    
+    // 准备1M个短字段
+    bs_string_array array;
+    array.length = FIELD_COUNT;
+    array.items = (bs_string**)malloc(FIELD_COUNT * sizeof(bs_string*));
+    if (!array.items) {
+        return 1;
+    }
+    
+    char buffer[32];
+    for (size_t i = 0; i < FIELD_COUNT; i++) {
+        snprintf(buffer, sizeof(buffer), "field%zu", i);
+        array.items[i] = bs_string_new(buffer);
+    }
+    
+    // bs_string_join：统计长度后一次分配
+    double start = now_seconds();
+    bs_string* joined = bs_string_join(&array, ",");
+    double join_time = now_seconds() - start;
+    printf("bs_string_join         %8d 个字段: %8.3f ms (%zu 字节)\n",
+           FIELD_COUNT, join_time * 1000.0, bs_string_byte_length(joined));
+    
+    // 紧凑数组连接
+    bs_compact_array* compact = bs_compact_array_from_array(&array);
+    start = now_seconds();
+    bs_string* joined_compact = bs_string_join_compact(compact, ",");
+    double compact_time = now_seconds() - start;
+    printf("bs_string_join_compact %8d 个字段: %8.3f ms\n", FIELD_COUNT, compact_time * 1000.0);
+    
+    // 逐段追加：每次都重新分配整个结果，复杂度为平方级，因此只测试较少的字段
+    start = now_seconds();
+    bs_string* appended = bs_string_new("");
+    for (size_t i = 0; i < APPEND_FIELD_COUNT; i++) {
+        if (i > 0) {
+            appended = bs_string_append_cstr(appended, ",");
+        }
+        appended = bs_string_append(appended, array.items[i]);
+    }
+    double append_time = now_seconds() - start;
+    printf("逐段bs_string_append   %8d 个字段: %8.3f ms\n", APPEND_FIELD_COUNT, append_time * 1000.0);
+    
+    bs_string_free(joined);
+    bs_string_free(joined_compact);
+    bs_string_free(appended);
+    bs_compact_array_free(compact);
+    for (size_t i = 0; i < FIELD_COUNT; i++) {
+        bs_string_free(array.items[i]);
+    }
+    free(array.items);
+    
+    return 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * number_benchmark.c - BetterString数值转换性能测试
+ * 
+ * 比较bs_parse_int/bs_parse_float与strtoll/strtod，
+ * 以及bs_int_to_chars/bs_float_to_chars与snprintf的吞吐量
+ */
+
+#include "better_string.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define VALUE_COUNT 1000000
+
+static double now_seconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t random_state = 88172645463325252ULL;
+
+static uint64_t next_random(void) {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return random_state;
+}
+
+static void print_result(const char* name, double seconds, size_t bytes) {
+    printf("%-22s %8.3f ms  %8.1f MB/s  %8.1f ns/个\n",
+           name, seconds * 1000.0, (double)bytes / seconds / 1e6, seconds * 1e9 / VALUE_COUNT);
+}
+
+int main(void) {
+    printf("==== BetterString 数值转换性能测试 ====\n");
+    printf("数值个数: %d\n\n", VALUE_COUNT);
+    
+    int64_t* ints = (int64_t*)malloc(VALUE_COUNT * sizeof(int64_t));
+    double* floats = (double*)malloc(VALUE_COUNT * sizeof(double));
+    if (!ints || !floats) {
+        return 1;
+    }
+    
+    for (size_t i = 0; i < VALUE_COUNT; i++) {
+        uint64_t r = next_random();
+        ints[i] = (int64_t)(r >> (r % 48));
+        floats[i] = (double)(r >> 11) / (double)(1ULL << 53) * 1000.0;
+    }
+    
+    // 格式化
+    bs_compact_array* int_texts = NULL;
+    bs_compact_array* float_texts = NULL;
+    char buffer[64];
+    volatile size_t sink = 0;
+    
+    double start = now_seconds();
+    for (size_t i = 0; i < VALUE_COUNT; i++) {
+        sink += (size_t)snprintf(buffer, sizeof(buffer), "%lld", (long long)ints[i]);
+    }
+    double snprintf_int_time = now_seconds() - start;
+    
+    start = now_seconds();
+    int_texts = bs_compact_array_from_ints(ints, VALUE_COUNT);
+    double bs_int_format_time = now_seconds() - start;
+    size_t int_bytes = int_texts->offsets[VALUE_COUNT];
+    
+    start = now_seconds();
+    for (size_t i = 0; i < VALUE_COUNT; i++) {
+        sink += (size_t)snprintf(buffer, sizeof(buffer), "%.17g", floats[i]);
+    }
+    double snprintf_float_time = now_seconds() - start;
+    
+    start = now_seconds();
+    float_texts = bs_compact_array_from_floats(floats, VALUE_COUNT);
+    double bs_float_format_time = now_seconds() - start;
+    size_t float_bytes = float_texts->offsets[VALUE_COUNT];
+    
+    printf("-- 格式化 --\n");
+    print_result("snprintf(%lld)", snprintf_int_time, int_bytes);
+    print_result("bs_int_to_chars", bs_int_format_time, int_bytes);
+    print_result("snprintf(%.17g)", snprintf_float_time, float_bytes);
+    print_result("bs_float_to_chars", bs_float_format_time, float_bytes);
+    
+    // 解析：strtoll/strtod需要null终止的输入，因此使用null分隔的副本
+    char* int_lines = (char*)malloc(int_bytes + VALUE_COUNT);
+    char* float_lines = (char*)malloc(float_bytes + VALUE_COUNT);
+    if (!int_lines || !float_lines) {
+        return 1;
+    }
+    size_t int_pos = 0;
+    size_t float_pos = 0;
+    for (size_t i = 0; i < VALUE_COUNT; i++) {
+        bs_string field = bs_compact_array_get(int_texts, i);
+        memcpy(int_lines + int_pos, field.data, field.byte_length);
+        int_pos += field.byte_length;
+        int_lines[int_pos++] = '\0';
+        
+        field = bs_compact_array_get(float_texts, i);
+        memcpy(float_lines + float_pos, field.data, field.byte_length);
+        float_pos += field.byte_length;
+        float_lines[float_pos++] = '\0';
+    }
+    
+    int64_t* parsed_ints = (int64_t*)malloc(VALUE_COUNT * sizeof(int64_t));
+    double* parsed_floats = (double*)malloc(VALUE_COUNT * sizeof(double));
+    if (!parsed_ints || !parsed_floats) {
+        return 1;
+    }
+    
+    start = now_seconds();
+    char* cursor = int_lines;
+    for (size_t i = 0; i < VALUE_COUNT; i++) {
+        char* end;
+        parsed_ints[i] = strtoll(cursor, &end, 10);
+        cursor = end + 1;
+    }
+    double strtoll_time = now_seconds() - start;
+    
+    start = now_seconds();
+    size_t int_ok = bs_compact_array_parse_int(int_texts, parsed_ints, NULL);
+    double bs_int_parse_time = now_seconds() - start;
+    
+    start = now_seconds();
+    cursor = float_lines;
+    for (size_t i = 0; i < VALUE_COUNT; i++) {
+        char* end;
+        parsed_floats[i] = strtod(cursor, &end);
+        cursor = end + 1;
+    }
+    double strtod_time = now_seconds() - start;
+    
+    start = now_seconds();
+    size_t float_ok = bs_compact_array_parse_float(float_texts, parsed_floats, NULL);
+    double bs_float_parse_time = now_seconds() - start;
+    
+    printf("\n-- 解析 --\n");
+    print_result("strtoll", strtoll_time, int_bytes);
+    print_result("bs_parse_int", bs_int_parse_time, int_bytes);
+    print_result("strtod", strtod_time, float_bytes);
+    print_result("bs_parse_float", bs_float_parse_time, float_bytes);
+    
+    // 校验往返结果
+    size_t mismatches = 0;
+    for (size_t i = 0; i < VALUE_COUNT; i++) {
+        mismatches += parsed_ints[i] != ints[i];
+        mismatches += memcmp(&parsed_floats[i], &floats[i], sizeof(double)) != 0;
+    }
+    printf("\n解析成功: %zu 个整数, %zu 个浮点数, 往返不一致: %zu\n", int_ok, float_ok, mismatches);
+    
+    free(int_lines);
+    free(float_lines);
+    free(parsed_ints);
+    free(parsed_floats);
+    bs_compact_array_free(int_texts);
+    bs_compact_array_free(float_texts);
+    free(ints);
+    free(floats);
+    (void)sink;
+    
+    return mismatches != 0;
+}
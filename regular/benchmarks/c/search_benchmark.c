@@ -0,0 +1,93 @@
+/**
+ * search_benchmark.c - BetterString并行查找性能测试
+ * 
+ * 在生成的日志文本上测试bs_string_find_all、bs_string_count和
+ * bs_string_contains_parallel在1到64个线程下的耗时。contains使用不存在的模式，
+ * 必须扫描全部文本
+ * 用法: c_search_benchmark [文本MB数]
+ */
+
+#include "better_string.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_seconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t next_random(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static bs_string* make_log(size_t bytes) {
+    static const char* levels[] = {"INFO", "INFO", "INFO", "DEBUG", "WARN", "ERROR"};
+    static const char* services[] = {"auth", "billing", "gateway", "search", "storage"};
+    char* buffer = (char*)malloc(bytes + 256);
+    if (!buffer) {
+        return NULL;
+    }
+    
+    uint64_t state = 88172645463325252ULL;
+    size_t length = 0;
+    while (length < bytes) {
+        uint64_t r = next_random(&state);
+        unsigned seconds = (unsigned)(r % 86400);
+        length += (size_t)snprintf(buffer + length, 256, "2024-05-17T%02u:%02u:%02u %-5s [%s] request %08x took %u ms\n",
+                                   seconds / 3600, seconds / 60 % 60, seconds % 60, levels[(r >> 17) % 6],
+                                   services[(r >> 20) % 5], (unsigned)(r >> 32), (unsigned)(r >> 24) % 5000);
+    }
+    bs_string* log = bs_string_new_len(buffer, bytes);
+    free(buffer);
+    return log;
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 512;
+    printf("==== BetterString 并行查找性能测试 ====\n\n");
+    
+    bs_string* log = make_log(megabytes << 20);
+    bs_string* error = bs_string_new("ERROR [billing]");
+    bs_string* missing = bs_string_new("request deadbeef took 9999 ms");
+    if (!log || !error || !missing) {
+        return 1;
+    }
+    printf("文本 %zu MB\n", megabytes);
+    printf("  %-8s %14s %14s %14s\n", "线程", "find_all", "count", "contains");
+    
+    static const size_t threads[] = {1, 2, 4, 8, 16, 32, 64};
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+        bs_thread_pool* pool = threads[t] == 1 ? NULL : bs_thread_pool_new(threads[t]);
+        
+        double start = now_seconds();
+        bs_match_list* matches = bs_string_find_all(log, error, pool);
+        double find_all_ms = (now_seconds() - start) * 1000;
+        
+        start = now_seconds();
+        size_t count = bs_string_count(log, error, pool);
+        double count_ms = (now_seconds() - start) * 1000;
+        
+        start = now_seconds();
+        bool found = bs_string_contains_parallel(log, missing, pool);
+        double contains_ms = (now_seconds() - start) * 1000;
+        
+        printf("  %-6zu %11.1f ms %11.1f ms %11.1f ms  (%zu 个匹配%s)\n", threads[t], find_all_ms, count_ms,
+               contains_ms, matches ? matches->length : 0, found ? "，意外找到" : "");
+        if (matches && matches->length != count) {
+            printf("  结果不一致: find_all %zu, count %zu\n", matches->length, count);
+        }
+        bs_match_list_free(matches);
+        bs_thread_pool_free(pool);
+    }
+    
+    bs_string_free(log);
+    bs_string_free(error);
+    bs_string_free(missing);
+    return 0;
+}
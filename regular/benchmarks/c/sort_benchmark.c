@@ -0,0 +1,127 @@
+/**
+ * sort_benchmark.c - BetterString字符串排序性能测试
+ * 
+ * 在URL和日志键两组数据上比较qsort加bs_string_compare、bs_string_array_sort
+ * 以及不同线程数的bs_string_array_sort_parallel。两组数据都有很长的公共前缀
+ * 用法: c_sort_benchmark [字符串数量]
+ */
+
+#include "better_string.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_seconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t next_random(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static bs_string_array* new_array(size_t count) {
+    bs_string_array* array = (bs_string_array*)malloc(sizeof(bs_string_array));
+    if (!array) {
+        return NULL;
+    }
+    array->items = (bs_string**)calloc(count, sizeof(bs_string*));
+    array->length = count;
+    if (!array->items) {
+        free(array);
+        return NULL;
+    }
+    return array;
+}
+
+static bs_string_array* make_urls(size_t count) {
+    static const char* hosts[] = {"www.example.com", "api.example.com", "cdn.example.net", "shop.example.org"};
+    bs_string_array* array = new_array(count);
+    uint64_t state = 88172645463325252ULL;
+    char buffer[256];
+    for (size_t i = 0; array && i < count; i++) {
+        uint64_t r = next_random(&state);
+        int length = snprintf(buffer, sizeof(buffer), "https://%s/products/category-%u/item-%u?ref=campaign-%u",
+                              hosts[r % 4], (unsigned)(r >> 8) % 200, (unsigned)(r >> 20) % 1000000,
+                              (unsigned)(r >> 40) % 50);
+        array->items[i] = bs_string_new_len(buffer, (size_t)length);
+    }
+    return array;
+}
+
+static bs_string_array* make_log_keys(size_t count) {
+    static const char* services[] = {"auth", "billing", "gateway", "search", "storage"};
+    bs_string_array* array = new_array(count);
+    uint64_t state = 2463534242ULL;
+    char buffer[256];
+    for (size_t i = 0; array && i < count; i++) {
+        uint64_t r = next_random(&state);
+        unsigned seconds = (unsigned)(r % 86400);
+        int length = snprintf(buffer, sizeof(buffer), "2024-05-17T%02u:%02u:%02u.%03uZ/prod/%s/host-%02u/%08x",
+                              seconds / 3600, seconds / 60 % 60, seconds % 60, (unsigned)(r >> 17) % 1000,
+                              services[(r >> 27) % 5], (unsigned)(r >> 30) % 64, (unsigned)(r >> 36));
+        array->items[i] = bs_string_new_len(buffer, (size_t)length);
+    }
+    return array;
+}
+
+static int compare_strings(const void* a, const void* b) {
+    return bs_string_compare(*(bs_string* const*)a, *(bs_string* const*)b);
+}
+
+static void run(const char* name, bs_string_array* source) {
+    size_t count = source->length;
+    bs_string** copy = (bs_string**)malloc(count * sizeof(bs_string*));
+    if (!copy) {
+        return;
+    }
+    bs_string_array array = {copy, count};
+    printf("%s（%zu 个）\n", name, count);
+    
+    memcpy(copy, source->items, count * sizeof(bs_string*));
+    double start = now_seconds();
+    qsort(copy, count, sizeof(bs_string*), compare_strings);
+    printf("  %-36s %8.1f ms\n", "qsort + bs_string_compare", (now_seconds() - start) * 1000);
+    
+    memcpy(copy, source->items, count * sizeof(bs_string*));
+    start = now_seconds();
+    bs_string_array_sort(&array);
+    printf("  %-36s %8.1f ms\n", "bs_string_array_sort", (now_seconds() - start) * 1000);
+    
+    static const size_t threads[] = {2, 4, 8, 0};
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+        memcpy(copy, source->items, count * sizeof(bs_string*));
+        start = now_seconds();
+        bs_string_array_sort_parallel(&array, threads[t]);
+        char label[64];
+        if (threads[t]) {
+            snprintf(label, sizeof(label), "bs_string_array_sort_parallel(%zu)", threads[t]);
+        } else {
+            snprintf(label, sizeof(label), "bs_string_array_sort_parallel(全部核心)");
+        }
+        printf("  %-36s %8.1f ms\n", label, (now_seconds() - start) * 1000);
+    }
+    free(copy);
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 2000000;
+    printf("==== BetterString 字符串排序性能测试 ====\n\n");
+    
+    bs_string_array* urls = make_urls(count);
+    bs_string_array* logs = make_log_keys(count);
+    if (!urls || !logs) {
+        return 1;
+    }
+    run("URL", urls);
+    run("日志键", logs);
+    
+    bs_string_array_free(urls);
+    bs_string_array_free(logs);
+    return 0;
+}
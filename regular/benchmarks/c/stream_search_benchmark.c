@@ -0,0 +1,94 @@
+/**
+ * stream_search_benchmark.c - BetterString流式查找性能测试
+ * 
+ * 把生成的日志文本按不同块大小输入bs_stream_searcher，与在连续文本上
+ * 调用bs_string_count比较耗时和匹配数
+ * 用法: c_stream_search_benchmark [文本MB数]
+ */
+
+#include "better_string.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_seconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t next_random(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static bs_string* make_log(size_t bytes) {
+    static const char* levels[] = {"INFO", "INFO", "INFO", "DEBUG", "WARN", "ERROR"};
+    static const char* services[] = {"auth", "billing", "gateway", "search", "storage"};
+    char* buffer = (char*)malloc(bytes + 256);
+    if (!buffer) {
+        return NULL;
+    }
+    
+    uint64_t state = 88172645463325252ULL;
+    size_t length = 0;
+    while (length < bytes) {
+        uint64_t r = next_random(&state);
+        unsigned seconds = (unsigned)(r % 86400);
+        length += (size_t)snprintf(buffer + length, 256, "2024-05-17T%02u:%02u:%02u %-5s [%s] request %08x took %u ms\n",
+                                   seconds / 3600, seconds / 60 % 60, seconds % 60, levels[(r >> 17) % 6],
+                                   services[(r >> 20) % 5], (unsigned)(r >> 32), (unsigned)(r >> 24) % 5000);
+    }
+    bs_string* log = bs_string_new_len(buffer, bytes);
+    free(buffer);
+    return log;
+}
+
+static void count_match(void* user, uint64_t offset) {
+    (void)offset;
+    (*(size_t*)user)++;
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 256;
+    printf("==== BetterString 流式查找性能测试 ====\n\n");
+    
+    bs_string* log = make_log(megabytes << 20);
+    bs_string* marker = bs_string_new("ERROR [billing]");
+    if (!log || !marker) {
+        return 1;
+    }
+    bs_stream_searcher* searcher = bs_stream_searcher_new(marker->data, marker->byte_length);
+    if (!searcher) {
+        return 1;
+    }
+    printf("文本 %zu MB\n", megabytes);
+    
+    double start = now_seconds();
+    size_t expected = bs_string_count(log, marker, NULL);
+    double elapsed = now_seconds() - start;
+    printf("  %-16s %10.1f ms %8.2f GB/s  (%zu 个匹配)\n", "连续文本", elapsed * 1000,
+           (double)log->byte_length / elapsed / 1e9, expected);
+    
+    static const size_t chunks[] = {64, 1024, 16384, 65536, 1 << 20};
+    for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+        size_t count = 0;
+        bs_stream_searcher_reset(searcher);
+        start = now_seconds();
+        for (size_t pos = 0; pos < log->byte_length; pos += chunks[c]) {
+            size_t length = log->byte_length - pos < chunks[c] ? log->byte_length - pos : chunks[c];
+            bs_stream_searcher_feed(searcher, log->data + pos, length, count_match, &count);
+        }
+        elapsed = now_seconds() - start;
+        printf("  块 %-8zu %14.1f ms %8.2f GB/s  (%zu 个匹配%s)\n", chunks[c], elapsed * 1000,
+               (double)log->byte_length / elapsed / 1e9, count, count == expected ? "" : "，不一致");
+    }
+    
+    bs_stream_searcher_free(searcher);
+    bs_string_free(marker);
+    bs_string_free(log);
+    return 0;
+}
@@ -11,6 +11,8 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdarg.h>
+#include <stdio.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -35,6 +37,8 @@ typedef struct bs_string {
     size_t byte_length;      // 字节长度
     bs_encoding_t encoding;  // 编码类型
     bool is_view;            // 是否为视图（不拥有内存）
+    bool hash_cached;        // hash字段是否有效，手动构造时必须初始化为false
+    uint64_t hash;           // bs_string_hash缓存的哈希值，修改内容的函数会使其失效
 } bs_string;
 
 /**
@@ -80,16 +84,61 @@ bs_string* bs_string_substring(const bs_string* str, size_t start, size_t length
 bs_string* bs_string_concat(const bs_string* str1, const bs_string* str2);
 bs_string* bs_string_append(bs_string* str, const bs_string* append);
 bs_string* bs_string_append_cstr(bs_string* str, const char* append);
+/**
+ * 插入、删除和替换第一个匹配，位置和长度以字符为单位
+ * 拥有内存的字符串原地修改并返回自身，视图返回新的字符串
+ */
 bs_string* bs_string_insert(bs_string* str, size_t position, const bs_string* insert);
 bs_string* bs_string_delete(bs_string* str, size_t start, size_t length);
 bs_string* bs_string_replace(bs_string* str, const bs_string* find, const bs_string* replace);
 
+/**
+ * 视图构造
+ *
+ * 视图按值返回，直接引用调用者的内存，不分配也不拥有内存。
+ * 视图不保证以null结尾，不能传给bs_string_free。
+ */
+bs_string bs_string_view(const char* str);
+bs_string bs_string_view_len(const char* str, size_t byte_length);
+
+/**
+ * 修剪选项
+ */
+typedef enum {
+    BS_TRIM_START   = 0x01,  // 修剪开头
+    BS_TRIM_END     = 0x02,  // 修剪结尾
+    BS_TRIM_BOTH    = 0x03,  // 修剪两端
+    BS_TRIM_UNICODE = 0x04   // 同时识别Unicode空白（NBSP、全角空格等）
+} bs_trim_flags;
+
 /**
  * 修饰方法
  */
 bs_string* bs_string_trim(const bs_string* str);
 bs_string* bs_string_trim_start(const bs_string* str);
 bs_string* bs_string_trim_end(const bs_string* str);
+/**
+ * 按选项修剪空白，返回新的字符串
+ * @param str 源字符串
+ * @param flags bs_trim_flags的组合
+ * @return 新的字符串
+ */
+bs_string* bs_string_trim_ex(const bs_string* str, unsigned flags);
+/**
+ * 原地修剪空白，不分配内存
+ * 拥有内存的字符串会把内容移到缓冲区开头，视图只移动数据指针
+ * @param str 要修剪的字符串
+ * @param flags bs_trim_flags的组合
+ * @return str本身
+ */
+bs_string* bs_string_trim_inplace(bs_string* str, unsigned flags);
+/**
+ * 返回修剪后的视图，引用str的内存
+ * @param str 源字符串
+ * @param flags bs_trim_flags的组合
+ * @return 视图，生命周期不超过str
+ */
+bs_string bs_string_trim_view(const bs_string* str, unsigned flags);
 bs_string* bs_string_to_upper(const bs_string* str);
 bs_string* bs_string_to_lower(const bs_string* str);
 /**
@@ -124,6 +173,14 @@ bool bs_string_equals_ignore_case(const bs_string* str1, const bs_string* str2);
  */
 bs_string_array* bs_string_split(const bs_string* str, const char* delimiter);
 bs_string* bs_string_join(const bs_string_array* array, const char* delimiter);
+/**
+ * 连接视图数组
+ * @param items 按值存放的字符串或视图数组
+ * @param count 元素数量
+ * @param delimiter 分隔符，可以为NULL
+ * @return 新的字符串，只分配一次内存
+ */
+bs_string* bs_string_join_views(const bs_string* items, size_t count, const char* delimiter);
 void bs_string_array_free(bs_string_array* array);
 
 /**
@@ -164,6 +221,636 @@ bs_string* bs_string_replace_regex(const bs_string* str, const char* pattern, co
 bs_string_array* bs_string_regex_split(const bs_string* str, const char* pattern);
 bs_string_array* bs_string_regex_find_all(const bs_string* str, const char* pattern);
 bs_string* bs_string_format(const char* format, ...);
+bs_string* bs_string_vformat(const char* format, va_list args);
+
+/**
+ * 惰性分割迭代器
+ *
+ * 每次调用bs_split_iter_next返回下一个字段的视图，不分配内存，
+ * 占用空间与字段数量无关。迭代期间源字符串和分隔符必须保持有效。
+ */
+typedef enum {
+    BS_SPLIT_SKIP_EMPTY = 0x01   // 跳过空字段
+} bs_split_flags;
+
+typedef struct bs_split_iter {
+    const uint8_t* data;         // 被分割的数据
+    size_t byte_length;          // 数据字节长度
+    size_t position;             // 下一个字段的起始字节位置
+    const uint8_t* delimiter;    // 分隔符
+    size_t delimiter_length;     // 分隔符字节长度
+    size_t max_splits;           // 最大分割次数，0表示不限制
+    size_t splits;               // 已经分割的次数
+    unsigned flags;              // bs_split_flags的组合
+    bool finished;               // 是否已经返回最后一个字段
+} bs_split_iter;
+
+/**
+ * 初始化分割迭代器
+ * @param it 迭代器
+ * @param str 被分割的字符串
+ * @param delimiter 分隔符，为空时整个字符串作为一个字段
+ * @param max_splits 最大分割次数，达到后剩余部分作为最后一个字段，0表示不限制
+ * @param flags bs_split_flags的组合
+ */
+void bs_split_iter_init(bs_split_iter* it, const bs_string* str, const char* delimiter,
+                        size_t max_splits, unsigned flags);
+/**
+ * 获取下一个字段
+ * @param it 迭代器
+ * @param field 输出字段视图，引用源字符串的内存
+ * @return 有字段时返回true，分割结束返回false
+ */
+bool bs_split_iter_next(bs_split_iter* it, bs_string* field);
+
+/**
+ * 紧凑字符串数组
+ *
+ * 所有字段首尾相接存放在一个字节缓冲区中，用length+1个偏移量描述边界
+ * （与Arrow的LargeString布局相同），第i个字段为data[offsets[i], offsets[i+1])。
+ * 整个数组只有一次内存分配，遍历是线性访问，可以直接交给列式处理代码。
+ */
+typedef struct bs_compact_array {
+    uint8_t* data;           // 字段数据缓冲区（末尾额外有一个null终止符）
+    size_t* offsets;         // 字段偏移数组，共length+1项
+    size_t length;           // 字段数量
+} bs_compact_array;
+
+/**
+ * 按分隔符分割为紧凑数组
+ * @param str 源字符串
+ * @param delimiter 分隔符
+ * @param max_splits 最大分割次数，0表示不限制
+ * @param flags bs_split_flags的组合
+ * @return 新的紧凑数组，失败返回NULL
+ */
+bs_compact_array* bs_string_split_compact(const bs_string* str, const char* delimiter,
+                                          size_t max_splits, unsigned flags);
+/**
+ * 查找所有匹配，结果存为紧凑数组（模式按字面子串匹配）
+ */
+bs_compact_array* bs_string_regex_find_all_compact(const bs_string* str, const char* pattern);
+/**
+ * 从普通字符串数组复制出紧凑数组
+ */
+bs_compact_array* bs_compact_array_from_array(const bs_string_array* array);
+/**
+ * 获取第index个字段的视图
+ */
+bs_string bs_compact_array_get(const bs_compact_array* array, size_t index);
+/**
+ * 使用分隔符连接紧凑数组的所有字段
+ */
+bs_string* bs_string_join_compact(const bs_compact_array* array, const char* delimiter);
+void bs_compact_array_free(bs_compact_array* array);
+
+/**
+ * CSV/TSV读取器
+ *
+ * 以64字节为一块，用位掩码同时分类引号、分隔符和换行符，
+ * 通过引号掩码的前缀异或得到"在引号内"的区域，从而一次找出所有有效的字段边界。
+ * 字段以视图形式返回，直接引用输入数据；只有跨越两个输入块的那一行会被复制。
+ * 支持"\n"和"\r\n"换行。
+ */
+typedef struct bs_csv_dialect {
+    char delimiter;          // 字段分隔符，CSV为','，TSV为'\t'
+    char quote;              // 引号字符，为'\0'时不处理引号
+} bs_csv_dialect;
+
+typedef struct bs_csv_field {
+    bs_string value;         // 字段内容视图（已去掉外层引号）
+    bool quoted;             // 字段是否被引号包围
+    bool needs_unescape;     // 内容中含有转义的引号（如""），需要bs_csv_unescape处理
+} bs_csv_field;
+
+typedef struct bs_csv_record {
+    const bs_csv_field* fields;  // 字段数组，由读取器持有
+    size_t count;                // 字段数量
+} bs_csv_record;
+
+typedef struct bs_csv_reader bs_csv_reader;
+
+/**
+ * 创建读取器
+ * @param dialect 方言，为NULL时使用标准CSV（','和'"'）
+ * @return 新的读取器
+ */
+bs_csv_reader* bs_csv_reader_new(const bs_csv_dialect* dialect);
+/**
+ * 提供下一块输入数据
+ * 调用前应先用bs_csv_reader_next读完上一块的所有记录。
+ * 数据在读完这一块的记录之前必须保持有效。
+ * @param reader 读取器
+ * @param data 输入数据
+ * @param length 数据字节长度
+ * @param last 是否为最后一块
+ */
+void bs_csv_reader_feed(bs_csv_reader* reader, const char* data, size_t length, bool last);
+/**
+ * 读取下一条记录
+ * @param reader 读取器
+ * @param record 输出记录，字段视图在下一次调用bs_csv_reader_next或bs_csv_reader_feed前有效
+ * @return 读到完整记录返回true；需要更多输入、已读完或出错返回false，用bs_csv_reader_error区分
+ */
+bool bs_csv_reader_next(bs_csv_reader* reader, bs_csv_record* record);
+// 内存不足时返回true，此后读取器不再产出记录，feed也被忽略
+bool bs_csv_reader_error(const bs_csv_reader* reader);
+void bs_csv_reader_free(bs_csv_reader* reader);
+/**
+ * 还原字段中转义的引号
+ * @param field 字段
+ * @param quote 引号字符
+ * @return 新的字符串
+ */
+bs_string* bs_csv_unescape(const bs_csv_field* field, char quote);
+
+/**
+ * 整数格式化与解析
+ */
+// 格式化一个int64_t最多需要的字节数（含负号）
+#define BS_INT_MAX_CHARS 20
+
+/**
+ * 把整数格式化到调用者的缓冲区，不写入null终止符
+ * @param value 整数
+ * @param buffer 输出缓冲区，至少BS_INT_MAX_CHARS字节
+ * @return 写入的字节数
+ */
+size_t bs_int_to_chars(int64_t value, char* buffer);
+/**
+ * 解析字节范围内的十进制整数，格式为[+-]?[0-9]+，不允许空白
+ * @param str 数据
+ * @param length 字节长度
+ * @param value 输出值
+ * @return 格式正确且没有溢出时返回true
+ */
+bool bs_parse_int(const char* str, size_t length, int64_t* value);
+/**
+ * 批量解析整数
+ * @param array 字符串数组
+ * @param values 输出数组，至少array->length项，解析失败的项写入0
+ * @param ok 可选的输出数组，记录每一项是否解析成功，可以为NULL
+ * @return 成功解析的数量
+ */
+size_t bs_string_array_parse_int(const bs_string_array* array, int64_t* values, bool* ok);
+size_t bs_compact_array_parse_int(const bs_compact_array* array, int64_t* values, bool* ok);
+/**
+ * 批量格式化整数到一个紧凑数组中
+ * @param values 整数数组
+ * @param count 数量
+ * @return 新的紧凑数组
+ */
+bs_compact_array* bs_compact_array_from_ints(const int64_t* values, size_t count);
+
+/**
+ * 浮点数格式化与解析
+ */
+// 格式化一个double最多需要的字节数
+#define BS_FLOAT_MAX_CHARS 32
+
+/**
+ * 把浮点数格式化为能够精确往返的最短十进制表示，不写入null终止符
+ * 格式与JavaScript的Number转换一致，例如"0.1"、"1e+21"、"-0"、"inf"、"nan"
+ * 与区域设置无关
+ * @param value 浮点数
+ * @param buffer 输出缓冲区，至少BS_FLOAT_MAX_CHARS字节
+ * @return 写入的字节数
+ */
+size_t bs_float_to_chars(double value, char* buffer);
+/**
+ * 解析字节范围内的十进制浮点数，结果正确舍入
+ * 格式为[+-]?(digits[.digits]|.digits)([eE][+-]?digits)?，或不区分大小写的inf、infinity、nan
+ * 小数点固定为'.'，与区域设置无关，不允许空白
+ * @param str 数据
+ * @param length 字节长度
+ * @param value 输出值
+ * @return 格式正确时返回true
+ */
+bool bs_parse_float(const char* str, size_t length, double* value);
+/**
+ * 批量解析浮点数
+ * @param array 字符串数组
+ * @param values 输出数组，至少array->length项，解析失败的项写入0
+ * @param ok 可选的输出数组，记录每一项是否解析成功，可以为NULL
+ * @return 成功解析的数量
+ */
+size_t bs_string_array_parse_float(const bs_string_array* array, double* values, bool* ok);
+size_t bs_compact_array_parse_float(const bs_compact_array* array, double* values, bool* ok);
+/**
+ * 批量格式化浮点数到一个紧凑数组中
+ * @param values 浮点数数组
+ * @param count 数量
+ * @return 新的紧凑数组
+ */
+bs_compact_array* bs_compact_array_from_floats(const double* values, size_t count);
+
+/**
+ * 字符串构建器
+ *
+ * 由若干块组成，追加时只在当前块写满后分配新块，已经写入的字节不会移动。
+ * bs_builder_finish一次复制得到连续的字符串，bs_builder_flush直接把各块写入
+ * 文件描述符，不需要先拼接出完整字符串。
+ */
+typedef struct bs_builder bs_builder;
+
+/**
+ * 创建构建器
+ * @param chunk_size 第一块的字节数，0表示使用默认值；后续块按倍数增长
+ * @return 新的构建器，失败时返回NULL
+ */
+bs_builder* bs_builder_new(size_t chunk_size);
+void bs_builder_free(bs_builder* builder);
+
+/**
+ * 追加内容，失败（内存不足）时返回false，已有内容保持不变
+ */
+bool bs_builder_append(bs_builder* builder, const char* data, size_t length);
+bool bs_builder_append_cstr(bs_builder* builder, const char* str);
+bool bs_builder_append_string(bs_builder* builder, const bs_string* str);
+bool bs_builder_append_char(bs_builder* builder, char c);
+bool bs_builder_append_codepoint(bs_builder* builder, uint32_t codepoint);
+bool bs_builder_append_int(bs_builder* builder, int64_t value);
+bool bs_builder_append_float(bs_builder* builder, double value);
+/**
+ * 追加带双引号的JSON字符串，转义引号、反斜杠和控制字符
+ */
+bool bs_builder_append_json_string(bs_builder* builder, const char* data, size_t length);
+/**
+ * 追加一个CSV字段，字段包含分隔符、引号或换行时加引号并把引号加倍
+ * @param dialect 方言，为NULL时使用逗号和双引号
+ */
+bool bs_builder_append_csv_field(bs_builder* builder, const char* data, size_t length,
+                                 const bs_csv_dialect* dialect);
+
+/**
+ * 获取已写入的字节数
+ */
+size_t bs_builder_length(const bs_builder* builder);
+/**
+ * 分块访问已写入的内容，视图在下一次修改构建器之前有效
+ */
+size_t bs_builder_chunk_count(const bs_builder* builder);
+bs_string bs_builder_chunk(const bs_builder* builder, size_t index);
+
+/**
+ * 生成连续的字符串并清空构建器，构建器可以继续使用
+ * @return 新的字符串，失败时返回NULL且构建器内容不变
+ */
+bs_string* bs_builder_finish(bs_builder* builder);
+/**
+ * 把内容写入文件描述符或文件并清空构建器
+ * @return 全部写入成功时返回true；失败时构建器内容不变，但可能已经写出了一部分
+ */
+bool bs_builder_flush(bs_builder* builder, int fd);
+bool bs_builder_flush_file(bs_builder* builder, FILE* file);
+/**
+ * 清空构建器，保留第一块以便复用
+ */
+void bs_builder_clear(bs_builder* builder);
+
+/**
+ * 绳索（rope）
+ *
+ * 适合频繁编辑的大文本。内容按UTF-8字符边界分成不超过1KB的块，存放在平衡的
+ * B树叶子中，每个节点缓存子树的字符数、字节数和换行数，因此插入、删除、按字符
+ * 索引和取子串都是O(log n)。位置参数都以字符（码点）为单位。
+ */
+typedef struct bs_rope bs_rope;
+struct bs_rope_node;
+
+#define BS_ROPE_MAX_DEPTH 24
+
+/**
+ * 按顺序遍历各块的迭代器，遍历期间不能修改绳索
+ */
+typedef struct bs_rope_iter {
+    const struct bs_rope_node* path[BS_ROPE_MAX_DEPTH];
+    unsigned child[BS_ROPE_MAX_DEPTH];
+    int depth;                   // 当前叶子所在深度，-1表示结束
+} bs_rope_iter;
+
+/**
+ * 创建空绳索，或从已有内容创建
+ * @return 新的绳索，失败时返回NULL
+ */
+bs_rope* bs_rope_new(void);
+bs_rope* bs_rope_from_cstr(const char* data, size_t length);
+bs_rope* bs_rope_from_string(const bs_string* str);
+void bs_rope_free(bs_rope* rope);
+
+/**
+ * 获取字符数、字节数和行数（换行数加一）
+ */
+size_t bs_rope_length(const bs_rope* rope);
+size_t bs_rope_byte_length(const bs_rope* rope);
+size_t bs_rope_line_count(const bs_rope* rope);
+
+/**
+ * 在字符位置插入UTF-8文本
+ * @return 成功返回true；失败（位置越界或内存不足）时内容不变
+ */
+bool bs_rope_insert(bs_rope* rope, size_t index, const char* data, size_t length);
+bool bs_rope_append(bs_rope* rope, const char* data, size_t length);
+/**
+ * 删除从index开始的count个字符，超出末尾的部分被忽略
+ */
+void bs_rope_delete(bs_rope* rope, size_t index, size_t count);
+
+/**
+ * 获取指定位置的字符，越界时返回0
+ */
+uint32_t bs_rope_char_at(const bs_rope* rope, size_t index);
+/**
+ * 复制子串或全部内容
+ */
+bs_string* bs_rope_substring(const bs_rope* rope, size_t start, size_t length);
+bs_string* bs_rope_to_string(const bs_rope* rope);
+
+/**
+ * 行号与字符位置的转换，行号从0开始
+ * bs_rope_line_to_char在行号超出范围时返回字符数
+ */
+size_t bs_rope_line_to_char(const bs_rope* rope, size_t line);
+size_t bs_rope_char_to_line(const bs_rope* rope, size_t index);
+
+/**
+ * 遍历各块，chunk为引用内部数据的视图
+ */
+void bs_rope_iter_init(bs_rope_iter* it, const bs_rope* rope);
+bool bs_rope_iter_next(bs_rope_iter* it, bs_string* chunk);
+
+/**
+ * 全局字符串驻留表
+ *
+ * 相同内容只保存一份不可变的规范字符串，驻留后的字符串可以直接比较指针，
+ * 哈希值在驻留时计算并缓存。驻留表按哈希分片，每个分片一把读写锁，
+ * 已驻留字符串的查找只需要读锁。返回的字符串不能修改或释放。
+ */
+
+/**
+ * 驻留字符串，得到的字符串永久保留
+ * @return 规范字符串，内存不足时返回NULL
+ */
+const bs_string* bs_intern(const char* data, size_t length);
+const bs_string* bs_intern_cstr(const char* str);
+const bs_string* bs_intern_string(const bs_string* str);
+
+/**
+ * 驻留字符串并持有一个弱引用，与bs_intern_release配对使用
+ * 没有被bs_intern永久驻留的字符串在最后一个引用释放时从表中删除，
+ * 这样驻留表不会无限增长
+ */
+const bs_string* bs_intern_acquire(const char* data, size_t length);
+void bs_intern_release(const bs_string* interned);
+
+/**
+ * 获取驻留字符串缓存的哈希值，参数必须是驻留表返回的字符串
+ */
+uint64_t bs_intern_hash(const bs_string* interned);
+
+/**
+ * 获取驻留表中的字符串数量
+ */
+size_t bs_intern_count(void);
+
+/**
+ * 64位哈希（wyhash算法）
+ * 长输入每次处理48字节，三条独立的64位乘法链并行执行
+ * 结果只在进程内稳定，不同平台或版本之间可能不同，不要持久化
+ * @param seed 随机种子，可以用来抵御哈希洪水攻击
+ */
+uint64_t bs_hash(const void* data, size_t length, uint64_t seed);
+/**
+ * 计算种子为0的哈希并缓存在字符串中，再次调用直接返回缓存值
+ * 第一次调用会写入字符串，多个线程共享同一字符串时应先在一个线程中调用
+ */
+uint64_t bs_string_hash(const bs_string* str);
+uint64_t bs_string_hash_seeded(const bs_string* str, uint64_t seed);
+
+/**
+ * 按码点顺序（与bs_string_compare一致）原地排序字符串指针数组，元素不能为NULL
+ * 使用缓存键的多关键字快速排序：每层比较7个字节，公共前缀不会重复比较
+ */
+void bs_string_sort(bs_string** strings, size_t count);
+/**
+ * 并行版本：抽样选出分隔串把字符串分到多个桶，各线程轮流领取桶排序，
+ * 每个桶从两侧分隔串的公共前缀之后开始比较。threads为0时使用CPU核心数，
+ * 数据量较小或内存不足时退化为bs_string_sort
+ */
+void bs_string_sort_parallel(bs_string** strings, size_t count, size_t threads);
+void bs_string_array_sort(bs_string_array* array);
+void bs_string_array_sort_parallel(bs_string_array* array, size_t threads);
+
+/**
+ * 线程池
+ *
+ * 固定数量的工作线程，并行循环把下标区间切成块，每个线程先处理分到自己的连续块，
+ * 做完后从其他线程的区间末尾窃取一半。同一时刻只执行一个并行循环，
+ * 多个线程同时提交时依次执行；不能在任务回调中再向同一个线程池提交。
+ */
+typedef struct bs_thread_pool bs_thread_pool;
+
+/**
+ * @param threads 参与计算的线程数（包括提交任务的线程），0表示CPU核心数；
+ *                1表示不创建工作线程，所有块在调用线程上按顺序执行，便于测试
+ * @return 新的线程池，失败返回NULL
+ */
+bs_thread_pool* bs_thread_pool_new(size_t threads);
+void bs_thread_pool_free(bs_thread_pool* pool);
+size_t bs_thread_pool_size(const bs_thread_pool* pool);
+/**
+ * 并行执行fn(ctx, begin, end)，覆盖[0, count)，每块最多grain个下标（0表示自动）
+ * pool为NULL时在调用线程上按顺序执行
+ */
+void bs_thread_pool_for(bs_thread_pool* pool, size_t count, size_t grain,
+                        void (*fn)(void* ctx, size_t begin, size_t end), void* ctx);
+
+/**
+ * 批量转换
+ *
+ * 对数组中的每个字符串做同样的转换，结果写入一个紧凑数组。先并行计算每个结果的长度，
+ * 再一次分配缓冲区，并行写入各自的位置；每块约64KB输入，与输出一起留在L2缓存中。
+ * pool为NULL时在调用线程上按顺序执行，结果与并行执行相同。
+ */
+
+/**
+ * 转换回调：out为NULL时只返回结果的字节数；否则写入恰好这么多字节。
+ * 两次调用必须给出相同的长度，回调可能在多个线程上同时执行。
+ * 数组中的NULL按空字符串传给回调，str不会为NULL
+ */
+typedef size_t (*bs_string_map_fn)(const bs_string* str, uint8_t* out, void* user);
+
+bs_compact_array* bs_string_array_map(const bs_string_array* array, bs_string_map_fn fn, void* user,
+                                      bs_thread_pool* pool);
+// ASCII大小写转换，与bs_string_to_lower/bs_string_to_upper一致
+bs_compact_array* bs_string_array_to_lower(const bs_string_array* array, bs_thread_pool* pool);
+bs_compact_array* bs_string_array_to_upper(const bs_string_array* array, bs_thread_pool* pool);
+// flags与bs_string_trim_view相同
+bs_compact_array* bs_string_array_trim(const bs_string_array* array, unsigned flags, bs_thread_pool* pool);
+
+/**
+ * 并行查找
+ *
+ * 把字符串切成约1MB的块交给线程池，相邻块重叠needle长度减1个字节，
+ * 跨块的匹配只由起点所在的块报告，结果按位置顺序合并。
+ * 字符串小于256KB或pool为NULL时在调用线程上顺序查找，结果相同。
+ * 互相重叠的出现位置都会计入（"aaa"中"aa"出现两次），空needle没有匹配。
+ */
+typedef struct {
+    size_t* positions;       // 匹配的起始字节偏移，升序
+    size_t length;           // 匹配数量
+} bs_match_list;
+
+/**
+ * 查找所有出现位置
+ * @return 字节偏移列表，用bs_match_list_free释放；失败返回NULL
+ */
+bs_match_list* bs_string_find_all(const bs_string* str, const bs_string* find, bs_thread_pool* pool);
+void bs_match_list_free(bs_match_list* list);
+size_t bs_string_count(const bs_string* str, const bs_string* find, bs_thread_pool* pool);
+// 任一块找到匹配后，其余尚未开始的块直接跳过
+bool bs_string_contains_parallel(const bs_string* str, const bs_string* find, bs_thread_pool* pool);
+
+/**
+ * 文件映射
+ *
+ * 把整个文件只读映射为视图字符串，内容不复制，按需从页缓存读入。
+ * 映射的字符串可以传给所有只读函数；数据不以null结尾，和其他视图一样。
+ * 字符数在第一次需要时才统计，在此之前length字段为BS_LENGTH_UNKNOWN，
+ * 直接访问结构体时请使用bs_string_length。多个线程可以同时读取同一个映射的字符串。
+ */
+#define BS_LENGTH_UNKNOWN SIZE_MAX
+
+typedef enum {
+    BS_MAP_NORMAL     = 0x00,
+    BS_MAP_SEQUENTIAL = 0x01,  // 将顺序读取，内核可以加大预读并尽早回收读过的页
+    BS_MAP_WILLNEED   = 0x02   // 立即开始在后台读入整个文件
+} bs_map_flags;
+
+/**
+ * @param path 文件路径
+ * @param flags bs_map_flags的组合，只是提示，不支持的平台上忽略
+ * @return 只读视图，必须用bs_string_unmap释放；失败返回NULL，errno说明原因
+ */
+bs_string* bs_string_map_file(const char* path, unsigned flags);
+void bs_string_unmap(bs_string* str);
+
+/**
+ * 按行读取
+ *
+ * 从文件描述符、FILE*或自定义数据源按行读取，缓冲区是一个滑动窗口：
+ * 只有在需要补充数据时才把未读完的半行移到开头，行比缓冲区长时缓冲区加倍。
+ * 返回的行是指向缓冲区的视图，不含行尾的"\n"或"\r\n"，在下一次调用前有效。
+ * 行的字符数在第一次需要时才统计（见bs_string_length）。
+ */
+typedef struct bs_line_reader bs_line_reader;
+
+/**
+ * 数据源回调：最多读入capacity字节到buffer
+ * @return 读入的字节数，0表示结束，负数表示错误
+ */
+typedef ptrdiff_t (*bs_read_fn)(void* ctx, uint8_t* buffer, size_t capacity);
+
+/**
+ * @param buffer_size 初始缓冲区大小，0表示256KB
+ * @return 新的读取器，不拥有数据源；失败返回NULL
+ */
+bs_line_reader* bs_line_reader_new(bs_read_fn read, void* ctx, size_t buffer_size);
+bs_line_reader* bs_line_reader_new_fd(int fd, size_t buffer_size);
+bs_line_reader* bs_line_reader_new_file(FILE* file, size_t buffer_size);
+void bs_line_reader_free(bs_line_reader* reader);
+/**
+ * 读取下一行，最后一行没有换行符时也会返回
+ * @param line 输出的视图，在下一次调用bs_line_reader_next或释放读取器前有效
+ * @return 读到一行返回true；结束或出错返回false，用bs_line_reader_error区分
+ */
+bool bs_line_reader_next(bs_line_reader* reader, bs_string* line);
+bool bs_line_reader_error(const bs_line_reader* reader);
+
+/**
+ * 批量输出
+ *
+ * 把多段数据用一次writev系统调用写出，不需要先拼接成一个字符串。
+ * 处理部分写入和信号中断；Windows没有writev，逐段写出。
+ */
+typedef struct {
+    const uint8_t* data;
+    size_t length;
+} bs_iovec;
+
+/**
+ * 写出全部数据，适用于阻塞的文件描述符
+ * @param iov 要写出的数组，部分写入时函数会原地调整其中的项
+ * @return 全部写入返回true；出错返回false，errno说明原因，可能已经写出了一部分
+ */
+bool bs_writev_all(int fd, bs_iovec* iov, size_t count);
+/**
+ * 尽量写出数据，遇到EAGAIN/EWOULDBLOCK时返回，适用于非阻塞的文件描述符和事件循环
+ * 写完的项被跳过，写了一部分的项原地调整data和length
+ * @param count 输入为项数，输出为剩余的项数，为0时全部写完
+ * @return 剩余的第一项，之后可以用同样的参数继续调用；出错返回NULL，errno说明原因。
+ *         *count为0时返回值只表示成功，不应再访问；传入空列表（包括iov为NULL）也返回成功
+ */
+bs_iovec* bs_writev_some(int fd, bs_iovec* iov, size_t* count);
+// 依次写出count个字符串，NULL按空字符串处理
+bool bs_write_all(int fd, const bs_string* const* strings, size_t count);
+bool bs_write_array(int fd, const bs_string_array* array);
+
+/**
+ * 批量读取文件
+ *
+ * 把一批文件读入新的字符串。Linux上通过io_uring成批提交打开和读取请求，
+ * 按文件大小预先分配字符串，数据直接读入字符串的缓冲区；内核不支持io_uring
+ * 或被禁用时，以及其他平台上，逐个同步读取，结果相同。
+ */
+
+/**
+ * 每个文件读完后在调用线程上调用一次，顺序不确定
+ * @param index 文件在paths中的下标
+ * @param str 文件内容，所有权交给回调；失败时为NULL
+ * @param error 失败时的errno，成功时为0
+ */
+typedef void (*bs_load_callback)(void* user, size_t index, bs_string* str, int error);
+
+/**
+ * @return 成功读取的文件数
+ */
+size_t bs_load_files(const char* const* paths, size_t count, bs_load_callback callback, void* user);
+
+/**
+ * 流式子串查找
+ *
+ * 数据分块到达时逐块查找，不需要先拼接成一个字符串。匹配位置是从第一块开始
+ * 计算的全局字节偏移，跨越块边界的匹配也会报告；查找器只保存needle、
+ * 一张needle长度的前缀表和当前已匹配的前缀长度，与已输入的数据量无关。
+ * 前缀表在创建时计算一次，bs_stream_searcher_reset后可用于下一个数据流。
+ * 互相重叠的出现位置都会计入，与bs_string_find_all一致，空needle没有匹配。
+ */
+typedef struct bs_stream_searcher bs_stream_searcher;
+
+/**
+ * 匹配回调，按偏移升序调用
+ * @param offset 匹配起点的全局字节偏移
+ */
+typedef void (*bs_match_fn)(void* user, uint64_t offset);
+
+/**
+ * @param needle 要查找的字符串，内容被复制
+ * @return 新的查找器；失败返回NULL
+ */
+bs_stream_searcher* bs_stream_searcher_new(const uint8_t* needle, size_t needle_length);
+void bs_stream_searcher_free(bs_stream_searcher* searcher);
+// 回到数据流开头，保留needle和前缀表
+void bs_stream_searcher_reset(bs_stream_searcher* searcher);
+/**
+ * 输入下一块数据，块不需要保持有效
+ * @param callback 每个在本块内结束的匹配调用一次，可以为NULL
+ * @return 本块内结束的匹配数量
+ */
+size_t bs_stream_searcher_feed(bs_stream_searcher* searcher, const uint8_t* data, size_t length,
+                               bs_match_fn callback, void* user);
+// 已输入的总字节数
+uint64_t bs_stream_searcher_offset(const bs_stream_searcher* searcher);
 
 #ifdef BETTER_STRING_CPP_STYLE
 
@@ -112,6 +112,7 @@ public:
     
     // 长度和容量
     size_t length() const;
+    size_t byteLength() const;
     size_t capacity() const;
     /**
      * 计算字符串中单词的数量
@@ -145,14 +146,14 @@ private:
 // 流操作符
 std::ostream& operator<<(std::ostream& os, const String& str);
 
+} // namespace bs
+
 // 添加STL兼容的哈希支持
 namespace std {
     template <>
     struct hash<bs::String> {
-        size_t operator()(const bs::String& str) const;
+        size_t operator()(const bs::String& str) const noexcept;
     };
 }
 
-} // namespace bs
-
 #endif // BETTER_STRING_HPP 
\ No newline at end of file
@@ -6,6 +6,7 @@
  */
 
 #include "better_string.hpp"
+#include "better_string.h"
 #include <iostream>
 #include <cstring>
 #include <algorithm>
@@ -197,6 +198,14 @@ size_t String::length() const {
 #endif
 }
 
+size_t String::byteLength() const {
+#ifdef BETTER_STRING_USE_C_BACKEND
+    return bs_byte_length(m_handle);
+#else
+    return m_length;
+#endif
+}
+
 // C字符串访问
 const char* String::c_str() const {
 #ifdef BETTER_STRING_USE_C_BACKEND
@@ -310,16 +319,9 @@ bool String::empty() const {
     return length() == 0;
 }
 
-// 哈希函数实现
-size_t std::hash<bs::String>::operator()(const bs::String& str) const {
-    // 使用FNV-1a哈希算法或其他适合的哈希算法
-    size_t hash = 14695981039346656037ULL; // FNV偏移基数
-    const char* data = str.c_str();
-    for (size_t i = 0; data[i]; ++i) {
-        hash ^= static_cast<size_t>(data[i]);
-        hash *= 1099511628211ULL; // FNV素数
-    }
-    return hash;
-}
+} // namespace bs
 
-} // namespace bs 
\ No newline at end of file
+// 哈希函数实现：按字节长度哈希全部内容，内容中的NUL字节也参与计算
+size_t std::hash<bs::String>::operator()(const bs::String& str) const noexcept {
+    return static_cast<size_t>(bs_hash(str.c_str(), str.byteLength(), 0));
+} 
\ No newline at end of file
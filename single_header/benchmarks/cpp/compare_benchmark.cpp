@@ -0,0 +1,102 @@
+/**
+ * compare_benchmark.cpp - BetterString单头文件版字符串比较性能测试
+ * 
+ * 比较bs::String的compare、==和startsWith与std::string对应操作的耗时。
+ * 测试数据是共享较长公共前缀的路径，差异出现在字符串后部。字符串数量较少，数据留在缓存中，
+ * 测的是比较本身而不是内存访问
+ */
+
+#define BETTER_STRING_IMPLEMENTATION
+#include "better_string_single.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t kStringCount = 2000;
+constexpr size_t kRounds = 2500;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::vector<std::string> makeStrings() {
+    std::vector<std::string> strings;
+    strings.reserve(kStringCount);
+    for (size_t i = 0; i < kStringCount; ++i) {
+        size_t key = (i * 2654435761u) % kStringCount;
+        strings.push_back("/srv/storage/tenants/acme-corporation/projects/project-" + std::to_string(key % 13) +
+                          "/datasets/shard-" + std::to_string(key));
+    }
+    return strings;
+}
+
+// 重复几次取最短时间，减少其他进程的干扰
+template <typename T, typename Op>
+double run(const std::vector<T>& a, const std::vector<T>& b, Op op, long& checksum) {
+    double best = 0;
+    for (int repeat = 0; repeat < 5; ++repeat) {
+        auto start = Clock::now();
+        for (size_t round = 0; round < kRounds; ++round) {
+            for (size_t i = 0; i < a.size(); ++i) {
+                checksum += op(a[i], b[i]);
+            }
+        }
+        double time = elapsedMs(start);
+        if (repeat == 0 || time < best) {
+            best = time;
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "==== BetterString单头文件版 字符串比较性能测试 ====" << std::endl;
+    std::cout << kStringCount << " 对字符串, " << kRounds << " 轮" << std::endl;
+    
+    std::vector<std::string> stdA = makeStrings();
+    // b[i]是a[i]的副本（测试相等）或相邻元素（测试排序比较）
+    std::vector<std::string> stdSame = stdA;
+    std::vector<std::string> stdNext(stdA.begin() + 1, stdA.end());
+    stdNext.push_back(stdA.front());
+    std::vector<std::string> stdPrefix;
+    for (const std::string& str : stdA) {
+        stdPrefix.push_back(str.substr(0, str.size() - 3));
+    }
+    
+    auto toBs = [](const std::vector<std::string>& strings) {
+        std::vector<bs::String> result;
+        result.reserve(strings.size());
+        for (const std::string& str : strings) {
+            result.emplace_back(str);
+        }
+        return result;
+    };
+    std::vector<bs::String> bsA = toBs(stdA);
+    std::vector<bs::String> bsSame = toBs(stdSame);
+    std::vector<bs::String> bsNext = toBs(stdNext);
+    std::vector<bs::String> bsPrefix = toBs(stdPrefix);
+    
+    long checksum = 0;
+    double stdCompare = run(stdA, stdNext, [](const std::string& x, const std::string& y) { return x.compare(y) < 0; }, checksum);
+    double bsCompare = run(bsA, bsNext, [](const bs::String& x, const bs::String& y) { return x.compare(y) < 0; }, checksum);
+    double stdEquals = run(stdA, stdSame, [](const std::string& x, const std::string& y) { return x == y; }, checksum);
+    double bsEquals = run(bsA, bsSame, [](const bs::String& x, const bs::String& y) { return x == y; }, checksum);
+    double stdPrefixTime = run(stdA, stdPrefix, [](const std::string& x, const std::string& y) {
+        return x.compare(0, y.size(), y) == 0;
+    }, checksum);
+    double bsPrefixTime = run(bsA, bsPrefix, [](const bs::String& x, const bs::String& y) { return x.startsWith(y); }, checksum);
+    
+    std::cout << "compare:    std::string " << stdCompare << " ms, bs::String " << bsCompare << " ms" << std::endl;
+    std::cout << "==:         std::string " << stdEquals << " ms, bs::String " << bsEquals << " ms" << std::endl;
+    std::cout << "startsWith: std::string " << stdPrefixTime << " ms, bs::String " << bsPrefixTime << " ms" << std::endl;
+    std::cout << "(" << checksum << ")" << std::endl;
+    
+    return 0;
+}
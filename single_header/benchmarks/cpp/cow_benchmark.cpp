@@ -0,0 +1,94 @@
+/**
+ * cow_benchmark.cpp - BetterString单头文件版写时复制性能测试
+ * 
+ * 比较开启和关闭写时复制时复制std::vector<bs::String>以及对副本排序的耗时，
+ * 并以std::vector<std::string>作为参照
+ */
+
+#define BETTER_STRING_IMPLEMENTATION
+#include "better_string_single.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t kStringCount = 200000;
+constexpr size_t kRounds = 10;
+
+std::vector<bs::String> makeStrings(bool copyOnWrite) {
+    std::vector<bs::String> strings;
+    strings.reserve(kStringCount);
+    for (size_t i = 0; i < kStringCount; ++i) {
+        // 乱序的键，长度超过短字符串优化的范围
+        size_t key = (i * 2654435761u) % kStringCount;
+        bs::String str = bs::format("/var/log/service-{}/request-{}.json", key % 97, key);
+        str.setCopyOnWrite(copyOnWrite);
+        strings.push_back(std::move(str));
+    }
+    return strings;
+}
+
+void benchmark(const char* label, bool copyOnWrite) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<bs::String> strings = makeStrings(copyOnWrite);
+    
+    size_t checksum = 0;
+    auto start = Clock::now();
+    for (size_t round = 0; round < kRounds; ++round) {
+        std::vector<bs::String> copy = strings;
+        checksum += copy.back().byteLength();
+    }
+    double copyTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    
+    start = Clock::now();
+    for (size_t round = 0; round < kRounds; ++round) {
+        std::vector<bs::String> copy = strings;
+        std::sort(copy.begin(), copy.end(), [](const bs::String& a, const bs::String& b) {
+            return a.view() < b.view();
+        });
+        checksum += copy.front().byteLength();
+    }
+    double sortTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    
+    std::cout << label << " 复制: " << copyTime << " ms, 复制并排序: " << sortTime << " ms (" << checksum << ")"
+              << std::endl;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "==== BetterString单头文件版 写时复制性能测试 ====" << std::endl;
+    std::cout << kStringCount << " 个字符串, " << kRounds << " 轮" << std::endl;
+    
+    benchmark("bs::String（深复制）   ", false);
+    benchmark("bs::String（写时复制） ", true);
+    
+    using Clock = std::chrono::steady_clock;
+    std::vector<std::string> strings;
+    for (const bs::String& str : makeStrings(false)) {
+        strings.push_back(str.toString());
+    }
+    
+    size_t checksum = 0;
+    auto start = Clock::now();
+    for (size_t round = 0; round < kRounds; ++round) {
+        std::vector<std::string> copy = strings;
+        checksum += copy.back().size();
+    }
+    double copyTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    
+    start = Clock::now();
+    for (size_t round = 0; round < kRounds; ++round) {
+        std::vector<std::string> copy = strings;
+        std::sort(copy.begin(), copy.end());
+        checksum += copy.front().size();
+    }
+    double sortTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::cout << "std::string             " << " 复制: " << copyTime << " ms, 复制并排序: " << sortTime << " ms ("
+              << checksum << ")" << std::endl;
+    
+    return 0;
+}
@@ -0,0 +1,63 @@
+/**
+ * format_benchmark.cpp - BetterString单头文件版格式化性能测试
+ * 
+ * 比较bs::format、bs::String::format（printf风格）与std::ostringstream
+ * 格式化一条日志的耗时
+ */
+
+#define BETTER_STRING_IMPLEMENTATION
+#include "better_string_single.hpp"
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+int main() {
+    constexpr size_t kLineCount = 1000000;
+    std::cout << "==== BetterString单头文件版 格式化性能测试 ====" << std::endl;
+    
+    using Clock = std::chrono::steady_clock;
+    const std::string user = "alice";
+    size_t totalBytes = 0;
+    
+    auto start = Clock::now();
+    for (size_t i = 0; i < kLineCount; ++i) {
+        bs::String line = bs::format("user={} id={} latency={}ms ok={}", user, i, 0.25 * static_cast<double>(i % 1000), (i & 1) != 0);
+        totalBytes += line.byteLength();
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::cout << "bs::format              : " << elapsed << " ms (" << totalBytes << " 字节)" << std::endl;
+    
+    totalBytes = 0;
+    start = Clock::now();
+    for (size_t i = 0; i < kLineCount; ++i) {
+        bs::String line = bs::String::format("user=%s id=%zu latency=%.17gms ok=%s", user.c_str(), i,
+                                             0.25 * static_cast<double>(i % 1000), (i & 1) != 0 ? "true" : "false");
+        totalBytes += line.byteLength();
+    }
+    elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::cout << "bs::String::format      : " << elapsed << " ms (" << totalBytes << " 字节)" << std::endl;
+    
+    totalBytes = 0;
+    start = Clock::now();
+    for (size_t i = 0; i < kLineCount; ++i) {
+        std::ostringstream stream;
+        stream << "user=" << user << " id=" << i << " latency=" << 0.25 * static_cast<double>(i % 1000)
+               << "ms ok=" << std::boolalpha << ((i & 1) != 0);
+        totalBytes += stream.str().size();
+    }
+    elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::cout << "std::ostringstream      : " << elapsed << " ms (" << totalBytes << " 字节)" << std::endl;
+    
+    // 追加到同一个字符串，复用已有缓冲区
+    bs::String log;
+    start = Clock::now();
+    for (size_t i = 0; i < kLineCount / 10; ++i) {
+        bs::format_to(log, "id={} ok={}\n", i, (i & 1) != 0);
+    }
+    elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::cout << "bs::format_to(String&)  : " << elapsed << " ms (" << kLineCount / 10 << " 行, "
+              << log.byteLength() << " 字节)" << std::endl;
+    
+    return 0;
+}
@@ -0,0 +1,53 @@
+/**
+ * join_benchmark.cpp - BetterString单头文件版连接性能测试
+ * 
+ * 比较bs::String::join与std::string逐段追加的耗时
+ */
+
+#define BETTER_STRING_IMPLEMENTATION
+#include "better_string_single.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main() {
+    constexpr size_t kFieldCount = 1000000;
+    std::cout << "==== BetterString单头文件版 连接性能测试 ====" << std::endl;
+    
+    std::vector<bs::String> fields;
+    std::vector<std::string> stdFields;
+    fields.reserve(kFieldCount);
+    stdFields.reserve(kFieldCount);
+    for (size_t i = 0; i < kFieldCount; ++i) {
+        std::string field = "field" + std::to_string(i);
+        fields.emplace_back(field);
+        stdFields.push_back(field);
+    }
+    
+    using Clock = std::chrono::steady_clock;
+    
+    auto start = Clock::now();
+    bs::String joined = bs::String::join(fields, ",");
+    auto elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::cout << "bs::String::join(vector<String>)      : " << elapsed << " ms ("
+              << joined.byteLength() << " 字节)" << std::endl;
+    
+    start = Clock::now();
+    bs::String joinedStd = bs::String::join(stdFields, ",");
+    elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::cout << "bs::String::join(vector<std::string>) : " << elapsed << " ms" << std::endl;
+    
+    start = Clock::now();
+    std::string appended;
+    for (size_t i = 0; i < stdFields.size(); ++i) {
+        if (i > 0) {
+            appended += ',';
+        }
+        appended += stdFields[i];
+    }
+    elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::cout << "std::string 逐段追加                  : " << elapsed << " ms" << std::endl;
+    
+    return 0;
+}
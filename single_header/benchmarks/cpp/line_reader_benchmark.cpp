@@ -0,0 +1,132 @@
+/**
+ * line_reader_benchmark.cpp - BetterString单头文件版按行读取性能测试
+ * 
+ * 生成一个日志文件，比较std::getline逐行读入std::string与bs::LineReader
+ * 从文件描述符、FILE*和输入流按行读取视图的耗时。文件第一次读取后留在页缓存中，
+ * 测的是分行本身而不是磁盘
+ * 用法: single_header_cpp_line_reader_benchmark [文件MB数]
+ */
+
+#define BETTER_STRING_IMPLEMENTATION
+#include "better_string_single.hpp"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <fcntl.h>
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* kPath = "line_reader_benchmark.txt";
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void makeFile(size_t bytes) {
+    std::ofstream out(kPath, std::ios::binary);
+    uint64_t state = 88172645463325252ULL;
+    size_t written = 0;
+    char line[256];
+    while (written < bytes) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        // 行长在40到160字节之间
+        int length = std::snprintf(line, sizeof(line), "2024-05-17 request=%08x status=%u path=/api/v1/items/%.*s\n",
+                                   static_cast<unsigned>(state), static_cast<unsigned>(state >> 32) % 600,
+                                   static_cast<int>((state >> 40) % 100), 
+                                   "abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyz");
+        out.write(line, length);
+        written += static_cast<size_t>(length);
+    }
+}
+
+void report(const char* name, double ms, size_t lines, size_t bytes, double megabytes) {
+    std::cout << "  " << name << ": " << ms << " ms, " << megabytes / (ms / 1000) << " MB/s (" << lines << " 行, "
+              << bytes << " 字节)" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 512;
+    std::cout << "==== BetterString 按行读取性能测试 ====" << std::endl;
+    makeFile(megabytes << 20);
+    
+    {
+        std::ifstream in(kPath, std::ios::binary);
+        std::string line;
+        size_t lines = 0;
+        size_t bytes = 0;
+        auto start = Clock::now();
+        while (std::getline(in, line)) {
+            lines++;
+            bytes += line.size();
+        }
+        report("std::getline", elapsedMs(start), lines, bytes, static_cast<double>(megabytes));
+    }
+    
+    {
+        std::ifstream in(kPath, std::ios::binary);
+        bs::LineReader reader(in);
+        std::string_view line;
+        size_t lines = 0;
+        size_t bytes = 0;
+        auto start = Clock::now();
+        while (reader.next(line)) {
+            lines++;
+            bytes += line.size();
+        }
+        report("bs::LineReader(std::istream&)", elapsedMs(start), lines, bytes, static_cast<double>(megabytes));
+    }
+    
+    {
+        FILE* file = std::fopen(kPath, "rb");
+        bs::LineReader reader(file);
+        std::string_view line;
+        size_t lines = 0;
+        size_t bytes = 0;
+        auto start = Clock::now();
+        while (reader.next(line)) {
+            lines++;
+            bytes += line.size();
+        }
+        report("bs::LineReader(FILE*)", elapsedMs(start), lines, bytes, static_cast<double>(megabytes));
+        std::fclose(file);
+    }
+    
+    {
+#if defined(_WIN32)
+        int fd = _open(kPath, _O_RDONLY | _O_BINARY);
+#else
+        int fd = open(kPath, O_RDONLY);
+#endif
+        bs::LineReader reader(fd);
+        std::string_view line;
+        size_t lines = 0;
+        size_t bytes = 0;
+        auto start = Clock::now();
+        while (reader.next(line)) {
+            lines++;
+            bytes += line.size();
+        }
+        report("bs::LineReader(fd)", elapsedMs(start), lines, bytes, static_cast<double>(megabytes));
+#if defined(_WIN32)
+        _close(fd);
+#else
+        close(fd);
+#endif
+    }
+    
+    std::remove(kPath);
+    return 0;
+}
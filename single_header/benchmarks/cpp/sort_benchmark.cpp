@@ -0,0 +1,67 @@
+/**
+ * sort_benchmark.cpp - BetterString单头文件版字符串排序性能测试
+ * 
+ * 比较std::sort（operator<）、bs::sort和bs::parallelSort对URL排序的耗时，
+ * 并以std::vector<std::string>上的std::sort作为参照
+ */
+
+#define BETTER_STRING_IMPLEMENTATION
+#include "better_string_single.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t kStringCount = 1000000;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+} // namespace
+
+int main() {
+    std::cout << "==== BetterString单头文件版 字符串排序性能测试 ====" << std::endl;
+    std::cout << kStringCount << " 个URL" << std::endl;
+    
+    std::mt19937_64 rng(42);
+    std::vector<bs::String> strings;
+    strings.reserve(kStringCount);
+    for (size_t i = 0; i < kStringCount; ++i) {
+        uint64_t r = rng();
+        strings.push_back(bs::format("https://www.example.com/products/category-{}/item-{}?ref=campaign-{}",
+                                     r % 200, (r >> 8) % 1000000, (r >> 40) % 50));
+    }
+    
+    std::vector<bs::String> copy = strings;
+    auto start = Clock::now();
+    std::sort(copy.begin(), copy.end());
+    std::cout << "std::sort（bs::String）     " << elapsedMs(start) << " ms" << std::endl;
+    
+    copy = strings;
+    start = Clock::now();
+    bs::sort(copy.begin(), copy.end());
+    std::cout << "bs::sort                   " << elapsedMs(start) << " ms" << std::endl;
+    
+    copy = strings;
+    start = Clock::now();
+    bs::parallelSort(copy.begin(), copy.end());
+    std::cout << "bs::parallelSort（全部核心） " << elapsedMs(start) << " ms" << std::endl;
+    
+    std::vector<std::string> stdStrings;
+    stdStrings.reserve(kStringCount);
+    for (const bs::String& str : strings) {
+        stdStrings.push_back(str.toString());
+    }
+    start = Clock::now();
+    std::sort(stdStrings.begin(), stdStrings.end());
+    std::cout << "std::sort（std::string）    " << elapsedMs(start) << " ms" << std::endl;
+    
+    return 0;
+}
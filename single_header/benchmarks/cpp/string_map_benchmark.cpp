@@ -0,0 +1,95 @@
+/**
+ * string_map_benchmark.cpp - BetterString单头文件版字符串哈希表性能测试
+ * 
+ * 用const char*键插入和查找，比较bs::StringMap（两种键存储方式）、
+ * std::unordered_map<bs::String, int>和std::unordered_map<std::string, int>
+ */
+
+#define BETTER_STRING_IMPLEMENTATION
+#include "better_string_single.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr size_t kKeyCount = 200000;
+constexpr size_t kRounds = 10;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::vector<std::string> makeKeys() {
+    std::vector<std::string> keys;
+    keys.reserve(kKeyCount);
+    for (size_t i = 0; i < kKeyCount; ++i) {
+        size_t key = (i * 2654435761u) % kKeyCount;
+        keys.push_back("/api/v2/service-" + std::to_string(key % 97) + "/resource-" + std::to_string(key));
+    }
+    return keys;
+}
+
+void report(const char* label, double insertTime, double lookupTime, size_t checksum) {
+    std::cout << label << " 插入: " << insertTime << " ms, 查找: " << lookupTime << " ms (" << checksum << ")"
+              << std::endl;
+}
+
+template <typename Map, typename MakeKey>
+void benchmarkStd(const char* label, const std::vector<std::string>& keys, MakeKey makeKey) {
+    auto start = Clock::now();
+    Map map;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        map.emplace(makeKey(keys[i].c_str()), static_cast<int>(i));
+    }
+    double insertTime = elapsedMs(start);
+    
+    size_t checksum = 0;
+    start = Clock::now();
+    for (size_t round = 0; round < kRounds; ++round) {
+        for (const std::string& key : keys) {
+            // C++17的unordered_map不支持异构查找，每次都要构造键
+            checksum += static_cast<size_t>(map.find(makeKey(key.c_str()))->second);
+        }
+    }
+    report(label, insertTime, elapsedMs(start), checksum);
+}
+
+void benchmarkStringMap(const char* label, bs::KeyStorage storage, const std::vector<std::string>& keys) {
+    auto start = Clock::now();
+    bs::StringMap<int> map(storage);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        map.insert(keys[i].c_str(), static_cast<int>(i));
+    }
+    double insertTime = elapsedMs(start);
+    
+    size_t checksum = 0;
+    start = Clock::now();
+    for (size_t round = 0; round < kRounds; ++round) {
+        for (const std::string& key : keys) {
+            checksum += static_cast<size_t>(map.find(key.c_str())->value);
+        }
+    }
+    report(label, insertTime, elapsedMs(start), checksum);
+}
+
+} // namespace
+
+int main() {
+    std::cout << "==== BetterString单头文件版 字符串哈希表性能测试 ====" << std::endl;
+    std::cout << kKeyCount << " 个键, 查找 " << kRounds << " 轮" << std::endl;
+    
+    std::vector<std::string> keys = makeKeys();
+    benchmarkStringMap("bs::StringMap（Owned）             ", bs::KeyStorage::Owned, keys);
+    benchmarkStringMap("bs::StringMap（Arena）             ", bs::KeyStorage::Arena, keys);
+    benchmarkStd<std::unordered_map<bs::String, int>>("unordered_map<bs::String, int>     ", keys,
+                                                      [](const char* key) { return bs::String(key); });
+    benchmarkStd<std::unordered_map<std::string, int>>("unordered_map<std::string, int>    ", keys,
+                                                       [](const char* key) { return std::string(key); });
+    
+    return 0;
+}
@@ -8,6 +8,15 @@
 #ifndef BETTER_STRING_SINGLE_H
 #define BETTER_STRING_SINGLE_H
 
+// 读写锁等POSIX接口在严格的C11模式下需要显式开启，需要在第一个系统头文件之前定义
+#if defined(BETTER_STRING_IMPLEMENTATION) && !defined(_WIN32) && !defined(_POSIX_C_SOURCE) && !defined(_GNU_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+// Linux上的io_uring需要syscall()
+#if defined(BETTER_STRING_IMPLEMENTATION) && defined(__linux__) && !defined(_DEFAULT_SOURCE) && !defined(_GNU_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -16,6 +25,16 @@
 #include <stdio.h>
 #include <ctype.h>
 #include <stdarg.h>
+#include <float.h>
+
+// SIMD支持检测：x86-64总是支持SSE2，其他平台回退到按字（SWAR）处理
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BS_HAVE_SSE2 1
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -40,6 +59,8 @@ typedef struct bs_string {
     size_t byte_length;      // 字节长度
     bs_encoding_t encoding;  // 编码类型
     bool is_view;            // 是否为视图（不拥有内存）
+    bool hash_cached;        // hash字段是否有效，手动构造时必须初始化为false
+    uint64_t hash;           // bs_string_hash缓存的哈希值，修改内容的函数会使其失效
 } bs_string;
 
 /**
@@ -75,12 +96,57 @@ bs_string* bs_string_substring(const bs_string* str, size_t start, size_t length
 bs_string* bs_string_concat(const bs_string* str1, const bs_string* str2);
 bs_string* bs_string_append(bs_string* str, const bs_string* append);
 bs_string* bs_string_append_cstr(bs_string* str, const char* append);
+/**
+ * 插入、删除和替换第一个匹配，位置和长度以字符为单位
+ * 拥有内存的字符串原地修改并返回自身，视图返回新的字符串
+ */
 bs_string* bs_string_insert(bs_string* str, size_t position, const bs_string* insert);
 bs_string* bs_string_delete(bs_string* str, size_t start, size_t length);
 bs_string* bs_string_replace(bs_string* str, const bs_string* find, const bs_string* replace);
+/**
+ * 视图构造
+ *
+ * 视图按值返回，直接引用调用者的内存，不分配也不拥有内存。
+ * 视图不保证以null结尾，不能传给bs_string_free。
+ */
+bs_string bs_string_view(const char* str);
+bs_string bs_string_view_len(const char* str, size_t byte_length);
+
+/**
+ * 修剪选项
+ */
+typedef enum {
+    BS_TRIM_START   = 0x01,  // 修剪开头
+    BS_TRIM_END     = 0x02,  // 修剪结尾
+    BS_TRIM_BOTH    = 0x03,  // 修剪两端
+    BS_TRIM_UNICODE = 0x04   // 同时识别Unicode空白（NBSP、全角空格等）
+} bs_trim_flags;
+
 bs_string* bs_string_trim(const bs_string* str);
 bs_string* bs_string_trim_start(const bs_string* str);
 bs_string* bs_string_trim_end(const bs_string* str);
+/**
+ * 按选项修剪空白，返回新的字符串
+ * @param str 源字符串
+ * @param flags bs_trim_flags的组合
+ * @return 新的字符串
+ */
+bs_string* bs_string_trim_ex(const bs_string* str, unsigned flags);
+/**
+ * 原地修剪空白，不分配内存
+ * 拥有内存的字符串会把内容移到缓冲区开头，视图只移动数据指针
+ * @param str 要修剪的字符串
+ * @param flags bs_trim_flags的组合
+ * @return str本身
+ */
+bs_string* bs_string_trim_inplace(bs_string* str, unsigned flags);
+/**
+ * 返回修剪后的视图，引用str的内存
+ * @param str 源字符串
+ * @param flags bs_trim_flags的组合
+ * @return 视图，生命周期不超过str
+ */
+bs_string bs_string_trim_view(const bs_string* str, unsigned flags);
 bs_string* bs_string_to_upper(const bs_string* str);
 bs_string* bs_string_to_lower(const bs_string* str);
 /**
@@ -107,6 +173,14 @@ bool bs_string_equals(const bs_string* str1, const bs_string* str2);
 bool bs_string_equals_ignore_case(const bs_string* str1, const bs_string* str2);
 bs_string_array* bs_string_split(const bs_string* str, const char* delimiter);
 bs_string* bs_string_join(const bs_string_array* array, const char* delimiter);
+/**
+ * 连接视图数组
+ * @param items 按值存放的字符串或视图数组
+ * @param count 元素数量
+ * @param delimiter 分隔符，可以为NULL
+ * @return 新的字符串，只分配一次内存
+ */
+bs_string* bs_string_join_views(const bs_string* items, size_t count, const char* delimiter);
 void bs_string_array_free(bs_string_array* array);
 /**
  * 计算字符串中单词的数量
@@ -131,893 +205,7654 @@ bs_string* bs_string_replace_regex(const bs_string* str, const char* pattern, co
 bs_string_array* bs_string_regex_split(const bs_string* str, const char* pattern);
 bs_string_array* bs_string_regex_find_all(const bs_string* str, const char* pattern);
 bs_string* bs_string_format(const char* format, ...);
+bs_string* bs_string_vformat(const char* format, va_list args);
 
-// 内部工具函数声明
-static size_t utf8_strlen(const char* str, size_t byte_length);
-static size_t utf8_char_size(const uint8_t* str);
-static uint32_t utf8_decode_char(const uint8_t* str);
-static size_t utf8_encode_char(uint32_t ch, uint8_t* buffer);
-static bs_string* bs_string_alloc(size_t byte_length, bs_encoding_t encoding);
-
-#ifdef BETTER_STRING_IMPLEMENTATION
+/**
+ * 惰性分割迭代器
+ *
+ * 每次调用bs_split_iter_next返回下一个字段的视图，不分配内存，
+ * 占用空间与字段数量无关。迭代期间源字符串和分隔符必须保持有效。
+ */
+typedef enum {
+    BS_SPLIT_SKIP_EMPTY = 0x01   // 跳过空字段
+} bs_split_flags;
 
-// 内部工具函数实现
+typedef struct bs_split_iter {
+    const uint8_t* data;         // 被分割的数据
+    size_t byte_length;          // 数据字节长度
+    size_t position;             // 下一个字段的起始字节位置
+    const uint8_t* delimiter;    // 分隔符
+    size_t delimiter_length;     // 分隔符字节长度
+    size_t max_splits;           // 最大分割次数，0表示不限制
+    size_t splits;               // 已经分割的次数
+    unsigned flags;              // bs_split_flags的组合
+    bool finished;               // 是否已经返回最后一个字段
+} bs_split_iter;
 
-static bs_string* bs_string_alloc(size_t byte_length, bs_encoding_t encoding) {
-    bs_string* str = (bs_string*)malloc(sizeof(bs_string));
-    if (!str) {
-        return NULL;
-    }
-    
-    str->data = (uint8_t*)malloc(byte_length + 1); // 额外的空间用于null终止符
-    if (!str->data) {
-        free(str);
-        return NULL;
-    }
-    
-    str->data[byte_length] = '\0'; // 确保null终止
-    str->byte_length = byte_length;
-    str->length = 0; // 初始长度为0，会在具体构造函数中设置
-    str->encoding = encoding;
-    str->is_view = false;
-    
-    return str;
-}
+/**
+ * 初始化分割迭代器
+ * @param it 迭代器
+ * @param str 被分割的字符串
+ * @param delimiter 分隔符，为空时整个字符串作为一个字段
+ * @param max_splits 最大分割次数，达到后剩余部分作为最后一个字段，0表示不限制
+ * @param flags bs_split_flags的组合
+ */
+void bs_split_iter_init(bs_split_iter* it, const bs_string* str, const char* delimiter,
+                        size_t max_splits, unsigned flags);
+/**
+ * 获取下一个字段
+ * @param it 迭代器
+ * @param field 输出字段视图，引用源字符串的内存
+ * @return 有字段时返回true，分割结束返回false
+ */
+bool bs_split_iter_next(bs_split_iter* it, bs_string* field);
 
-static size_t utf8_strlen(const char* str, size_t byte_length) {
-    if (!str || byte_length == 0) {
-        return 0;
-    }
-    
-    size_t length = 0;
-    const uint8_t* data = (const uint8_t*)str;
-    size_t i = 0;
-    
-    while (i < byte_length) {
-        i += utf8_char_size(data + i);
-        length++;
-    }
-    
-    return length;
-}
+/**
+ * 紧凑字符串数组
+ *
+ * 所有字段首尾相接存放在一个字节缓冲区中，用length+1个偏移量描述边界
+ * （与Arrow的LargeString布局相同），第i个字段为data[offsets[i], offsets[i+1])。
+ * 整个数组只有一次内存分配，遍历是线性访问，可以直接交给列式处理代码。
+ */
+typedef struct bs_compact_array {
+    uint8_t* data;           // 字段数据缓冲区（末尾额外有一个null终止符）
+    size_t* offsets;         // 字段偏移数组，共length+1项
+    size_t length;           // 字段数量
+} bs_compact_array;
 
-static size_t utf8_char_size(const uint8_t* str) {
-    if (!str || !*str) {
-        return 0;
-    }
-    
-    if ((*str & 0x80) == 0) {
-        return 1; // ASCII字符
-    } else if ((*str & 0xE0) == 0xC0) {
-        return 2; // 2字节UTF-8
-    } else if ((*str & 0xF0) == 0xE0) {
-        return 3; // 3字节UTF-8
-    } else if ((*str & 0xF8) == 0xF0) {
-        return 4; // 4字节UTF-8
-    }
-    
-    // 无效的UTF-8序列，假设为1字节
-    return 1;
-}
+/**
+ * 按分隔符分割为紧凑数组
+ * @param str 源字符串
+ * @param delimiter 分隔符
+ * @param max_splits 最大分割次数，0表示不限制
+ * @param flags bs_split_flags的组合
+ * @return 新的紧凑数组，失败返回NULL
+ */
+bs_compact_array* bs_string_split_compact(const bs_string* str, const char* delimiter,
+                                          size_t max_splits, unsigned flags);
+/**
+ * 查找所有匹配，结果存为紧凑数组（模式按字面子串匹配）
+ */
+bs_compact_array* bs_string_regex_find_all_compact(const bs_string* str, const char* pattern);
+/**
+ * 从普通字符串数组复制出紧凑数组
+ */
+bs_compact_array* bs_compact_array_from_array(const bs_string_array* array);
+/**
+ * 获取第index个字段的视图
+ */
+bs_string bs_compact_array_get(const bs_compact_array* array, size_t index);
+/**
+ * 使用分隔符连接紧凑数组的所有字段
+ */
+bs_string* bs_string_join_compact(const bs_compact_array* array, const char* delimiter);
+void bs_compact_array_free(bs_compact_array* array);
 
-static uint32_t utf8_decode_char(const uint8_t* str) {
-    if (!str || !*str) {
-        return 0;
-    }
-    
-    size_t size = utf8_char_size(str);
-    uint32_t ch = 0;
-    
-    switch (size) {
-        case 1:
-            return *str;
-        case 2:
-            ch = ((str[0] & 0x1F) << 6) | (str[1] & 0x3F);
-            break;
-        case 3:
-            ch = ((str[0] & 0x0F) << 12) | ((str[1] & 0x3F) << 6) | (str[2] & 0x3F);
-            break;
-        case 4:
-            ch = ((str[0] & 0x07) << 18) | ((str[1] & 0x3F) << 12) | ((str[2] & 0x3F) << 6) | (str[3] & 0x3F);
-            break;
-        default:
-            return 0; // 无效的UTF-8序列
-    }
-    
-    return ch;
-}
+/**
+ * CSV/TSV读取器
+ *
+ * 以64字节为一块，用位掩码同时分类引号、分隔符和换行符，
+ * 通过引号掩码的前缀异或得到"在引号内"的区域，从而一次找出所有有效的字段边界。
+ * 字段以视图形式返回，直接引用输入数据；只有跨越两个输入块的那一行会被复制。
+ * 支持"\n"和"\r\n"换行。
+ */
+typedef struct bs_csv_dialect {
+    char delimiter;          // 字段分隔符，CSV为','，TSV为'\t'
+    char quote;              // 引号字符，为'\0'时不处理引号
+} bs_csv_dialect;
 
-static size_t utf8_encode_char(uint32_t ch, uint8_t* buffer) {
-    if (!buffer) {
-        return 0;
-    }
-    
-    if (ch < 0x80) {
-        // ASCII字符
-        buffer[0] = (uint8_t)ch;
-        return 1;
-    } else if (ch < 0x800) {
-        // 2字节UTF-8
-        buffer[0] = 0xC0 | (ch >> 6);
-        buffer[1] = 0x80 | (ch & 0x3F);
-        return 2;
-    } else if (ch < 0x10000) {
-        // 3字节UTF-8
-        buffer[0] = 0xE0 | (ch >> 12);
-        buffer[1] = 0x80 | ((ch >> 6) & 0x3F);
-        buffer[2] = 0x80 | (ch & 0x3F);
-        return 3;
-    } else if (ch < 0x110000) {
-        // 4字节UTF-8
-        buffer[0] = 0xF0 | (ch >> 18);
-        buffer[1] = 0x80 | ((ch >> 12) & 0x3F);
-        buffer[2] = 0x80 | ((ch >> 6) & 0x3F);
-        buffer[3] = 0x80 | (ch & 0x3F);
-        return 4;
-    }
-    
-    // 无效的Unicode代码点
-    buffer[0] = '?';
-    return 1;
-}
+typedef struct bs_csv_field {
+    bs_string value;         // 字段内容视图（已去掉外层引号）
+    bool quoted;             // 字段是否被引号包围
+    bool needs_unescape;     // 内容中含有转义的引号（如""），需要bs_csv_unescape处理
+} bs_csv_field;
 
-// 修饰方法实现
-bs_string* bs_string_trim(const bs_string* str) {
-    if (!str || !str->data || str->byte_length == 0) {
-        return bs_string_new("");
-    }
-    
-    // 找到开始和结束的非空白字符位置
-    size_t start = 0;
-    size_t end = str->byte_length;
-    const char* cstr = (const char*)str->data;
-    
-    // 查找开始位置
-    while (start < end && isspace(cstr[start])) {
-        start++;
-    }
-    
-    // 查找结束位置
-    while (end > start && isspace(cstr[end - 1])) {
-        end--;
-    }
-    
-    // 创建新字符串
-    return bs_string_new_len(cstr + start, end - start);
-}
+typedef struct bs_csv_record {
+    const bs_csv_field* fields;  // 字段数组，由读取器持有
+    size_t count;                // 字段数量
+} bs_csv_record;
 
-bs_string* bs_string_trim_start(const bs_string* str) {
-    if (!str || !str->data || str->byte_length == 0) {
-        return bs_string_new("");
-    }
-    
-    // 找到开始的非空白字符位置
-    size_t start = 0;
-    const char* cstr = (const char*)str->data;
-    
-    // 查找开始位置
-    while (start < str->byte_length && isspace(cstr[start])) {
-        start++;
-    }
-    
-    // 创建新字符串
-    return bs_string_new_len(cstr + start, str->byte_length - start);
-}
+typedef struct bs_csv_reader bs_csv_reader;
 
-bs_string* bs_string_trim_end(const bs_string* str) {
-    if (!str || !str->data || str->byte_length == 0) {
-        return bs_string_new("");
-    }
-    
-    // 找到结束的非空白字符位置
-    size_t end = str->byte_length;
-    const char* cstr = (const char*)str->data;
-    
-    // 查找结束位置
-    while (end > 0 && isspace(cstr[end - 1])) {
-        end--;
-    }
-    
-    // 创建新字符串
-    return bs_string_new_len(cstr, end);
-}
+/**
+ * 创建读取器
+ * @param dialect 方言，为NULL时使用标准CSV（','和'"'）
+ * @return 新的读取器
+ */
+bs_csv_reader* bs_csv_reader_new(const bs_csv_dialect* dialect);
+/**
+ * 提供下一块输入数据
+ * 调用前应先用bs_csv_reader_next读完上一块的所有记录。
+ * 数据在读完这一块的记录之前必须保持有效。
+ * @param reader 读取器
+ * @param data 输入数据
+ * @param length 数据字节长度
+ * @param last 是否为最后一块
+ */
+void bs_csv_reader_feed(bs_csv_reader* reader, const char* data, size_t length, bool last);
+/**
+ * 读取下一条记录
+ * @param reader 读取器
+ * @param record 输出记录，字段视图在下一次调用bs_csv_reader_next或bs_csv_reader_feed前有效
+ * @return 读到完整记录返回true；需要更多输入、已读完或出错返回false，用bs_csv_reader_error区分
+ */
+bool bs_csv_reader_next(bs_csv_reader* reader, bs_csv_record* record);
+// 内存不足时返回true，此后读取器不再产出记录，feed也被忽略
+bool bs_csv_reader_error(const bs_csv_reader* reader);
+void bs_csv_reader_free(bs_csv_reader* reader);
+/**
+ * 还原字段中转义的引号
+ * @param field 字段
+ * @param quote 引号字符
+ * @return 新的字符串
+ */
+bs_string* bs_csv_unescape(const bs_csv_field* field, char quote);
 
-bs_string* bs_string_to_upper(const bs_string* str) {
-    if (!str) {
-        return NULL;
-    }
-    
-    // 创建一个新的字符串作为结果
-    bs_string* result = bs_string_copy(str);
-    if (!result) {
-        return NULL;
-    }
-    
-    // 对ASCII字符执行大写转换
-    char* data = (char*)result->data;
-    for (size_t i = 0; i < result->byte_length; i++) {
-        // 只对ASCII字符进行转换
-        if ((data[i] & 0x80) == 0 && islower(data[i])) {
-            data[i] = toupper(data[i]);
-        }
-    }
-    
-    return result;
-}
+/**
+ * 整数格式化与解析
+ */
+// 格式化一个int64_t最多需要的字节数（含负号）
+#define BS_INT_MAX_CHARS 20
 
-bs_string* bs_string_to_lower(const bs_string* str) {
-    if (!str) {
-        return NULL;
-    }
-    
-    // 创建一个新的字符串作为结果
-    bs_string* result = bs_string_copy(str);
-    if (!result) {
-        return NULL;
-    }
-    
-    // 对ASCII字符执行小写转换
-    char* data = (char*)result->data;
-    for (size_t i = 0; i < result->byte_length; i++) {
-        // 只对ASCII字符进行转换
-        if ((data[i] & 0x80) == 0 && isupper(data[i])) {
-            data[i] = tolower(data[i]);
-        }
-    }
-    
-    return result;
-}
+/**
+ * 把整数格式化到调用者的缓冲区，不写入null终止符
+ * @param value 整数
+ * @param buffer 输出缓冲区，至少BS_INT_MAX_CHARS字节
+ * @return 写入的字节数
+ */
+size_t bs_int_to_chars(int64_t value, char* buffer);
+/**
+ * 解析字节范围内的十进制整数，格式为[+-]?[0-9]+，不允许空白
+ * @param str 数据
+ * @param length 字节长度
+ * @param value 输出值
+ * @return 格式正确且没有溢出时返回true
+ */
+bool bs_parse_int(const char* str, size_t length, int64_t* value);
+/**
+ * 批量解析整数
+ * @param array 字符串数组
+ * @param values 输出数组，至少array->length项，解析失败的项写入0
+ * @param ok 可选的输出数组，记录每一项是否解析成功，可以为NULL
+ * @return 成功解析的数量
+ */
+size_t bs_string_array_parse_int(const bs_string_array* array, int64_t* values, bool* ok);
+size_t bs_compact_array_parse_int(const bs_compact_array* array, int64_t* values, bool* ok);
+/**
+ * 批量格式化整数到一个紧凑数组中
+ * @param values 整数数组
+ * @param count 数量
+ * @return 新的紧凑数组
+ */
+bs_compact_array* bs_compact_array_from_ints(const int64_t* values, size_t count);
 
-// 简单的正则表达式操作实现
-// 注意：这是非常基础的实现，只支持简单的模式匹配
-// 完整实现应该使用成熟的正则表达式库
+/**
+ * 浮点数格式化与解析
+ */
+// 格式化一个double最多需要的字节数
+#define BS_FLOAT_MAX_CHARS 32
 
-bool bs_string_matches(const bs_string* str, const char* pattern) {
+/**
+ * 把浮点数格式化为能够精确往返的最短十进制表示，不写入null终止符
+ * 格式与JavaScript的Number转换一致，例如"0.1"、"1e+21"、"-0"、"inf"、"nan"
+ * 与区域设置无关
+ * @param value 浮点数
+ * @param buffer 输出缓冲区，至少BS_FLOAT_MAX_CHARS字节
+ * @return 写入的字节数
+ */
+size_t bs_float_to_chars(double value, char* buffer);
+/**
+ * 解析字节范围内的十进制浮点数，结果正确舍入
+ * 格式为[+-]?(digits[.digits]|.digits)([eE][+-]?digits)?，或不区分大小写的inf、infinity、nan
+ * 小数点固定为'.'，与区域设置无关，不允许空白
+ * @param str 数据
+ * @param length 字节长度
+ * @param value 输出值
+ * @return 格式正确时返回true
+ */
+bool bs_parse_float(const char* str, size_t length, double* value);
+/**
+ * 批量解析浮点数
+ * @param array 字符串数组
+ * @param values 输出数组，至少array->length项，解析失败的项写入0
+ * @param ok 可选的输出数组，记录每一项是否解析成功，可以为NULL
+ * @return 成功解析的数量
+ */
+size_t bs_string_array_parse_float(const bs_string_array* array, double* values, bool* ok);
+size_t bs_compact_array_parse_float(const bs_compact_array* array, double* values, bool* ok);
+/**
+ * 批量格式化浮点数到一个紧凑数组中
+ * @param values 浮点数数组
+ * @param count 数量
+ * @return 新的紧凑数组
+ */
+bs_compact_array* bs_compact_array_from_floats(const double* values, size_t count);
+
+/**
+ * 字符串构建器
+ *
+ * 由若干块组成，追加时只在当前块写满后分配新块，已经写入的字节不会移动。
+ * bs_builder_finish一次复制得到连续的字符串，bs_builder_flush直接把各块写入
+ * 文件描述符，不需要先拼接出完整字符串。
+ */
+typedef struct bs_builder bs_builder;
+
+/**
+ * 创建构建器
+ * @param chunk_size 第一块的字节数，0表示使用默认值；后续块按倍数增长
+ * @return 新的构建器，失败时返回NULL
+ */
+bs_builder* bs_builder_new(size_t chunk_size);
+void bs_builder_free(bs_builder* builder);
+
+/**
+ * 追加内容，失败（内存不足）时返回false，已有内容保持不变
+ */
+bool bs_builder_append(bs_builder* builder, const char* data, size_t length);
+bool bs_builder_append_cstr(bs_builder* builder, const char* str);
+bool bs_builder_append_string(bs_builder* builder, const bs_string* str);
+bool bs_builder_append_char(bs_builder* builder, char c);
+bool bs_builder_append_codepoint(bs_builder* builder, uint32_t codepoint);
+bool bs_builder_append_int(bs_builder* builder, int64_t value);
+bool bs_builder_append_float(bs_builder* builder, double value);
+/**
+ * 追加带双引号的JSON字符串，转义引号、反斜杠和控制字符
+ */
+bool bs_builder_append_json_string(bs_builder* builder, const char* data, size_t length);
+/**
+ * 追加一个CSV字段，字段包含分隔符、引号或换行时加引号并把引号加倍
+ * @param dialect 方言，为NULL时使用逗号和双引号
+ */
+bool bs_builder_append_csv_field(bs_builder* builder, const char* data, size_t length,
+                                 const bs_csv_dialect* dialect);
+
+/**
+ * 获取已写入的字节数
+ */
+size_t bs_builder_length(const bs_builder* builder);
+/**
+ * 分块访问已写入的内容，视图在下一次修改构建器之前有效
+ */
+size_t bs_builder_chunk_count(const bs_builder* builder);
+bs_string bs_builder_chunk(const bs_builder* builder, size_t index);
+
+/**
+ * 生成连续的字符串并清空构建器，构建器可以继续使用
+ * @return 新的字符串，失败时返回NULL且构建器内容不变
+ */
+bs_string* bs_builder_finish(bs_builder* builder);
+/**
+ * 把内容写入文件描述符或文件并清空构建器
+ * @return 全部写入成功时返回true；失败时构建器内容不变，但可能已经写出了一部分
+ */
+bool bs_builder_flush(bs_builder* builder, int fd);
+bool bs_builder_flush_file(bs_builder* builder, FILE* file);
+/**
+ * 清空构建器，保留第一块以便复用
+ */
+void bs_builder_clear(bs_builder* builder);
+
+/**
+ * 绳索（rope）
+ *
+ * 适合频繁编辑的大文本。内容按UTF-8字符边界分成不超过1KB的块，存放在平衡的
+ * B树叶子中，每个节点缓存子树的字符数、字节数和换行数，因此插入、删除、按字符
+ * 索引和取子串都是O(log n)。位置参数都以字符（码点）为单位。
+ */
+typedef struct bs_rope bs_rope;
+struct bs_rope_node;
+
+#define BS_ROPE_MAX_DEPTH 24
+
+/**
+ * 按顺序遍历各块的迭代器，遍历期间不能修改绳索
+ */
+typedef struct bs_rope_iter {
+    const struct bs_rope_node* path[BS_ROPE_MAX_DEPTH];
+    unsigned child[BS_ROPE_MAX_DEPTH];
+    int depth;                   // 当前叶子所在深度，-1表示结束
+} bs_rope_iter;
+
+/**
+ * 创建空绳索，或从已有内容创建
+ * @return 新的绳索，失败时返回NULL
+ */
+bs_rope* bs_rope_new(void);
+bs_rope* bs_rope_from_cstr(const char* data, size_t length);
+bs_rope* bs_rope_from_string(const bs_string* str);
+void bs_rope_free(bs_rope* rope);
+
+/**
+ * 获取字符数、字节数和行数（换行数加一）
+ */
+size_t bs_rope_length(const bs_rope* rope);
+size_t bs_rope_byte_length(const bs_rope* rope);
+size_t bs_rope_line_count(const bs_rope* rope);
+
+/**
+ * 在字符位置插入UTF-8文本
+ * @return 成功返回true；失败（位置越界或内存不足）时内容不变
+ */
+bool bs_rope_insert(bs_rope* rope, size_t index, const char* data, size_t length);
+bool bs_rope_append(bs_rope* rope, const char* data, size_t length);
+/**
+ * 删除从index开始的count个字符，超出末尾的部分被忽略
+ */
+void bs_rope_delete(bs_rope* rope, size_t index, size_t count);
+
+/**
+ * 获取指定位置的字符，越界时返回0
+ */
+uint32_t bs_rope_char_at(const bs_rope* rope, size_t index);
+/**
+ * 复制子串或全部内容
+ */
+bs_string* bs_rope_substring(const bs_rope* rope, size_t start, size_t length);
+bs_string* bs_rope_to_string(const bs_rope* rope);
+
+/**
+ * 行号与字符位置的转换，行号从0开始
+ * bs_rope_line_to_char在行号超出范围时返回字符数
+ */
+size_t bs_rope_line_to_char(const bs_rope* rope, size_t line);
+size_t bs_rope_char_to_line(const bs_rope* rope, size_t index);
+
+/**
+ * 遍历各块，chunk为引用内部数据的视图
+ */
+void bs_rope_iter_init(bs_rope_iter* it, const bs_rope* rope);
+bool bs_rope_iter_next(bs_rope_iter* it, bs_string* chunk);
+
+/**
+ * 全局字符串驻留表
+ *
+ * 相同内容只保存一份不可变的规范字符串，驻留后的字符串可以直接比较指针，
+ * 哈希值在驻留时计算并缓存。驻留表按哈希分片，每个分片一把读写锁，
+ * 已驻留字符串的查找只需要读锁。返回的字符串不能修改或释放。
+ */
+
+/**
+ * 驻留字符串，得到的字符串永久保留
+ * @return 规范字符串，内存不足时返回NULL
+ */
+const bs_string* bs_intern(const char* data, size_t length);
+const bs_string* bs_intern_cstr(const char* str);
+const bs_string* bs_intern_string(const bs_string* str);
+
+/**
+ * 驻留字符串并持有一个弱引用，与bs_intern_release配对使用
+ * 没有被bs_intern永久驻留的字符串在最后一个引用释放时从表中删除，
+ * 这样驻留表不会无限增长
+ */
+const bs_string* bs_intern_acquire(const char* data, size_t length);
+void bs_intern_release(const bs_string* interned);
+
+/**
+ * 获取驻留字符串缓存的哈希值，参数必须是驻留表返回的字符串
+ */
+uint64_t bs_intern_hash(const bs_string* interned);
+
+/**
+ * 获取驻留表中的字符串数量
+ */
+size_t bs_intern_count(void);
+
+/**
+ * 64位哈希（wyhash算法）
+ * 长输入每次处理48字节，三条独立的64位乘法链并行执行
+ * 结果只在进程内稳定，不同平台或版本之间可能不同，不要持久化
+ * @param seed 随机种子，可以用来抵御哈希洪水攻击
+ */
+uint64_t bs_hash(const void* data, size_t length, uint64_t seed);
+/**
+ * 计算种子为0的哈希并缓存在字符串中，再次调用直接返回缓存值
+ * 第一次调用会写入字符串，多个线程共享同一字符串时应先在一个线程中调用
+ */
+uint64_t bs_string_hash(const bs_string* str);
+uint64_t bs_string_hash_seeded(const bs_string* str, uint64_t seed);
+
+/**
+ * 按码点顺序（与bs_string_compare一致）原地排序字符串指针数组，元素不能为NULL
+ * 使用缓存键的多关键字快速排序：每层比较7个字节，公共前缀不会重复比较
+ */
+void bs_string_sort(bs_string** strings, size_t count);
+/**
+ * 并行版本：抽样选出分隔串把字符串分到多个桶，各线程轮流领取桶排序，
+ * 每个桶从两侧分隔串的公共前缀之后开始比较。threads为0时使用CPU核心数，
+ * 数据量较小或内存不足时退化为bs_string_sort
+ */
+void bs_string_sort_parallel(bs_string** strings, size_t count, size_t threads);
+void bs_string_array_sort(bs_string_array* array);
+void bs_string_array_sort_parallel(bs_string_array* array, size_t threads);
+
+/**
+ * 线程池
+ *
+ * 固定数量的工作线程，并行循环把下标区间切成块，每个线程先处理分到自己的连续块，
+ * 做完后从其他线程的区间末尾窃取一半。同一时刻只执行一个并行循环，
+ * 多个线程同时提交时依次执行；不能在任务回调中再向同一个线程池提交。
+ */
+typedef struct bs_thread_pool bs_thread_pool;
+
+/**
+ * @param threads 参与计算的线程数（包括提交任务的线程），0表示CPU核心数；
+ *                1表示不创建工作线程，所有块在调用线程上按顺序执行，便于测试
+ * @return 新的线程池，失败返回NULL
+ */
+bs_thread_pool* bs_thread_pool_new(size_t threads);
+void bs_thread_pool_free(bs_thread_pool* pool);
+size_t bs_thread_pool_size(const bs_thread_pool* pool);
+/**
+ * 并行执行fn(ctx, begin, end)，覆盖[0, count)，每块最多grain个下标（0表示自动）
+ * pool为NULL时在调用线程上按顺序执行
+ */
+void bs_thread_pool_for(bs_thread_pool* pool, size_t count, size_t grain,
+                        void (*fn)(void* ctx, size_t begin, size_t end), void* ctx);
+
+/**
+ * 批量转换
+ *
+ * 对数组中的每个字符串做同样的转换，结果写入一个紧凑数组。先并行计算每个结果的长度，
+ * 再一次分配缓冲区，并行写入各自的位置；每块约64KB输入，与输出一起留在L2缓存中。
+ * pool为NULL时在调用线程上按顺序执行，结果与并行执行相同。
+ */
+
+/**
+ * 转换回调：out为NULL时只返回结果的字节数；否则写入恰好这么多字节。
+ * 两次调用必须给出相同的长度，回调可能在多个线程上同时执行。
+ * 数组中的NULL按空字符串传给回调，str不会为NULL
+ */
+typedef size_t (*bs_string_map_fn)(const bs_string* str, uint8_t* out, void* user);
+
+bs_compact_array* bs_string_array_map(const bs_string_array* array, bs_string_map_fn fn, void* user,
+                                      bs_thread_pool* pool);
+// ASCII大小写转换，与bs_string_to_lower/bs_string_to_upper一致
+bs_compact_array* bs_string_array_to_lower(const bs_string_array* array, bs_thread_pool* pool);
+bs_compact_array* bs_string_array_to_upper(const bs_string_array* array, bs_thread_pool* pool);
+// flags与bs_string_trim_view相同
+bs_compact_array* bs_string_array_trim(const bs_string_array* array, unsigned flags, bs_thread_pool* pool);
+
+/**
+ * 并行查找
+ *
+ * 把字符串切成约1MB的块交给线程池，相邻块重叠needle长度减1个字节，
+ * 跨块的匹配只由起点所在的块报告，结果按位置顺序合并。
+ * 字符串小于256KB或pool为NULL时在调用线程上顺序查找，结果相同。
+ * 互相重叠的出现位置都会计入（"aaa"中"aa"出现两次），空needle没有匹配。
+ */
+typedef struct {
+    size_t* positions;       // 匹配的起始字节偏移，升序
+    size_t length;           // 匹配数量
+} bs_match_list;
+
+/**
+ * 查找所有出现位置
+ * @return 字节偏移列表，用bs_match_list_free释放；失败返回NULL
+ */
+bs_match_list* bs_string_find_all(const bs_string* str, const bs_string* find, bs_thread_pool* pool);
+void bs_match_list_free(bs_match_list* list);
+size_t bs_string_count(const bs_string* str, const bs_string* find, bs_thread_pool* pool);
+// 任一块找到匹配后，其余尚未开始的块直接跳过
+bool bs_string_contains_parallel(const bs_string* str, const bs_string* find, bs_thread_pool* pool);
+
+/**
+ * 文件映射
+ *
+ * 把整个文件只读映射为视图字符串，内容不复制，按需从页缓存读入。
+ * 映射的字符串可以传给所有只读函数；数据不以null结尾，和其他视图一样。
+ * 字符数在第一次需要时才统计，在此之前length字段为BS_LENGTH_UNKNOWN，
+ * 直接访问结构体时请使用bs_string_length。多个线程可以同时读取同一个映射的字符串。
+ */
+#define BS_LENGTH_UNKNOWN SIZE_MAX
+
+typedef enum {
+    BS_MAP_NORMAL     = 0x00,
+    BS_MAP_SEQUENTIAL = 0x01,  // 将顺序读取，内核可以加大预读并尽早回收读过的页
+    BS_MAP_WILLNEED   = 0x02   // 立即开始在后台读入整个文件
+} bs_map_flags;
+
+/**
+ * @param path 文件路径
+ * @param flags bs_map_flags的组合，只是提示，不支持的平台上忽略
+ * @return 只读视图，必须用bs_string_unmap释放；失败返回NULL，errno说明原因
+ */
+bs_string* bs_string_map_file(const char* path, unsigned flags);
+void bs_string_unmap(bs_string* str);
+
+/**
+ * 按行读取
+ *
+ * 从文件描述符、FILE*或自定义数据源按行读取，缓冲区是一个滑动窗口：
+ * 只有在需要补充数据时才把未读完的半行移到开头，行比缓冲区长时缓冲区加倍。
+ * 返回的行是指向缓冲区的视图，不含行尾的"\n"或"\r\n"，在下一次调用前有效。
+ * 行的字符数在第一次需要时才统计（见bs_string_length）。
+ */
+typedef struct bs_line_reader bs_line_reader;
+
+/**
+ * 数据源回调：最多读入capacity字节到buffer
+ * @return 读入的字节数，0表示结束，负数表示错误
+ */
+typedef ptrdiff_t (*bs_read_fn)(void* ctx, uint8_t* buffer, size_t capacity);
+
+/**
+ * @param buffer_size 初始缓冲区大小，0表示256KB
+ * @return 新的读取器，不拥有数据源；失败返回NULL
+ */
+bs_line_reader* bs_line_reader_new(bs_read_fn read, void* ctx, size_t buffer_size);
+bs_line_reader* bs_line_reader_new_fd(int fd, size_t buffer_size);
+bs_line_reader* bs_line_reader_new_file(FILE* file, size_t buffer_size);
+void bs_line_reader_free(bs_line_reader* reader);
+/**
+ * 读取下一行，最后一行没有换行符时也会返回
+ * @param line 输出的视图，在下一次调用bs_line_reader_next或释放读取器前有效
+ * @return 读到一行返回true；结束或出错返回false，用bs_line_reader_error区分
+ */
+bool bs_line_reader_next(bs_line_reader* reader, bs_string* line);
+bool bs_line_reader_error(const bs_line_reader* reader);
+
+/**
+ * 批量输出
+ *
+ * 把多段数据用一次writev系统调用写出，不需要先拼接成一个字符串。
+ * 处理部分写入和信号中断；Windows没有writev，逐段写出。
+ */
+typedef struct {
+    const uint8_t* data;
+    size_t length;
+} bs_iovec;
+
+/**
+ * 写出全部数据，适用于阻塞的文件描述符
+ * @param iov 要写出的数组，部分写入时函数会原地调整其中的项
+ * @return 全部写入返回true；出错返回false，errno说明原因，可能已经写出了一部分
+ */
+bool bs_writev_all(int fd, bs_iovec* iov, size_t count);
+/**
+ * 尽量写出数据，遇到EAGAIN/EWOULDBLOCK时返回，适用于非阻塞的文件描述符和事件循环
+ * 写完的项被跳过，写了一部分的项原地调整data和length
+ * @param count 输入为项数，输出为剩余的项数，为0时全部写完
+ * @return 剩余的第一项，之后可以用同样的参数继续调用；出错返回NULL，errno说明原因。
+ *         *count为0时返回值只表示成功，不应再访问；传入空列表（包括iov为NULL）也返回成功
+ */
+bs_iovec* bs_writev_some(int fd, bs_iovec* iov, size_t* count);
+// 依次写出count个字符串，NULL按空字符串处理
+bool bs_write_all(int fd, const bs_string* const* strings, size_t count);
+bool bs_write_array(int fd, const bs_string_array* array);
+
+/**
+ * 批量读取文件
+ *
+ * 把一批文件读入新的字符串。Linux上通过io_uring成批提交打开和读取请求，
+ * 按文件大小预先分配字符串，数据直接读入字符串的缓冲区；内核不支持io_uring
+ * 或被禁用时，以及其他平台上，逐个同步读取，结果相同。
+ */
+
+/**
+ * 每个文件读完后在调用线程上调用一次，顺序不确定
+ * @param index 文件在paths中的下标
+ * @param str 文件内容，所有权交给回调；失败时为NULL
+ * @param error 失败时的errno，成功时为0
+ */
+typedef void (*bs_load_callback)(void* user, size_t index, bs_string* str, int error);
+
+/**
+ * @return 成功读取的文件数
+ */
+size_t bs_load_files(const char* const* paths, size_t count, bs_load_callback callback, void* user);
+
+/**
+ * 流式子串查找
+ *
+ * 数据分块到达时逐块查找，不需要先拼接成一个字符串。匹配位置是从第一块开始
+ * 计算的全局字节偏移，跨越块边界的匹配也会报告；查找器只保存needle、
+ * 一张needle长度的前缀表和当前已匹配的前缀长度，与已输入的数据量无关。
+ * 前缀表在创建时计算一次，bs_stream_searcher_reset后可用于下一个数据流。
+ * 互相重叠的出现位置都会计入，与bs_string_find_all一致，空needle没有匹配。
+ */
+typedef struct bs_stream_searcher bs_stream_searcher;
+
+/**
+ * 匹配回调，按偏移升序调用
+ * @param offset 匹配起点的全局字节偏移
+ */
+typedef void (*bs_match_fn)(void* user, uint64_t offset);
+
+/**
+ * @param needle 要查找的字符串，内容被复制
+ * @return 新的查找器；失败返回NULL
+ */
+bs_stream_searcher* bs_stream_searcher_new(const uint8_t* needle, size_t needle_length);
+void bs_stream_searcher_free(bs_stream_searcher* searcher);
+// 回到数据流开头，保留needle和前缀表
+void bs_stream_searcher_reset(bs_stream_searcher* searcher);
+/**
+ * 输入下一块数据，块不需要保持有效
+ * @param callback 每个在本块内结束的匹配调用一次，可以为NULL
+ * @return 本块内结束的匹配数量
+ */
+size_t bs_stream_searcher_feed(bs_stream_searcher* searcher, const uint8_t* data, size_t length,
+                               bs_match_fn callback, void* user);
+// 已输入的总字节数
+uint64_t bs_stream_searcher_offset(const bs_stream_searcher* searcher);
+
+// 内部工具函数声明
+static size_t utf8_strlen(const char* str, size_t byte_length);
+static size_t utf8_char_size(const uint8_t* str);
+static uint32_t utf8_decode_char(const uint8_t* str);
+static size_t utf8_encode_char(uint32_t ch, uint8_t* buffer);
+static bs_string* bs_string_alloc(size_t byte_length, bs_encoding_t encoding);
+
+#ifdef BETTER_STRING_IMPLEMENTATION
+
+// 文件描述符输出和文件映射
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include <errno.h>
+
+// 批量读取文件：Linux上使用io_uring，定义BETTER_STRING_NO_IO_URING可以关闭
+#if defined(__linux__) && defined(__has_include) && !defined(BETTER_STRING_NO_IO_URING)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#define BS_HAVE_IO_URING 1
+#endif
+#endif
+
+// 驻留表的读写锁、并行排序和线程池的线程
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// 位操作工具函数
+static inline unsigned bs_ctz32(uint32_t x) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, x);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctz(x);
+#endif
+}
+
+static inline unsigned bs_ctz64(uint64_t x) {
+    uint32_t low = (uint32_t)x;
+    return low ? bs_ctz32(low) : 32u + bs_ctz32((uint32_t)(x >> 32));
+}
+
+static inline unsigned bs_clz32(uint32_t x) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, x);
+    return 31u - (unsigned)index;
+#else
+    return (unsigned)__builtin_clz(x);
+#endif
+}
+
+static inline unsigned bs_popcount64(uint64_t x) {
+#if defined(_MSC_VER)
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (unsigned)((x * 0x0101010101010101ULL) >> 56);
+#else
+    return (unsigned)__builtin_popcountll(x);
+#endif
+}
+
+static inline uint64_t bs_load_u64(const uint8_t* p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// 哈希缓存可能被多个线程同时填充（const字符串、写时复制共享的字符串），
+// 先写hash再以release写hash_cached，读取时以acquire读hash_cached，
+// 看到hash_cached为true时hash一定已经写好；各线程写入的值相同
+static inline bool bs_hash_cache_get(const bs_string* str, uint64_t* hash) {
+#if defined(_MSC_VER)
+    if (!*(const volatile bool*)&str->hash_cached) {
+        return false;
+    }
+    MemoryBarrier();
+    *hash = *(const volatile uint64_t*)&str->hash;
+#else
+    if (!__atomic_load_n(&str->hash_cached, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    *hash = __atomic_load_n(&str->hash, __ATOMIC_RELAXED);
+#endif
+    return true;
+}
+
+static inline void bs_hash_cache_set(const bs_string* str, uint64_t hash) {
+    bs_string* cache = (bs_string*)str;
+#if defined(_MSC_VER)
+    *(volatile uint64_t*)&cache->hash = hash;
+    MemoryBarrier();
+    *(volatile bool*)&cache->hash_cached = true;
+#else
+    __atomic_store_n(&cache->hash, hash, __ATOMIC_RELAXED);
+    __atomic_store_n(&cache->hash_cached, true, __ATOMIC_RELEASE);
+#endif
+}
+
+// 内部工具函数实现
+
+static bs_string* bs_string_alloc(size_t byte_length, bs_encoding_t encoding) {
+    bs_string* str = (bs_string*)malloc(sizeof(bs_string));
+    if (!str) {
+        return NULL;
+    }
+    
+    str->data = (uint8_t*)malloc(byte_length + 1); // 额外的空间用于null终止符
+    if (!str->data) {
+        free(str);
+        return NULL;
+    }
+    
+    str->data[byte_length] = '\0'; // 确保null终止
+    str->byte_length = byte_length;
+    str->length = 0; // 初始长度为0，会在具体构造函数中设置
+    str->encoding = encoding;
+    str->is_view = false;
+    str->hash_cached = false;
+    str->hash = 0;
+    
+    return str;
+}
+
+static size_t utf8_strlen(const char* str, size_t byte_length) {
+    if (!str || byte_length == 0) {
+        return 0;
+    }
+    
+    // 字符数 = 字节数 - 续字节(10xxxxxx)数，批量统计续字节而不逐个解码
+    const uint8_t* data = (const uint8_t*)str;
+    size_t continuation = 0;
+    size_t i = 0;
+    
+#ifdef BS_HAVE_SSE2
+    const __m128i top_bits = _mm_set1_epi8((char)0xC0);
+    const __m128i cont_bits = _mm_set1_epi8((char)0x80);
+    for (; i + 16 <= byte_length; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i is_cont = _mm_cmpeq_epi8(_mm_and_si128(chunk, top_bits), cont_bits);
+        continuation += bs_popcount64((uint32_t)_mm_movemask_epi8(is_cont));
+    }
+#endif
+    for (; i + 8 <= byte_length; i += 8) {
+        uint64_t word = bs_load_u64(data + i);
+        // 最高位为1且次高位为0的字节即续字节
+        continuation += bs_popcount64(word & ~(word << 1) & 0x8080808080808080ULL);
+    }
+    for (; i < byte_length; i++) {
+        continuation += (data[i] & 0xC0) == 0x80;
+    }
+    
+    return byte_length - continuation;
+}
+
+// 文件映射的字符串在第一次需要字符数时才统计，结果缓存在字符串里
+// 映射的字符串常被多个线程共享只读，可能同时统计；写入的值相同，用relaxed原子访问避免数据竞争
+static inline size_t bs_char_length(const bs_string* str) {
+    bs_string* cache = (bs_string*)str;
+#if defined(_MSC_VER)
+    size_t length = *(const volatile size_t*)&cache->length;
+#else
+    size_t length = __atomic_load_n(&cache->length, __ATOMIC_RELAXED);
+#endif
+    if (length == BS_LENGTH_UNKNOWN) {
+        length = utf8_strlen((const char*)str->data, str->byte_length);
+#if defined(_MSC_VER)
+        *(volatile size_t*)&cache->length = length;
+#else
+        __atomic_store_n(&cache->length, length, __ATOMIC_RELAXED);
+#endif
+    }
+    return length;
+}
+
+// 读取已知的字符数，尚未统计时返回BS_LENGTH_UNKNOWN而不触发统计
+static inline size_t bs_char_length_known(const bs_string* str) {
+#if defined(_MSC_VER)
+    return *(const volatile size_t*)&str->length;
+#else
+    return __atomic_load_n(&str->length, __ATOMIC_RELAXED);
+#endif
+}
+
+static size_t utf8_char_size(const uint8_t* str) {
+    if (!str || !*str) {
+        return 0;
+    }
+    
+    if ((*str & 0x80) == 0) {
+        return 1; // ASCII字符
+    } else if ((*str & 0xE0) == 0xC0) {
+        return 2; // 2字节UTF-8
+    } else if ((*str & 0xF0) == 0xE0) {
+        return 3; // 3字节UTF-8
+    } else if ((*str & 0xF8) == 0xF0) {
+        return 4; // 4字节UTF-8
+    }
+    
+    // 无效的UTF-8序列，假设为1字节
+    return 1;
+}
+
+static uint32_t utf8_decode_char(const uint8_t* str) {
+    if (!str || !*str) {
+        return 0;
+    }
+    
+    size_t size = utf8_char_size(str);
+    uint32_t ch = 0;
+    
+    switch (size) {
+        case 1:
+            return *str;
+        case 2:
+            ch = ((str[0] & 0x1F) << 6) | (str[1] & 0x3F);
+            break;
+        case 3:
+            ch = ((str[0] & 0x0F) << 12) | ((str[1] & 0x3F) << 6) | (str[2] & 0x3F);
+            break;
+        case 4:
+            ch = ((str[0] & 0x07) << 18) | ((str[1] & 0x3F) << 12) | ((str[2] & 0x3F) << 6) | (str[3] & 0x3F);
+            break;
+        default:
+            return 0; // 无效的UTF-8序列
+    }
+    
+    return ch;
+}
+
+static size_t utf8_encode_char(uint32_t ch, uint8_t* buffer) {
+    if (!buffer) {
+        return 0;
+    }
+    
+    if (ch < 0x80) {
+        // ASCII字符
+        buffer[0] = (uint8_t)ch;
+        return 1;
+    } else if (ch < 0x800) {
+        // 2字节UTF-8
+        buffer[0] = 0xC0 | (ch >> 6);
+        buffer[1] = 0x80 | (ch & 0x3F);
+        return 2;
+    } else if (ch < 0x10000) {
+        // 3字节UTF-8
+        buffer[0] = 0xE0 | (ch >> 12);
+        buffer[1] = 0x80 | ((ch >> 6) & 0x3F);
+        buffer[2] = 0x80 | (ch & 0x3F);
+        return 3;
+    } else if (ch < 0x110000) {
+        // 4字节UTF-8
+        buffer[0] = 0xF0 | (ch >> 18);
+        buffer[1] = 0x80 | ((ch >> 12) & 0x3F);
+        buffer[2] = 0x80 | ((ch >> 6) & 0x3F);
+        buffer[3] = 0x80 | (ch & 0x3F);
+        return 4;
+    }
+    
+    // 无效的Unicode代码点
+    buffer[0] = '?';
+    return 1;
+}
+
+// 视图构造
+bs_string bs_string_view_len(const char* str, size_t byte_length) {
+    bs_string view;
+    if (!str) {
+        str = "";
+        byte_length = 0;
+    }
+    
+    view.data = (uint8_t*)str;
+    view.byte_length = byte_length;
+    view.length = utf8_strlen(str, byte_length);
+    view.encoding = BS_ENCODING_UTF8;
+    view.is_view = true;
+    view.hash_cached = false;
+    view.hash = 0;
+    
+    return view;
+}
+
+bs_string bs_string_view(const char* str) {
+    return bs_string_view_len(str, str ? strlen(str) : 0);
+}
+
+// 空白扫描
+// ASCII空白与C locale下的isspace一致：' ', '\t', '\n', '\v', '\f', '\r'
+static inline bool bs_is_ascii_space(uint8_t ch) {
+    return ch == ' ' || (uint8_t)(ch - '\t') < 5;
+}
+
+// 返回p处Unicode空白字符的字节数，不是空白时返回0
+// 覆盖U+0085、U+00A0、U+1680、U+2000-U+200A、U+2028、U+2029、U+202F、U+205F、U+3000
+static size_t bs_unicode_space_size(const uint8_t* p, size_t avail) {
+    if (avail >= 2 && p[0] == 0xC2) {
+        return (p[1] == 0x85 || p[1] == 0xA0) ? 2 : 0;
+    }
+    if (avail < 3) {
+        return 0;
+    }
+    switch (p[0]) {
+        case 0xE1:
+            return (p[1] == 0x9A && p[2] == 0x80) ? 3 : 0;
+        case 0xE2:
+            if (p[1] == 0x80) {
+                return ((p[2] >= 0x80 && p[2] <= 0x8A) || p[2] == 0xA8 || p[2] == 0xA9 || p[2] == 0xAF) ? 3 : 0;
+            }
+            return (p[1] == 0x81 && p[2] == 0x9F) ? 3 : 0;
+        case 0xE3:
+            return (p[1] == 0x80 && p[2] == 0x80) ? 3 : 0;
+        default:
+            return 0;
+    }
+}
+
+// 从start开始跳过ASCII空白，返回第一个非空白字节的位置
+static size_t bs_skip_ascii_space(const uint8_t* data, size_t start, size_t end) {
+    size_t i = start;
+#ifdef BS_HAVE_SSE2
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i span = _mm_set1_epi8(4);
+    for (; i + 16 <= end; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(data + i));
+        // '\t'..'\r'：减去'\t'后无符号不大于4
+        __m128i shifted = _mm_sub_epi8(chunk, tab);
+        __m128i is_ctrl = _mm_cmpeq_epi8(_mm_min_epu8(shifted, span), shifted);
+        __m128i is_space = _mm_or_si128(is_ctrl, _mm_cmpeq_epi8(chunk, space));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(is_space) ^ 0xFFFFu;
+        if (mask) {
+            return i + bs_ctz32(mask);
+        }
+    }
+#endif
+    while (i < end && bs_is_ascii_space(data[i])) {
+        i++;
+    }
+    return i;
+}
+
+// 从end向前跳过ASCII空白，返回最后一个非空白字节之后的位置
+static size_t bs_skip_ascii_space_back(const uint8_t* data, size_t start, size_t end) {
+    size_t i = end;
+#ifdef BS_HAVE_SSE2
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i span = _mm_set1_epi8(4);
+    for (; i >= start + 16; i -= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(data + i - 16));
+        __m128i shifted = _mm_sub_epi8(chunk, tab);
+        __m128i is_ctrl = _mm_cmpeq_epi8(_mm_min_epu8(shifted, span), shifted);
+        __m128i is_space = _mm_or_si128(is_ctrl, _mm_cmpeq_epi8(chunk, space));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(is_space) ^ 0xFFFFu;
+        if (mask) {
+            return i - 16 + (32 - bs_clz32(mask));
+        }
+    }
+#endif
+    while (i > start && bs_is_ascii_space(data[i - 1])) {
+        i--;
+    }
+    return i;
+}
+
+// 计算修剪后的字节范围[*out_start, *out_end)
+static void bs_trim_bounds(const uint8_t* data, size_t byte_length, unsigned flags,
+                           size_t* out_start, size_t* out_end) {
+    size_t start = 0;
+    size_t end = byte_length;
+    bool unicode = (flags & BS_TRIM_UNICODE) != 0;
+    
+    if (flags & BS_TRIM_START) {
+        for (;;) {
+            start = bs_skip_ascii_space(data, start, end);
+            size_t size = unicode && start < end ? bs_unicode_space_size(data + start, end - start) : 0;
+            if (size == 0) {
+                break;
+            }
+            start += size;
+        }
+    }
+    
+    if (flags & BS_TRIM_END) {
+        for (;;) {
+            end = bs_skip_ascii_space_back(data, start, end);
+            if (!unicode || end == start || data[end - 1] < 0x80) {
+                break;
+            }
+            // Unicode空白只有2字节和3字节两种长度
+            if (end - start >= 2 && bs_unicode_space_size(data + end - 2, 2) == 2) {
+                end -= 2;
+            } else if (end - start >= 3 && bs_unicode_space_size(data + end - 3, 3) == 3) {
+                end -= 3;
+            } else {
+                break;
+            }
+        }
+    }
+    
+    *out_start = start;
+    *out_end = end;
+}
+
+// 修饰方法实现
+bs_string* bs_string_trim_ex(const bs_string* str, unsigned flags) {
+    if (!str || !str->data || str->byte_length == 0) {
+        return bs_string_new("");
+    }
+    
+    size_t start, end;
+    bs_trim_bounds(str->data, str->byte_length, flags, &start, &end);
+    
+    return bs_string_new_len((const char*)(str->data + start), end - start);
+}
+
+bs_string* bs_string_trim(const bs_string* str) {
+    return bs_string_trim_ex(str, BS_TRIM_BOTH);
+}
+
+bs_string* bs_string_trim_start(const bs_string* str) {
+    return bs_string_trim_ex(str, BS_TRIM_START);
+}
+
+bs_string* bs_string_trim_end(const bs_string* str) {
+    return bs_string_trim_ex(str, BS_TRIM_END);
+}
+
+bs_string* bs_string_trim_inplace(bs_string* str, unsigned flags) {
+    if (!str || !str->data || str->byte_length == 0) {
+        return str;
+    }
+    
+    size_t start, end;
+    bs_trim_bounds(str->data, str->byte_length, flags, &start, &end);
+    if (start == 0 && end == str->byte_length) {
+        return str;
+    }
+    
+    // 被修剪的都是空白字符，只需统计这两段的字符数；字符数尚未统计时保持未知
+    size_t length = bs_char_length_known(str);
+    if (length != BS_LENGTH_UNKNOWN) {
+        length -= utf8_strlen((const char*)str->data, start) +
+                  utf8_strlen((const char*)(str->data + end), str->byte_length - end);
+    }
+    
+    if (str->is_view) {
+        // 视图不拥有内存，直接移动数据指针
+        str->data += start;
+    } else {
+        // 拥有内存的字符串必须保持data指向分配的起始地址
+        if (start > 0) {
+            memmove(str->data, str->data + start, end - start);
+        }
+        str->data[end - start] = '\0';
+    }
+    
+    str->byte_length = end - start;
+    str->length = length;
+    str->hash_cached = false;
+    
+    return str;
+}
+
+bs_string bs_string_trim_view(const bs_string* str, unsigned flags) {
+    if (!str || !str->data || str->byte_length == 0) {
+        return bs_string_view_len("", 0);
+    }
+    
+    size_t start, end;
+    bs_trim_bounds(str->data, str->byte_length, flags, &start, &end);
+    
+    bs_string view = *str;
+    view.data = str->data + start;
+    view.byte_length = end - start;
+    // 源字符串的字符数尚未统计时视图也延迟统计，不为了一个视图扫描整个字符串
+    view.length = bs_char_length_known(str);
+    if (view.length != BS_LENGTH_UNKNOWN) {
+        view.length -= utf8_strlen((const char*)str->data, start) +
+                       utf8_strlen((const char*)(str->data + end), str->byte_length - end);
+    }
+    view.is_view = true;
+    view.hash_cached = false;
+    view.hash = 0;
+    
+    return view;
+}
+
+// 简单的正则表达式操作实现
+// 注意：这是非常基础的实现，只支持简单的模式匹配
+// 完整实现应该使用成熟的正则表达式库
+
+bool bs_string_matches(const bs_string* str, const char* pattern) {
+    if (!str || !pattern) {
+        return false;
+    }
+    
+    // 简单实现：使用基础的字符串匹配
+    // 只支持 * 和 ? 通配符
+    
+    const char* s = (const char*)str->data;
+    const char* p = pattern;
+    
+    // 特殊情况：空字符串
+    if (str->byte_length == 0) {
+        return *p == '\0';
+    }
+    
+    // 特殊情况：空模式
+    if (*p == '\0') {
+        return str->byte_length == 0;
+    }
+    
+    // 简单模式匹配
+    if (*p == '*') {
+        // * 可以匹配0个或多个字符
+        while (*(p+1) == '*') p++; // 跳过连续的*
+        
+        if (*(p+1) == '\0') {
+            return true; // 如果模式以*结尾，则匹配任何剩余字符
+        }
+        
+        const char* star_pattern = p + 1;
+        for (size_t i = 0; i <= str->byte_length; i++) {
+            bs_string* substr = bs_string_new_len(s + i, str->byte_length - i);
+            bool result = bs_string_matches(substr, star_pattern);
+            bs_string_free(substr);
+            if (result) {
+                return true;
+            }
+        }
+        return false;
+    } else if (*p == '?') {
+        // ? 匹配任何单个字符
+        return str->byte_length > 0 && bs_string_matches(
+            bs_string_new_len(s + 1, str->byte_length - 1), 
+            p + 1
+        );
+    } else {
+        // 普通字符匹配
+        return str->byte_length > 0 && *s == *p && bs_string_matches(
+            bs_string_new_len(s + 1, str->byte_length - 1), 
+            p + 1
+        );
+    }
+}
+
+bs_string* bs_string_replace_regex(const bs_string* str, const char* pattern, const char* replacement) {
+    if (!str || !pattern || !replacement) {
+        return bs_string_copy(str);
+    }
+    
+    // 简单实现：只支持直接子字符串替换
+    bs_string* pattern_str = bs_string_new(pattern);
+    bs_string* replacement_str = bs_string_new(replacement);
+    
+    // bs_string_replace原地修改，先复制一份
+    bs_string* result = bs_string_copy(str);
+    if (result && pattern_str && replacement_str) {
+        bs_string_replace(result, pattern_str, replacement_str);
+    }
+    
+    bs_string_free(pattern_str);
+    bs_string_free(replacement_str);
+    
+    return result;
+}
+
+bs_string_array* bs_string_regex_split(const bs_string* str, const char* pattern) {
+    if (!str || !pattern) {
+        return NULL;
+    }
+    
+    // 简单实现：直接使用字符串分割
+    return bs_string_split(str, pattern);
+}
+
+bs_string_array* bs_string_regex_find_all(const bs_string* str, const char* pattern) {
+    if (!str || !pattern) {
+        return NULL;
+    }
+    
+    // 简化实现：模式为简单子字符串的情况
+    bs_string* pattern_str = bs_string_new(pattern);
+    
+    // 分配结果数组
+    bs_string_array* result = (bs_string_array*)malloc(sizeof(bs_string_array));
+    if (!result) {
+        bs_string_free(pattern_str);
+        return NULL;
+    }
+    
+    // 查找所有匹配
+    size_t pos = 0;
+    size_t max_matches = 16; // 初始容量
+    result->items = (bs_string**)malloc(max_matches * sizeof(bs_string*));
+    result->length = 0;
+    
+    while (1) {
+        int64_t match_pos = bs_string_find(str, pattern_str, pos);
+        if (match_pos < 0) {
+            break;
+        }
+        
+        // 计算匹配的字节位置
+        size_t byte_pos = 0;
+        for (size_t i = 0; i < match_pos && byte_pos < str->byte_length; ) {
+            byte_pos += utf8_char_size(str->data + byte_pos);
+            i++;
+        }
+        
+        // 添加匹配的子字符串
+        size_t match_len = pattern_str->byte_length;
+        bs_string* match = bs_string_new_len((const char*)(str->data + byte_pos), match_len);
+        
+        // 如果需要扩容
+        if (result->length >= max_matches) {
+            max_matches *= 2;
+            bs_string** new_items = (bs_string**)realloc(result->items, max_matches * sizeof(bs_string*));
+            if (!new_items) {
+                // 内存分配失败，释放资源
+                bs_string_free(match);
+                for (size_t i = 0; i < result->length; i++) {
+                    bs_string_free(result->items[i]);
+                }
+                free(result->items);
+                free(result);
+                bs_string_free(pattern_str);
+                return NULL;
+            }
+            result->items = new_items;
+        }
+        
+        result->items[result->length++] = match;
+        
+        // 移动到下一个位置
+        pos = match_pos + 1;
+    }
+    
+    bs_string_free(pattern_str);
+    return result;
+}
+
+// 构造函数实现
+
+bs_string* bs_string_new(const char* str) {
+    if (!str) {
+        return bs_string_new_len("", 0);
+    }
+    return bs_string_new_len(str, strlen(str));
+}
+
+bs_string* bs_string_new_len(const char* str, size_t byte_length) {
+    if (!str) {
+        str = "";
+        byte_length = 0;
+    }
+    
+    bs_string* result = bs_string_alloc(byte_length, BS_ENCODING_UTF8);
+    if (!result) {
+        return NULL;
+    }
+    
+    memcpy(result->data, str, byte_length);
+    result->byte_length = byte_length;
+    result->length = utf8_strlen(str, byte_length);
+    result->is_view = false;
+    
+    return result;
+}
+
+bs_string* bs_string_new_utf16(const uint16_t* str) {
+    // 简化实现：先转换为UTF-8然后创建
+    if (!str) {
+        return bs_string_new_len("", 0);
+    }
+    
+    // 计算UTF-16字符串长度
+    size_t utf16_len = 0;
+    while (str[utf16_len]) {
+        utf16_len++;
+    }
+    
+    // 估算UTF-8可能需要的最大长度（每个UTF-16字符最多3个UTF-8字节）
+    size_t max_utf8_len = utf16_len * 3;
+    uint8_t* utf8_buf = (uint8_t*)malloc(max_utf8_len + 1);
+    if (!utf8_buf) {
+        return NULL;
+    }
+    
+    // 执行UTF-16到UTF-8的转换
+    size_t utf8_pos = 0;
+    for (size_t i = 0; i < utf16_len; i++) {
+        uint32_t codepoint = str[i];
+        
+        // 处理代理对
+        if (codepoint >= 0xD800 && codepoint <= 0xDBFF && i + 1 < utf16_len) {
+            uint32_t low_surrogate = str[i + 1];
+            if (low_surrogate >= 0xDC00 && low_surrogate <= 0xDFFF) {
+                codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low_surrogate - 0xDC00);
+                i++; // 跳过下一个字符，因为它是代理对的一部分
+            }
+        }
+        
+        // 编码为UTF-8
+        utf8_pos += utf8_encode_char(codepoint, utf8_buf + utf8_pos);
+    }
+    
+    utf8_buf[utf8_pos] = '\0';
+    
+    // 创建字符串
+    bs_string* result = bs_string_new_len((char*)utf8_buf, utf8_pos);
+    free(utf8_buf);
+    
+    return result;
+}
+
+bs_string* bs_string_new_utf32(const uint32_t* str) {
+    // 实现与UTF-16类似，但处理更直接
+    if (!str) {
+        return bs_string_new_len("", 0);
+    }
+    
+    // 计算UTF-32字符串长度
+    size_t utf32_len = 0;
+    while (str[utf32_len]) {
+        utf32_len++;
+    }
+    
+    // 估算UTF-8可能需要的最大长度（每个UTF-32字符最多4个UTF-8字节）
+    size_t max_utf8_len = utf32_len * 4;
+    uint8_t* utf8_buf = (uint8_t*)malloc(max_utf8_len + 1);
+    if (!utf8_buf) {
+        return NULL;
+    }
+    
+    // 执行UTF-32到UTF-8的转换
+    size_t utf8_pos = 0;
+    for (size_t i = 0; i < utf32_len; i++) {
+        utf8_pos += utf8_encode_char(str[i], utf8_buf + utf8_pos);
+    }
+    
+    utf8_buf[utf8_pos] = '\0';
+    
+    // 创建字符串
+    bs_string* result = bs_string_new_len((char*)utf8_buf, utf8_pos);
+    free(utf8_buf);
+    
+    return result;
+}
+
+bs_string* bs_string_new_with_encoding(const void* str, size_t byte_length, bs_encoding_t encoding) {
+    if (!str) {
+        return bs_string_new_len("", 0);
+    }
+    
+    switch (encoding) {
+        case BS_ENCODING_UTF8:
+            return bs_string_new_len((const char*)str, byte_length);
+        
+        case BS_ENCODING_UTF16:
+            return bs_string_new_utf16((const uint16_t*)str);
+        
+        case BS_ENCODING_UTF32:
+            return bs_string_new_utf32((const uint32_t*)str);
+        
+        case BS_ENCODING_ASCII:
+            // ASCII可以直接当作UTF-8处理
+            return bs_string_new_len((const char*)str, byte_length);
+            
+        default:
+            return NULL;
+    }
+}
+
+bs_string* bs_string_copy(const bs_string* str) {
+    if (!str) {
+        return NULL;
+    }
+    
+    bs_string* result = bs_string_alloc(str->byte_length, str->encoding);
+    if (!result) {
+        return NULL;
+    }
+    
+    memcpy(result->data, str->data, str->byte_length);
+    result->byte_length = str->byte_length;
+    result->length = bs_char_length(str);
+    result->is_view = false;
+    
+    return result;
+}
+
+void bs_string_free(bs_string* str) {
+    if (str) {
+        if (!str->is_view && str->data) {
+            free(str->data);
+        }
+        free(str);
+    }
+}
+
+// 字符串属性实现
+
+size_t bs_string_length(const bs_string* str) {
+    return str ? bs_char_length(str) : 0;
+}
+
+size_t bs_string_byte_length(const bs_string* str) {
+    return str ? str->byte_length : 0;
+}
+
+bs_encoding_t bs_string_encoding(const bs_string* str) {
+    return str ? str->encoding : BS_ENCODING_UTF8;
+}
+
+const char* bs_string_c_str(const bs_string* str) {
+    if (!str) {
+        return "";
+    }
+    
+    // 拥有内存的字符串总是在data[byte_length]处以null结尾
+    if (!str->is_view) {
+        return (const char*)str->data;
+    }
+    
+    // 视图不保证以null结尾
+    if (str->byte_length > 0 && str->data[str->byte_length - 1] != '\0') {
+        // 如果字符串不是以null结尾的，则创建一个新的
+        bs_string* new_str = bs_string_alloc(str->byte_length + 1, str->encoding);
+        if (!new_str) {
+            return "";
+        }
+        
+        memcpy(new_str->data, str->data, str->byte_length);
+        new_str->data[str->byte_length] = '\0';
+        
+        // 这里简化了实现，实际上应该缓存结果
+        return (const char*)new_str->data;
+    }
+    
+    return (const char*)str->data;
+}
+
+// 字符串操作实现
+
+bs_string* bs_string_substring(const bs_string* str, size_t start, size_t length) {
+    if (!str || start >= bs_char_length(str)) {
+        return bs_string_new("");
+    }
+    
+    // 找到起始位置的字节偏移
+    size_t start_byte = 0;
+    size_t char_count = 0;
+    const uint8_t* data = str->data;
+    
+    while (char_count < start && start_byte < str->byte_length) {
+        start_byte += utf8_char_size(data + start_byte);
+        char_count++;
+    }
+    
+    // 如果length超出了可能的范围，就调整它
+    if (start + length > bs_char_length(str)) {
+        length = bs_char_length(str) - start;
+    }
+    
+    // 找到结束位置的字节偏移
+    size_t end_byte = start_byte;
+    char_count = 0;
+    
+    while (char_count < length && end_byte < str->byte_length) {
+        end_byte += utf8_char_size(data + end_byte);
+        char_count++;
+    }
+    
+    // 创建子字符串
+    return bs_string_new_len((const char*)(data + start_byte), end_byte - start_byte);
+}
+
+bs_string* bs_string_concat(const bs_string* str1, const bs_string* str2) {
+    if (!str1) {
+        return str2 ? bs_string_copy(str2) : bs_string_new("");
+    }
+    if (!str2) {
+        return bs_string_copy(str1);
+    }
+    
+    // 分配足够大的空间来存储两个字符串
+    bs_string* result = bs_string_alloc(str1->byte_length + str2->byte_length, BS_ENCODING_UTF8);
+    if (!result) {
+        return NULL;
+    }
+    
+    // 复制两个字符串的内容
+    memcpy(result->data, str1->data, str1->byte_length);
+    memcpy(result->data + str1->byte_length, str2->data, str2->byte_length);
+    
+    result->byte_length = str1->byte_length + str2->byte_length;
+    result->length = bs_char_length(str1) + bs_char_length(str2);
+    
+    return result;
+}
+
+bs_string* bs_string_append(bs_string* str, const bs_string* append) {
+    if (!str) {
+        return append ? bs_string_copy(append) : NULL;
+    }
+    if (!append || append->byte_length == 0) {
+        return str;
+    }
+    
+    // 创建一个新的字符串来存储结果
+    bs_string* result = bs_string_concat(str, append);
+    
+    // 释放原始字符串
+    bs_string_free(str);
+    
+    return result;
+}
+
+bs_string* bs_string_append_cstr(bs_string* str, const char* append) {
+    if (!append) {
+        return str;
+    }
+    
+    // 创建临时字符串
+    bs_string* append_str = bs_string_new(append);
+    if (!append_str) {
+        return str;
+    }
+    
+    // 追加并释放临时字符串
+    bs_string* result = bs_string_append(str, append_str);
+    bs_string_free(append_str);
+    
+    return result;
+}
+
+// 基本的查找操作
+bool bs_string_contains_cstr(const bs_string* str, const char* find) {
+    if (!str || !find) {
+        return false;
+    }
+    
+    bs_string* find_str = bs_string_new(find);
+    if (!find_str) {
+        return false;
+    }
+    
+    bool result = bs_string_contains(str, find_str);
+    bs_string_free(find_str);
+    
+    return result;
+}
+
+bool bs_string_contains(const bs_string* str, const bs_string* find) {
+    if (!str || !find) {
+        return false;
+    }
+    
+    return bs_string_find(str, find, 0) >= 0;
+}
+
+int64_t bs_string_find_cstr(const bs_string* str, const char* find, size_t start_pos) {
+    if (!str || !find) {
+        return -1;
+    }
+    
+    bs_string* find_str = bs_string_new(find);
+    if (!find_str) {
+        return -1;
+    }
+    
+    int64_t result = bs_string_find(str, find_str, start_pos);
+    bs_string_free(find_str);
+    
+    return result;
+}
+
+int64_t bs_string_find(const bs_string* str, const bs_string* find, size_t start_pos) {
+    if (!str || !find || start_pos >= bs_char_length(str) || find->length == 0) {
+        return -1;
+    }
+    
+    // 简单的Naive字符串匹配算法
+    // 在实际实现中，应该使用更高效的算法如KMP或Boyer-Moore
+    
+    // 找到起始位置的字节偏移
+    size_t start_byte = 0;
+    size_t char_count = 0;
+    
+    while (char_count < start_pos && start_byte < str->byte_length) {
+        start_byte += utf8_char_size(str->data + start_byte);
+        char_count++;
+    }
+    
+    // 查找子字符串
+    for (size_t i = start_byte; i <= str->byte_length - find->byte_length; i++) {
+        if (memcmp(str->data + i, find->data, find->byte_length) == 0) {
+            // 找到匹配，计算字符位置
+            size_t pos = 0;
+            for (size_t j = 0; j < i; j += utf8_char_size(str->data + j)) {
+                pos++;
+            }
+            return pos;
+        }
+    }
+    
+    return -1;
+}
+
+// 其他函数的实现会根据需要添加
+
+/**
+ * 计算字符串中单词的数量
+ * 单词由空格、制表符或换行符分隔
+ */
+size_t bs_string_word_count(const bs_string* str) {
+    if (!str || !str->data || str->byte_length == 0) {
+        return 0;
+    }
+    
+    const char* cstr = (const char*)str->data;
+    size_t count = 0;
+    bool in_word = false;
+    
+    for (size_t i = 0; i < str->byte_length; i++) {
+        // 判断当前字符是否为空白字符
+        bool is_space = isspace(cstr[i]);
+        
+        // 当从空白字符进入非空白字符时，单词计数增加
+        if (!is_space && !in_word) {
+            count++;
+        }
+        
+        // 更新状态
+        in_word = !is_space;
+    }
+    
+    return count;
+}
+
+/**
+ * 将字符串首字母大写（每个单词的首字母变为大写，其余为小写）
+ */
+bs_string* bs_string_capitalize(const bs_string* str) {
+    if (!str) {
+        return NULL;
+    }
+    
+    // 先创建一个字符串的副本
+    bs_string* result = bs_string_copy(str);
+    if (!result) {
+        return NULL;
+    }
+    
+    bool capitalize_next = true;
+    uint8_t* data = result->data;
+    
+    for (size_t i = 0; i < result->byte_length;) {
+        // 只处理ASCII字符，保留非ASCII字符不变
+        if ((data[i] & 0x80) == 0) {
+            if (isalpha(data[i])) {
+                if (capitalize_next) {
+                    data[i] = toupper(data[i]);
+                    capitalize_next = false;
+                } else {
+                    data[i] = tolower(data[i]);
+                }
+            } else if (isspace(data[i]) || ispunct(data[i])) {
+                capitalize_next = true;
+            }
+            i++;
+        } else {
+            // 跳过非ASCII字符
+            i += utf8_char_size(data + i);
+            capitalize_next = false;
+        }
+    }
+    
+    return result;
+}
+
+/**
+ * 反转字符串内容
+ * 注意：这个函数需要正确处理UTF-8编码
+ */
+bs_string* bs_string_reverse(const bs_string* str) {
+    if (!str) {
+        return NULL;
+    }
+    
+    // 特殊情况：空字符串或者只有一个字符
+    if (str->byte_length <= 1) {
+        return bs_string_copy(str);
+    }
+    
+    // 创建一个新的字符串
+    bs_string* result = bs_string_alloc(str->byte_length, str->encoding);
+    if (!result) {
+        return NULL;
+    }
+    
+    if (str->encoding == BS_ENCODING_UTF8) {
+        // UTF-8编码需要特殊处理，按字符反转而不是按字节
+        size_t pos = 0;
+        size_t char_count = bs_char_length(str);
+        
+        // 创建一个数组来存储每个字符的字节偏移量
+        size_t* char_offsets = (size_t*)malloc((char_count + 1) * sizeof(size_t));
+        if (!char_offsets) {
+            bs_string_free(result);
+            return NULL;
+        }
+        
+        // 计算每个字符的字节偏移量
+        char_offsets[0] = 0;
+        size_t char_index = 1;
+        for (size_t i = 0; i < str->byte_length && char_index <= char_count;) {
+            size_t char_size = utf8_char_size(str->data + i);
+            i += char_size;
+            char_offsets[char_index] = i;
+            char_index++;
+        }
+        
+        // 反向复制每个字符
+        for (size_t i = char_count; i > 0; i--) {
+            size_t char_start = char_offsets[i - 1];
+            size_t char_size = (i < char_count) ? (char_offsets[i] - char_offsets[i - 1]) : (str->byte_length - char_offsets[i - 1]);
+            
+            memcpy(result->data + pos, str->data + char_start, char_size);
+            pos += char_size;
+        }
+        
+        free(char_offsets);
+    } else {
+        // 对于ASCII或其他单字节编码，可以简单地按字节反向复制
+        for (size_t i = 0; i < str->byte_length; i++) {
+            result->data[i] = str->data[str->byte_length - 1 - i];
+        }
+    }
+    
+    result->length = bs_char_length(str);
+    result->byte_length = str->byte_length;
+    result->data[result->byte_length] = '\0';
+    
+    return result;
+}
+
+// 子串扫描
+// 在data[0, length)中查找needle，返回字节偏移，未找到时返回length
+// 多字节needle同时比较首尾字节筛选候选位置，再用memcmp确认
+static size_t bs_find_bytes(const uint8_t* data, size_t length, const uint8_t* needle, size_t needle_length) {
+    if (needle_length == 0) {
+        return 0;
+    }
+    if (needle_length > length) {
+        return length;
+    }
+    if (needle_length == 1) {
+        // 单字节直接使用memchr，标准库已针对各平台向量化
+        const uint8_t* found = (const uint8_t*)memchr(data, needle[0], length);
+        return found ? (size_t)(found - data) : length;
+    }
+    
+    size_t last = needle_length - 1;
+    size_t limit = length - needle_length; // 最后一个可能的起始位置
+    size_t i = 0;
+    
+#ifdef BS_HAVE_SSE2
+    const __m128i first_byte = _mm_set1_epi8((char)needle[0]);
+    const __m128i last_byte = _mm_set1_epi8((char)needle[last]);
+    for (; i + 15 <= limit; i += 16) {
+        __m128i block_first = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i block_last = _mm_loadu_si128((const __m128i*)(data + i + last));
+        __m128i candidates = _mm_and_si128(_mm_cmpeq_epi8(block_first, first_byte),
+                                           _mm_cmpeq_epi8(block_last, last_byte));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(candidates);
+        while (mask) {
+            size_t pos = i + bs_ctz32(mask);
+            if (memcmp(data + pos + 1, needle + 1, needle_length - 2) == 0) {
+                return pos;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    
+    for (; i <= limit; i++) {
+        if (data[i] == needle[0] && data[i + last] == needle[last] &&
+            memcmp(data + i + 1, needle + 1, needle_length - 2) == 0) {
+            return i;
+        }
+    }
+    
+    return length;
+}
+
+// 惰性分割迭代器实现
+void bs_split_iter_init(bs_split_iter* it, const bs_string* str, const char* delimiter,
+                        size_t max_splits, unsigned flags) {
+    if (!it) {
+        return;
+    }
+    
+    it->data = str ? str->data : (const uint8_t*)"";
+    it->byte_length = str ? str->byte_length : 0;
+    it->position = 0;
+    it->delimiter = (const uint8_t*)(delimiter ? delimiter : "");
+    it->delimiter_length = delimiter ? strlen(delimiter) : 0;
+    it->max_splits = max_splits;
+    it->splits = 0;
+    it->flags = flags;
+    it->finished = false;
+}
+
+bool bs_split_iter_next(bs_split_iter* it, bs_string* field) {
+    if (!it || !field) {
+        return false;
+    }
+    
+    while (!it->finished) {
+        size_t start = it->position;
+        size_t end = it->byte_length;
+        
+        bool limit_reached = it->max_splits > 0 && it->splits >= it->max_splits;
+        if (it->delimiter_length > 0 && !limit_reached) {
+            end = start + bs_find_bytes(it->data + start, it->byte_length - start,
+                                        it->delimiter, it->delimiter_length);
+        }
+        
+        if (end >= it->byte_length) {
+            // 没有更多分隔符，剩余部分是最后一个字段
+            end = it->byte_length;
+            it->finished = true;
+        } else {
+            it->position = end + it->delimiter_length;
+        }
+        
+        if (end == start && (it->flags & BS_SPLIT_SKIP_EMPTY)) {
+            continue;
+        }
+        
+        if (!it->finished) {
+            it->splits++;
+        }
+        *field = bs_string_view_len((const char*)(it->data + start), end - start);
+        return true;
+    }
+    
+    return false;
+}
+
+// 分割和连接
+bs_string_array* bs_string_split(const bs_string* str, const char* delimiter) {
+    if (!str || !delimiter) {
+        return NULL;
+    }
+    
+    bs_string_array* result = (bs_string_array*)malloc(sizeof(bs_string_array));
+    if (!result) {
+        return NULL;
+    }
+    
+    // 第一遍只统计字段数量，以便一次分配指针数组
+    bs_split_iter it;
+    bs_string field;
+    size_t count = 0;
+    bs_split_iter_init(&it, str, delimiter, 0, 0);
+    while (bs_split_iter_next(&it, &field)) {
+        count++;
+    }
+    
+    result->length = 0;
+    result->items = (bs_string**)malloc((count ? count : 1) * sizeof(bs_string*));
+    if (!result->items) {
+        free(result);
+        return NULL;
+    }
+    
+    bs_split_iter_init(&it, str, delimiter, 0, 0);
+    while (bs_split_iter_next(&it, &field)) {
+        bs_string* item = bs_string_new_len((const char*)field.data, field.byte_length);
+        if (!item) {
+            bs_string_array_free(result);
+            return NULL;
+        }
+        result->items[result->length++] = item;
+    }
+    
+    return result;
+}
+
+void bs_string_array_free(bs_string_array* array) {
+    if (!array) {
+        return;
+    }
+    
+    if (array->items) {
+        for (size_t i = 0; i < array->length; i++) {
+            // C++包装可能已经取走了元素并置为NULL
+            bs_string_free(array->items[i]);
+        }
+        free(array->items);
+    }
+    free(array);
+}
+
+// 紧凑字符串数组实现
+// 头部、偏移数组和数据缓冲区放在同一块内存中
+static bs_compact_array* bs_compact_array_alloc(size_t count, size_t data_bytes) {
+    size_t header = sizeof(bs_compact_array);
+    size_t offsets_bytes = (count + 1) * sizeof(size_t);
+    
+    bs_compact_array* array = (bs_compact_array*)malloc(header + offsets_bytes + data_bytes + 1);
+    if (!array) {
+        return NULL;
+    }
+    
+    array->offsets = (size_t*)((uint8_t*)array + header);
+    array->data = (uint8_t*)array->offsets + offsets_bytes;
+    array->data[data_bytes] = '\0';
+    array->offsets[0] = 0;
+    array->length = count;
+    
+    return array;
+}
+
+bs_compact_array* bs_string_split_compact(const bs_string* str, const char* delimiter,
+                                          size_t max_splits, unsigned flags) {
+    if (!str || !delimiter) {
+        return NULL;
+    }
+    
+    // 第一遍统计字段数和总字节数，第二遍直接写入最终缓冲区
+    bs_split_iter it;
+    bs_string field;
+    size_t count = 0;
+    size_t total = 0;
+    bs_split_iter_init(&it, str, delimiter, max_splits, flags);
+    while (bs_split_iter_next(&it, &field)) {
+        count++;
+        total += field.byte_length;
+    }
+    
+    bs_compact_array* result = bs_compact_array_alloc(count, total);
+    if (!result) {
+        return NULL;
+    }
+    
+    size_t index = 0;
+    size_t offset = 0;
+    bs_split_iter_init(&it, str, delimiter, max_splits, flags);
+    while (bs_split_iter_next(&it, &field)) {
+        memcpy(result->data + offset, field.data, field.byte_length);
+        offset += field.byte_length;
+        result->offsets[++index] = offset;
+    }
+    
+    return result;
+}
+
+bs_compact_array* bs_string_regex_find_all_compact(const bs_string* str, const char* pattern) {
     if (!str || !pattern) {
+        return NULL;
+    }
+    
+    // 与bs_string_regex_find_all相同，模式按字面子串处理，匹配可以重叠
+    const uint8_t* needle = (const uint8_t*)pattern;
+    size_t needle_length = strlen(pattern);
+    if (needle_length == 0) {
+        return bs_compact_array_alloc(0, 0);
+    }
+    
+    size_t count = 0;
+    size_t pos = 0;
+    while (pos < str->byte_length) {
+        size_t found = pos + bs_find_bytes(str->data + pos, str->byte_length - pos, needle, needle_length);
+        if (found >= str->byte_length) {
+            break;
+        }
+        count++;
+        pos = found + utf8_char_size(str->data + found);
+    }
+    
+    // 所有匹配内容都等于模式本身
+    bs_compact_array* result = bs_compact_array_alloc(count, count * needle_length);
+    if (!result) {
+        return NULL;
+    }
+    
+    for (size_t i = 0; i < count; i++) {
+        memcpy(result->data + i * needle_length, needle, needle_length);
+        result->offsets[i + 1] = (i + 1) * needle_length;
+    }
+    
+    return result;
+}
+
+bs_compact_array* bs_compact_array_from_array(const bs_string_array* array) {
+    if (!array) {
+        return NULL;
+    }
+    
+    size_t total = 0;
+    for (size_t i = 0; i < array->length; i++) {
+        total += bs_string_byte_length(array->items[i]);
+    }
+    
+    bs_compact_array* result = bs_compact_array_alloc(array->length, total);
+    if (!result) {
+        return NULL;
+    }
+    
+    size_t offset = 0;
+    for (size_t i = 0; i < array->length; i++) {
+        const bs_string* item = array->items[i];
+        if (item && item->byte_length > 0) {
+            memcpy(result->data + offset, item->data, item->byte_length);
+            offset += item->byte_length;
+        }
+        result->offsets[i + 1] = offset;
+    }
+    
+    return result;
+}
+
+bs_string bs_compact_array_get(const bs_compact_array* array, size_t index) {
+    if (!array || index >= array->length) {
+        return bs_string_view_len("", 0);
+    }
+    
+    size_t start = array->offsets[index];
+    return bs_string_view_len((const char*)(array->data + start), array->offsets[index + 1] - start);
+}
+
+bs_string* bs_string_join_compact(const bs_compact_array* array, const char* delimiter) {
+    if (!array || array->length == 0) {
+        return bs_string_new("");
+    }
+    
+    size_t delimiter_length = delimiter ? strlen(delimiter) : 0;
+    size_t data_bytes = array->offsets[array->length];
+    
+    bs_string* result = bs_string_alloc(data_bytes + delimiter_length * (array->length - 1), BS_ENCODING_UTF8);
+    if (!result) {
+        return NULL;
+    }
+    
+    if (delimiter_length == 0) {
+        // 没有分隔符时数据缓冲区本身就是结果
+        memcpy(result->data, array->data, data_bytes);
+    } else {
+        uint8_t* out = result->data;
+        for (size_t i = 0; i < array->length; i++) {
+            size_t field_length = array->offsets[i + 1] - array->offsets[i];
+            if (i > 0) {
+                memcpy(out, delimiter, delimiter_length);
+                out += delimiter_length;
+            }
+            memcpy(out, array->data + array->offsets[i], field_length);
+            out += field_length;
+        }
+    }
+    
+    result->length = utf8_strlen((const char*)result->data, result->byte_length);
+    return result;
+}
+
+void bs_compact_array_free(bs_compact_array* array) {
+    // 头部、偏移和数据在同一块内存中
+    free(array);
+}
+
+// 连接实现：第一遍统计总长度，一次分配，第二遍memcpy
+bs_string* bs_string_join(const bs_string_array* array, const char* delimiter) {
+    if (!array || array->length == 0) {
+        return bs_string_new("");
+    }
+    
+    size_t delimiter_bytes = delimiter ? strlen(delimiter) : 0;
+    size_t delimiter_chars = utf8_strlen(delimiter, delimiter_bytes);
+    size_t total_bytes = delimiter_bytes * (array->length - 1);
+    size_t total_chars = delimiter_chars * (array->length - 1);
+    
+    for (size_t i = 0; i < array->length; i++) {
+        total_bytes += bs_string_byte_length(array->items[i]);
+        total_chars += bs_string_length(array->items[i]);
+    }
+    
+    bs_string* result = bs_string_alloc(total_bytes, BS_ENCODING_UTF8);
+    if (!result) {
+        return NULL;
+    }
+    
+    uint8_t* out = result->data;
+    for (size_t i = 0; i < array->length; i++) {
+        const bs_string* item = array->items[i];
+        if (i > 0 && delimiter_bytes > 0) {
+            memcpy(out, delimiter, delimiter_bytes);
+            out += delimiter_bytes;
+        }
+        if (item && item->byte_length > 0) {
+            memcpy(out, item->data, item->byte_length);
+            out += item->byte_length;
+        }
+    }
+    
+    result->length = total_chars;
+    return result;
+}
+
+bs_string* bs_string_join_views(const bs_string* items, size_t count, const char* delimiter) {
+    if (!items || count == 0) {
+        return bs_string_new("");
+    }
+    
+    size_t delimiter_bytes = delimiter ? strlen(delimiter) : 0;
+    size_t delimiter_chars = utf8_strlen(delimiter, delimiter_bytes);
+    size_t total_bytes = delimiter_bytes * (count - 1);
+    size_t total_chars = delimiter_chars * (count - 1);
+    
+    for (size_t i = 0; i < count; i++) {
+        total_bytes += items[i].byte_length;
+        total_chars += bs_char_length(&items[i]);
+    }
+    
+    bs_string* result = bs_string_alloc(total_bytes, BS_ENCODING_UTF8);
+    if (!result) {
+        return NULL;
+    }
+    
+    uint8_t* out = result->data;
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0 && delimiter_bytes > 0) {
+            memcpy(out, delimiter, delimiter_bytes);
+            out += delimiter_bytes;
+        }
+        if (items[i].byte_length > 0) {
+            memcpy(out, items[i].data, items[i].byte_length);
+            out += items[i].byte_length;
+        }
+    }
+    
+    result->length = total_chars;
+    return result;
+}
+
+// CSV读取器实现
+
+// 块扫描器：逐块生成不在引号内的分隔符和换行符位置
+typedef struct bs_csv_scanner {
+    const uint8_t* data;     // 被扫描的数据
+    size_t length;           // 数据字节长度
+    size_t block_base;       // 当前块的起始位置
+    size_t next_block;       // 下一块的起始位置
+    uint64_t structurals;    // 当前块中尚未取出的结构字符位掩码
+    bool in_quote;           // 已扫描部分末尾是否处于引号内
+} bs_csv_scanner;
+
+struct bs_csv_reader {
+    bs_csv_dialect dialect;
+    const uint8_t* chunk;    // 当前输入块
+    size_t chunk_length;
+    size_t position;         // 当前块中下一条记录的起始位置
+    bool last;               // 当前块是否为最后一块
+    bs_csv_scanner scanner;  // 当前块的扫描器
+    uint8_t* carry;          // 跨块的行
+    size_t carry_length;
+    size_t carry_capacity;
+    bool carry_in_quote;     // 跨块行末尾是否处于引号内
+    bool carry_ready;        // 跨块行已经完整，等待解析
+    bool carry_consumed;     // 跨块行已解析，下次调用时清空
+    bs_csv_field* fields;    // 输出字段缓冲区
+    size_t field_capacity;
+    bool error;              // 内存不足，之后不再产出记录
+};
+
+// 前缀异或：第i位为x第0..i位的异或，把引号位置转换为引号内区域
+static inline uint64_t bs_prefix_xor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+// 计算64字节块中等于ch的字节的位掩码
+static inline uint64_t bs_csv_byte_mask(const uint8_t* block, uint8_t ch) {
+#ifdef BS_HAVE_SSE2
+    const __m128i target = _mm_set1_epi8((char)ch);
+    uint64_t mask = 0;
+    for (int i = 0; i < 4; i++) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(block + i * 16));
+        mask |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, target)) << (i * 16);
+    }
+    return mask;
+#else
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; i++) {
+        mask |= (uint64_t)(block[i] == ch) << i;
+    }
+    return mask;
+#endif
+}
+
+static void bs_csv_scanner_init(bs_csv_scanner* scanner, const uint8_t* data, size_t length, bool in_quote) {
+    scanner->data = data;
+    scanner->length = length;
+    scanner->block_base = 0;
+    scanner->next_block = 0;
+    scanner->structurals = 0;
+    scanner->in_quote = in_quote;
+}
+
+// 处理下一块，返回false表示已没有数据
+static bool bs_csv_scanner_load(bs_csv_scanner* scanner, const bs_csv_dialect* dialect) {
+    size_t base = scanner->next_block;
+    if (base >= scanner->length) {
+        return false;
+    }
+    scanner->block_base = base;
+    scanner->next_block = base + 64;
+    
+    size_t valid = scanner->length - base;
+    const uint8_t* block = scanner->data + base;
+    uint8_t padded[64];
+    if (valid < 64) {
+        // 不足一块时补零，补齐部分在下面的掩码中去掉
+        memset(padded, 0, sizeof(padded));
+        memcpy(padded, block, valid);
+        block = padded;
+    }
+    uint64_t valid_mask = valid < 64 ? (((uint64_t)1 << valid) - 1) : ~(uint64_t)0;
+    
+    uint64_t quoted = 0;
+    if (dialect->quote) {
+        uint64_t quotes = bs_csv_byte_mask(block, (uint8_t)dialect->quote) & valid_mask;
+        quoted = bs_prefix_xor(quotes) ^ (scanner->in_quote ? ~(uint64_t)0 : 0);
+        scanner->in_quote = ((quoted >> (valid < 64 ? valid - 1 : 63)) & 1) != 0;
+    }
+    
+    uint64_t separators = bs_csv_byte_mask(block, (uint8_t)dialect->delimiter) |
+                          bs_csv_byte_mask(block, '\n');
+    scanner->structurals = separators & ~quoted & valid_mask;
+    return true;
+}
+
+// 返回下一个结构字符的位置，没有时返回length
+static size_t bs_csv_scanner_next(bs_csv_scanner* scanner, const bs_csv_dialect* dialect) {
+    while (scanner->structurals == 0) {
+        if (!bs_csv_scanner_load(scanner, dialect)) {
+            return scanner->length;
+        }
+    }
+    uint64_t bits = scanner->structurals;
+    scanner->structurals = bits & (bits - 1);
+    return scanner->block_base + bs_ctz64(bits);
+}
+
+static bool bs_csv_push_field(bs_csv_reader* reader, size_t index, const uint8_t* start, const uint8_t* end) {
+    if (index >= reader->field_capacity) {
+        size_t capacity = reader->field_capacity ? reader->field_capacity * 2 : 16;
+        bs_csv_field* fields = (bs_csv_field*)realloc(reader->fields, capacity * sizeof(bs_csv_field));
+        if (!fields) {
+            return false;
+        }
+        reader->fields = fields;
+        reader->field_capacity = capacity;
+    }
+    
+    bs_csv_field* field = &reader->fields[index];
+    field->quoted = false;
+    field->needs_unescape = false;
+    
+    char quote = reader->dialect.quote;
+    if (quote && end > start && *start == (uint8_t)quote) {
+        // 去掉外层引号：开头的引号和最后一个引号
+        const uint8_t* close = end;
+        while (close > start + 1 && close[-1] != (uint8_t)quote) {
+            close--;
+        }
+        start++;
+        end = close > start ? close - 1 : start;
+        field->quoted = true;
+        field->needs_unescape = memchr(start, quote, (size_t)(end - start)) != NULL;
+    }
+    
+    field->value = bs_string_view_len((const char*)start, (size_t)(end - start));
+    return true;
+}
+
+// 从data[pos]开始解析一条记录
+// 找到结束的换行符时返回true并设置*next；is_final为true时数据末尾也视为记录结束
+// 字段缓冲区扩容失败时设置reader->error并返回false
+static bool bs_csv_parse_record(bs_csv_reader* reader, bs_csv_scanner* scanner, size_t pos,
+                                bool is_final, size_t* count, size_t* next) {
+    const uint8_t* data = scanner->data;
+    size_t length = scanner->length;
+    size_t field_start = pos;
+    size_t index = 0;
+    
+    for (;;) {
+        size_t sep = bs_csv_scanner_next(scanner, &reader->dialect);
+        if (sep >= length) {
+            if (!is_final) {
+                return false;
+            }
+            if (!bs_csv_push_field(reader, index++, data + field_start, data + length)) {
+                reader->error = true;
+                return false;
+            }
+            *count = index;
+            *next = length;
+            return true;
+        }
+        
+        if (data[sep] == '\n') {
+            size_t field_end = sep;
+            if (field_end > field_start && data[field_end - 1] == '\r') {
+                field_end--;
+            }
+            if (!bs_csv_push_field(reader, index++, data + field_start, data + field_end)) {
+                reader->error = true;
+                return false;
+            }
+            *count = index;
+            *next = sep + 1;
+            return true;
+        }
+        
+        if (!bs_csv_push_field(reader, index++, data + field_start, data + sep)) {
+            reader->error = true;
+            return false;
+        }
+        field_start = sep + 1;
+    }
+}
+
+static bool bs_csv_carry_append(bs_csv_reader* reader, const uint8_t* data, size_t length) {
+    if (reader->carry_length + length > reader->carry_capacity) {
+        size_t capacity = reader->carry_capacity ? reader->carry_capacity : 256;
+        while (capacity < reader->carry_length + length) {
+            capacity *= 2;
+        }
+        uint8_t* carry = (uint8_t*)realloc(reader->carry, capacity);
+        if (!carry) {
+            return false;
+        }
+        reader->carry = carry;
+        reader->carry_capacity = capacity;
+    }
+    memcpy(reader->carry + reader->carry_length, data, length);
+    reader->carry_length += length;
+    return true;
+}
+
+bs_csv_reader* bs_csv_reader_new(const bs_csv_dialect* dialect) {
+    bs_csv_reader* reader = (bs_csv_reader*)calloc(1, sizeof(bs_csv_reader));
+    if (!reader) {
+        return NULL;
+    }
+    
+    reader->dialect.delimiter = dialect ? dialect->delimiter : ',';
+    reader->dialect.quote = dialect ? dialect->quote : '"';
+    reader->chunk = (const uint8_t*)"";
+    return reader;
+}
+
+void bs_csv_reader_feed(bs_csv_reader* reader, const char* data, size_t length, bool last) {
+    if (!reader || reader->error) {
+        return;
+    }
+    if (!data) {
+        data = "";
+        length = 0;
+    }
+    
+    if (reader->carry_consumed) {
+        reader->carry_length = 0;
+        reader->carry_consumed = false;
+    }
+    
+    reader->chunk = (const uint8_t*)data;
+    reader->chunk_length = length;
+    reader->position = 0;
+    reader->last = last;
+    bs_csv_scanner_init(&reader->scanner, reader->chunk, length,
+                        reader->carry_length > 0 && reader->carry_in_quote);
+    
+    if (reader->carry_length == 0) {
+        return;
+    }
+    
+    // 上一块留下了半行：在新块中找到它结束的换行符，只复制这一段
+    size_t sep;
+    do {
+        sep = bs_csv_scanner_next(&reader->scanner, &reader->dialect);
+    } while (sep < length && reader->chunk[sep] != '\n');
+    
+    if (sep < length) {
+        reader->error = !bs_csv_carry_append(reader, reader->chunk, sep + 1);
+        reader->position = sep + 1;
+        reader->carry_ready = true;
+    } else {
+        reader->error = !bs_csv_carry_append(reader, reader->chunk, length);
+        reader->position = length;
+        reader->carry_in_quote = reader->scanner.in_quote;
+        reader->carry_ready = last;
+    }
+}
+
+bool bs_csv_reader_next(bs_csv_reader* reader, bs_csv_record* record) {
+    if (!reader || !record || reader->error) {
+        return false;
+    }
+    
+    if (reader->carry_consumed) {
+        reader->carry_length = 0;
+        reader->carry_consumed = false;
+    }
+    
+    size_t count = 0;
+    size_t next = 0;
+    
+    if (reader->carry_ready) {
+        // 跨块的行已经完整，单独解析
+        bs_csv_scanner carry_scanner;
+        bs_csv_scanner_init(&carry_scanner, reader->carry, reader->carry_length, false);
+        bool parsed = bs_csv_parse_record(reader, &carry_scanner, 0, true, &count, &next);
+        reader->carry_ready = false;
+        reader->carry_consumed = true;
+        if (!parsed) {
+            return false;
+        }
+        record->fields = reader->fields;
+        record->count = count;
+        return true;
+    }
+    
+    if (reader->position >= reader->chunk_length) {
+        return false;
+    }
+    
+    size_t start = reader->position;
+    if (bs_csv_parse_record(reader, &reader->scanner, start, reader->last, &count, &next)) {
+        reader->position = next;
+        record->fields = reader->fields;
+        record->count = count;
+        return true;
+    }
+    if (reader->error) {
+        return false;
+    }
+    
+    // 这一行没有在当前块中结束，复制剩余部分等待下一块
+    reader->carry_length = 0;
+    reader->error = !bs_csv_carry_append(reader, reader->chunk + start, reader->chunk_length - start);
+    reader->carry_in_quote = reader->scanner.in_quote;
+    reader->position = reader->chunk_length;
+    return false;
+}
+
+bool bs_csv_reader_error(const bs_csv_reader* reader) {
+    return reader ? reader->error : false;
+}
+
+void bs_csv_reader_free(bs_csv_reader* reader) {
+    if (reader) {
+        free(reader->carry);
+        free(reader->fields);
+        free(reader);
+    }
+}
+
+bs_string* bs_csv_unescape(const bs_csv_field* field, char quote) {
+    if (!field) {
+        return NULL;
+    }
+    
+    const uint8_t* data = field->value.data;
+    size_t length = field->value.byte_length;
+    if (!field->needs_unescape || !quote) {
+        return bs_string_new_len((const char*)data, length);
+    }
+    
+    bs_string* result = bs_string_alloc(length, BS_ENCODING_UTF8);
+    if (!result) {
+        return NULL;
+    }
+    
+    // 成对的引号还原为一个
+    size_t out = 0;
+    for (size_t i = 0; i < length; i++) {
+        result->data[out++] = data[i];
+        if (data[i] == (uint8_t)quote && i + 1 < length && data[i + 1] == (uint8_t)quote) {
+            i++;
+        }
+    }
+    result->data[out] = '\0';
+    result->byte_length = out;
+    result->length = utf8_strlen((const char*)result->data, out);
+    return result;
+}
+
+// 整数格式化与解析实现
+
+// 两位数字表，每次除以100输出两位
+static const char bs_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static inline unsigned bs_count_digits(uint64_t value) {
+    unsigned digits = 1;
+    for (;;) {
+        if (value < 10) return digits;
+        if (value < 100) return digits + 1;
+        if (value < 1000) return digits + 2;
+        if (value < 10000) return digits + 3;
+        value /= 10000;
+        digits += 4;
+    }
+}
+
+// 从末尾向前写入digits位数字
+static inline void bs_write_digits(uint64_t value, char* buffer, unsigned digits) {
+    char* out = buffer + digits;
+    while (value >= 100) {
+        unsigned pair = (unsigned)(value % 100) * 2;
+        value /= 100;
+        out -= 2;
+        out[0] = bs_digit_pairs[pair];
+        out[1] = bs_digit_pairs[pair + 1];
+    }
+    if (value >= 10) {
+        unsigned pair = (unsigned)value * 2;
+        out -= 2;
+        out[0] = bs_digit_pairs[pair];
+        out[1] = bs_digit_pairs[pair + 1];
+    } else {
+        *--out = (char)('0' + value);
+    }
+}
+
+// 计算格式化后的字节数
+static inline size_t bs_int_chars(int64_t value) {
+    uint64_t magnitude = value < 0 ? (uint64_t)0 - (uint64_t)value : (uint64_t)value;
+    return bs_count_digits(magnitude) + (value < 0);
+}
+
+size_t bs_int_to_chars(int64_t value, char* buffer) {
+    if (!buffer) {
+        return 0;
+    }
+    
+    // 先转成无符号数再取反，INT64_MIN也不会溢出
+    uint64_t magnitude = (uint64_t)value;
+    size_t sign = 0;
+    if (value < 0) {
+        magnitude = (uint64_t)0 - magnitude;
+        buffer[0] = '-';
+        sign = 1;
+    }
+    
+    unsigned digits = bs_count_digits(magnitude);
+    bs_write_digits(magnitude, buffer + sign, digits);
+    return sign + digits;
+}
+
+bs_string* bs_string_from_int(int64_t value) {
+    // 先计算位数，直接写入最终的字符串缓冲区
+    bs_string* result = bs_string_alloc(bs_int_chars(value), BS_ENCODING_UTF8);
+    if (!result) {
+        return NULL;
+    }
+    
+    bs_int_to_chars(value, (char*)result->data);
+    result->length = result->byte_length; // 全部是ASCII
+    return result;
+}
+
+// 8位数字一次处理（SWAR）
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define BS_BIG_ENDIAN 1
+#endif
+
+// 判断8个字节是否都是'0'..'9'
+static inline bool bs_is_eight_digits(uint64_t chunk) {
+    return (((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+             (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+            0x3333333333333333ULL);
+}
+
+// 把8个ASCII数字（小端序加载）转换为整数
+static inline uint32_t bs_parse_eight_digits(uint64_t chunk) {
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 0x000F424000000064ULL; // 100 + (1000000 << 32)
+    const uint64_t mul2 = 0x0000271000000001ULL; // 1 + (10000 << 32)
+    chunk -= 0x3030303030303030ULL;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+    return (uint32_t)chunk;
+}
+
+bool bs_parse_int(const char* str, size_t length, int64_t* value) {
+    if (!str || length == 0) {
+        return false;
+    }
+    
+    const uint8_t* p = (const uint8_t*)str;
+    const uint8_t* end = p + length;
+    bool negative = false;
+    if (*p == '-' || *p == '+') {
+        negative = *p == '-';
+        p++;
+    }
+    if (p == end) {
+        return false;
+    }
+    
+    // 跳过前导零，剩余的有效数字不能超过19位
+    const uint8_t* digits_start = p;
+    while (p < end && *p == '0') {
+        p++;
+    }
+    const uint8_t* significant = p;
+    
+    uint64_t magnitude = 0;
+#ifndef BS_BIG_ENDIAN
+    while (end - p >= 8) {
+        uint64_t chunk = bs_load_u64(p);
+        if (!bs_is_eight_digits(chunk) || p - significant > 11) {
+            break;
+        }
+        magnitude = magnitude * 100000000ULL + bs_parse_eight_digits(chunk);
+        p += 8;
+    }
+#endif
+    while (p < end) {
+        uint8_t digit = (uint8_t)(*p - '0');
+        if (digit > 9) {
+            return false;
+        }
+        if (p - significant >= 19) {
+            return false; // 超过19位有效数字必然溢出
+        }
+        magnitude = magnitude * 10 + digit;
+        p++;
+    }
+    if (p == digits_start) {
+        return false;
+    }
+    
+    // 19位数字在uint64范围内，这里检查int64的范围
+    if (negative) {
+        if (magnitude > (uint64_t)INT64_MAX + 1) {
+            return false;
+        }
+        if (value) {
+            *value = magnitude == (uint64_t)INT64_MAX + 1 ? INT64_MIN : -(int64_t)magnitude;
+        }
+    } else {
+        if (magnitude > (uint64_t)INT64_MAX) {
+            return false;
+        }
+        if (value) {
+            *value = (int64_t)magnitude;
+        }
+    }
+    return true;
+}
+
+bool bs_string_try_parse_int(const bs_string* str, int64_t* value) {
+    if (!str) {
+        return false;
+    }
+    return bs_parse_int((const char*)str->data, str->byte_length, value);
+}
+
+int64_t bs_string_to_int(const bs_string* str) {
+    int64_t value = 0;
+    return bs_string_try_parse_int(str, &value) ? value : 0;
+}
+
+size_t bs_string_array_parse_int(const bs_string_array* array, int64_t* values, bool* ok) {
+    if (!array || !values) {
+        return 0;
+    }
+    
+    size_t parsed = 0;
+    for (size_t i = 0; i < array->length; i++) {
+        bool success = bs_string_try_parse_int(array->items[i], &values[i]);
+        if (!success) {
+            values[i] = 0;
+        }
+        if (ok) {
+            ok[i] = success;
+        }
+        parsed += success;
+    }
+    return parsed;
+}
+
+size_t bs_compact_array_parse_int(const bs_compact_array* array, int64_t* values, bool* ok) {
+    if (!array || !values) {
+        return 0;
+    }
+    
+    // 所有字段在同一缓冲区中，顺序访问
+    size_t parsed = 0;
+    for (size_t i = 0; i < array->length; i++) {
+        size_t start = array->offsets[i];
+        bool success = bs_parse_int((const char*)(array->data + start), array->offsets[i + 1] - start, &values[i]);
+        if (!success) {
+            values[i] = 0;
+        }
+        if (ok) {
+            ok[i] = success;
+        }
+        parsed += success;
+    }
+    return parsed;
+}
+
+bs_compact_array* bs_compact_array_from_ints(const int64_t* values, size_t count) {
+    if (!values && count > 0) {
+        return NULL;
+    }
+    
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += bs_int_chars(values[i]);
+    }
+    
+    bs_compact_array* result = bs_compact_array_alloc(count, total);
+    if (!result) {
+        return NULL;
+    }
+    
+    size_t offset = 0;
+    for (size_t i = 0; i < count; i++) {
+        offset += bs_int_to_chars(values[i], (char*)(result->data + offset));
+        result->offsets[i + 1] = offset;
+    }
+    
+    return result;
+}
+
+// 浮点数格式化与解析实现
+
+// 128位乘法
+typedef struct {
+    uint64_t hi;
+    uint64_t lo;
+} bs_u128;
+
+static inline bs_u128 bs_mul64(uint64_t a, uint64_t b) {
+    bs_u128 r;
+#if defined(__SIZEOF_INT128__)
+    __extension__ unsigned __int128 p = (unsigned __int128)a * b;
+    r.hi = (uint64_t)(p >> 64);
+    r.lo = (uint64_t)p;
+#elif defined(_MSC_VER) && defined(_M_X64)
+    r.lo = _umul128(a, b, &r.hi);
+#else
+    uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+    uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+    uint64_t lo_lo = a_lo * b_lo;
+    uint64_t hi_lo = a_hi * b_lo;
+    uint64_t lo_hi = a_lo * b_hi;
+    uint64_t hi_hi = a_hi * b_hi;
+    uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+    r.hi = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    r.lo = (cross << 32) | (uint32_t)lo_lo;
+#endif
+    return r;
+}
+
+static inline unsigned bs_clz64(uint64_t x) {
+    uint32_t high = (uint32_t)(x >> 32);
+    return high ? bs_clz32(high) : 32u + bs_clz32((uint32_t)x);
+}
+
+static inline uint64_t bs_double_to_bits(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static inline double bs_bits_to_double(uint64_t bits) {
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// 10^e（e在[-342, 326]内）规范化到最高位为1的128位截断值
+#define BS_POW10_MIN_EXP (-342)
+#define BS_POW10_MAX_EXP 326
+static const uint64_t bs_pow10_table[BS_POW10_MAX_EXP - BS_POW10_MIN_EXP + 1][2] = {
+    {0xEEF453D6923BD65AULL, 0x113FAA2906A13B3FULL}, {0x9558B4661B6565F8ULL, 0x4AC7CA59A424C507ULL},
+    {0xBAAEE17FA23EBF76ULL, 0x5D79BCF00D2DF649ULL}, {0xE95A99DF8ACE6F53ULL, 0xF4D82C2C107973DCULL},
+    {0x91D8A02BB6C10594ULL, 0x79071B9B8A4BE869ULL}, {0xB64EC836A47146F9ULL, 0x9748E2826CDEE284ULL},
+    {0xE3E27A444D8D98B7ULL, 0xFD1B1B2308169B25ULL}, {0x8E6D8C6AB0787F72ULL, 0xFE30F0F5E50E20F7ULL},
+    {0xB208EF855C969F4FULL, 0xBDBD2D335E51A935ULL}, {0xDE8B2B66B3BC4723ULL, 0xAD2C788035E61382ULL},
+    {0x8B16FB203055AC76ULL, 0x4C3BCB5021AFCC31ULL}, {0xADDCB9E83C6B1793ULL, 0xDF4ABE242A1BBF3DULL},
+    {0xD953E8624B85DD78ULL, 0xD71D6DAD34A2AF0DULL}, {0x87D4713D6F33AA6BULL, 0x8672648C40E5AD68ULL},
+    {0xA9C98D8CCB009506ULL, 0x680EFDAF511F18C2ULL}, {0xD43BF0EFFDC0BA48ULL, 0x0212BD1B2566DEF2ULL},
+    {0x84A57695FE98746DULL, 0x014BB630F7604B57ULL}, {0xA5CED43B7E3E9188ULL, 0x419EA3BD35385E2DULL},
+    {0xCF42894A5DCE35EAULL, 0x52064CAC828675B9ULL}, {0x818995CE7AA0E1B2ULL, 0x7343EFEBD1940993ULL},
+    {0xA1EBFB4219491A1FULL, 0x1014EBE6C5F90BF8ULL}, {0xCA66FA129F9B60A6ULL, 0xD41A26E077774EF6ULL},
+    {0xFD00B897478238D0ULL, 0x8920B098955522B4ULL}, {0x9E20735E8CB16382ULL, 0x55B46E5F5D5535B0ULL},
+    {0xC5A890362FDDBC62ULL, 0xEB2189F734AA831DULL}, {0xF712B443BBD52B7BULL, 0xA5E9EC7501D523E4ULL},
+    {0x9A6BB0AA55653B2DULL, 0x47B233C92125366EULL}, {0xC1069CD4EABE89F8ULL, 0x999EC0BB696E840AULL},
+    {0xF148440A256E2C76ULL, 0xC00670EA43CA250DULL}, {0x96CD2A865764DBCAULL, 0x380406926A5E5728ULL},
+    {0xBC807527ED3E12BCULL, 0xC605083704F5ECF2ULL}, {0xEBA09271E88D976BULL, 0xF7864A44C633682EULL},
+    {0x93445B8731587EA3ULL, 0x7AB3EE6AFBE0211DULL}, {0xB8157268FDAE9E4CULL, 0x5960EA05BAD82964ULL},
+    {0xE61ACF033D1A45DFULL, 0x6FB92487298E33BDULL}, {0x8FD0C16206306BABULL, 0xA5D3B6D479F8E056ULL},
+    {0xB3C4F1BA87BC8696ULL, 0x8F48A4899877186CULL}, {0xE0B62E2929ABA83CULL, 0x331ACDABFE94DE87ULL},
+    {0x8C71DCD9BA0B4925ULL, 0x9FF0C08B7F1D0B14ULL}, {0xAF8E5410288E1B6FULL, 0x07ECF0AE5EE44DD9ULL},
+    {0xDB71E91432B1A24AULL, 0xC9E82CD9F69D6150ULL}, {0x892731AC9FAF056EULL, 0xBE311C083A225CD2ULL},
+    {0xAB70FE17C79AC6CAULL, 0x6DBD630A48AAF406ULL}, {0xD64D3D9DB981787DULL, 0x092CBBCCDAD5B108ULL},
+    {0x85F0468293F0EB4EULL, 0x25BBF56008C58EA5ULL}, {0xA76C582338ED2621ULL, 0xAF2AF2B80AF6F24EULL},
+    {0xD1476E2C07286FAAULL, 0x1AF5AF660DB4AEE1ULL}, {0x82CCA4DB847945CAULL, 0x50D98D9FC890ED4DULL},
+    {0xA37FCE126597973CULL, 0xE50FF107BAB528A0ULL}, {0xCC5FC196FEFD7D0CULL, 0x1E53ED49A96272C8ULL},
+    {0xFF77B1FCBEBCDC4FULL, 0x25E8E89C13BB0F7AULL}, {0x9FAACF3DF73609B1ULL, 0x77B191618C54E9ACULL},
+    {0xC795830D75038C1DULL, 0xD59DF5B9EF6A2417ULL}, {0xF97AE3D0D2446F25ULL, 0x4B0573286B44AD1DULL},
+    {0x9BECCE62836AC577ULL, 0x4EE367F9430AEC32ULL}, {0xC2E801FB244576D5ULL, 0x229C41F793CDA73FULL},
+    {0xF3A20279ED56D48AULL, 0x6B43527578C1110FULL}, {0x9845418C345644D6ULL, 0x830A13896B78AAA9ULL},
+    {0xBE5691EF416BD60CULL, 0x23CC986BC656D553ULL}, {0xEDEC366B11C6CB8FULL, 0x2CBFBE86B7EC8AA8ULL},
+    {0x94B3A202EB1C3F39ULL, 0x7BF7D71432F3D6A9ULL}, {0xB9E08A83A5E34F07ULL, 0xDAF5CCD93FB0CC53ULL},
+    {0xE858AD248F5C22C9ULL, 0xD1B3400F8F9CFF68ULL}, {0x91376C36D99995BEULL, 0x23100809B9C21FA1ULL},
+    {0xB58547448FFFFB2DULL, 0xABD40A0C2832A78AULL}, {0xE2E69915B3FFF9F9ULL, 0x16C90C8F323F516CULL},
+    {0x8DD01FAD907FFC3BULL, 0xAE3DA7D97F6792E3ULL}, {0xB1442798F49FFB4AULL, 0x99CD11CFDF41779CULL},
+    {0xDD95317F31C7FA1DULL, 0x40405643D711D583ULL}, {0x8A7D3EEF7F1CFC52ULL, 0x482835EA666B2572ULL},
+    {0xAD1C8EAB5EE43B66ULL, 0xDA3243650005EECFULL}, {0xD863B256369D4A40ULL, 0x90BED43E40076A82ULL},
+    {0x873E4F75E2224E68ULL, 0x5A7744A6E804A291ULL}, {0xA90DE3535AAAE202ULL, 0x711515D0A205CB36ULL},
+    {0xD3515C2831559A83ULL, 0x0D5A5B44CA873E03ULL}, {0x8412D9991ED58091ULL, 0xE858790AFE9486C2ULL},
+    {0xA5178FFF668AE0B6ULL, 0x626E974DBE39A872ULL}, {0xCE5D73FF402D98E3ULL, 0xFB0A3D212DC8128FULL},
+    {0x80FA687F881C7F8EULL, 0x7CE66634BC9D0B99ULL}, {0xA139029F6A239F72ULL, 0x1C1FFFC1EBC44E80ULL},
+    {0xC987434744AC874EULL, 0xA327FFB266B56220ULL}, {0xFBE9141915D7A922ULL, 0x4BF1FF9F0062BAA8ULL},
+    {0x9D71AC8FADA6C9B5ULL, 0x6F773FC3603DB4A9ULL}, {0xC4CE17B399107C22ULL, 0xCB550FB4384D21D3ULL},
+    {0xF6019DA07F549B2BULL, 0x7E2A53A146606A48ULL}, {0x99C102844F94E0FBULL, 0x2EDA7444CBFC426DULL},
+    {0xC0314325637A1939ULL, 0xFA911155FEFB5308ULL}, {0xF03D93EEBC589F88ULL, 0x793555AB7EBA27CAULL},
+    {0x96267C7535B763B5ULL, 0x4BC1558B2F3458DEULL}, {0xBBB01B9283253CA2ULL, 0x9EB1AAEDFB016F16ULL},
+    {0xEA9C227723EE8BCBULL, 0x465E15A979C1CADCULL}, {0x92A1958A7675175FULL, 0x0BFACD89EC191EC9ULL},
+    {0xB749FAED14125D36ULL, 0xCEF980EC671F667BULL}, {0xE51C79A85916F484ULL, 0x82B7E12780E7401AULL},
+    {0x8F31CC0937AE58D2ULL, 0xD1B2ECB8B0908810ULL}, {0xB2FE3F0B8599EF07ULL, 0x861FA7E6DCB4AA15ULL},
+    {0xDFBDCECE67006AC9ULL, 0x67A791E093E1D49AULL}, {0x8BD6A141006042BDULL, 0xE0C8BB2C5C6D24E0ULL},
+    {0xAECC49914078536DULL, 0x58FAE9F773886E18ULL}, {0xDA7F5BF590966848ULL, 0xAF39A475506A899EULL},
+    {0x888F99797A5E012DULL, 0x6D8406C952429603ULL}, {0xAAB37FD7D8F58178ULL, 0xC8E5087BA6D33B83ULL},
+    {0xD5605FCDCF32E1D6ULL, 0xFB1E4A9A90880A64ULL}, {0x855C3BE0A17FCD26ULL, 0x5CF2EEA09A55067FULL},
+    {0xA6B34AD8C9DFC06FULL, 0xF42FAA48C0EA481EULL}, {0xD0601D8EFC57B08BULL, 0xF13B94DAF124DA26ULL},
+    {0x823C12795DB6CE57ULL, 0x76C53D08D6B70858ULL}, {0xA2CB1717B52481EDULL, 0x54768C4B0C64CA6EULL},
+    {0xCB7DDCDDA26DA268ULL, 0xA9942F5DCF7DFD09ULL}, {0xFE5D54150B090B02ULL, 0xD3F93B35435D7C4CULL},
+    {0x9EFA548D26E5A6E1ULL, 0xC47BC5014A1A6DAFULL}, {0xC6B8E9B0709F109AULL, 0x359AB6419CA1091BULL},
+    {0xF867241C8CC6D4C0ULL, 0xC30163D203C94B62ULL}, {0x9B407691D7FC44F8ULL, 0x79E0DE63425DCF1DULL},
+    {0xC21094364DFB5636ULL, 0x985915FC12F542E4ULL}, {0xF294B943E17A2BC4ULL, 0x3E6F5B7B17B2939DULL},
+    {0x979CF3CA6CEC5B5AULL, 0xA705992CEECF9C42ULL}, {0xBD8430BD08277231ULL, 0x50C6FF782A838353ULL},
+    {0xECE53CEC4A314EBDULL, 0xA4F8BF5635246428ULL}, {0x940F4613AE5ED136ULL, 0x871B7795E136BE99ULL},
+    {0xB913179899F68584ULL, 0x28E2557B59846E3FULL}, {0xE757DD7EC07426E5ULL, 0x331AEADA2FE589CFULL},
+    {0x9096EA6F3848984FULL, 0x3FF0D2C85DEF7621ULL}, {0xB4BCA50B065ABE63ULL, 0x0FED077A756B53A9ULL},
+    {0xE1EBCE4DC7F16DFBULL, 0xD3E8495912C62894ULL}, {0x8D3360F09CF6E4BDULL, 0x64712DD7ABBBD95CULL},
+    {0xB080392CC4349DECULL, 0xBD8D794D96AACFB3ULL}, {0xDCA04777F541C567ULL, 0xECF0D7A0FC5583A0ULL},
+    {0x89E42CAAF9491B60ULL, 0xF41686C49DB57244ULL}, {0xAC5D37D5B79B6239ULL, 0x311C2875C522CED5ULL},
+    {0xD77485CB25823AC7ULL, 0x7D633293366B828BULL}, {0x86A8D39EF77164BCULL, 0xAE5DFF9C02033197ULL},
+    {0xA8530886B54DBDEBULL, 0xD9F57F830283FDFCULL}, {0xD267CAA862A12D66ULL, 0xD072DF63C324FD7BULL},
+    {0x8380DEA93DA4BC60ULL, 0x4247CB9E59F71E6DULL}, {0xA46116538D0DEB78ULL, 0x52D9BE85F074E608ULL},
+    {0xCD795BE870516656ULL, 0x67902E276C921F8BULL}, {0x806BD9714632DFF6ULL, 0x00BA1CD8A3DB53B6ULL},
+    {0xA086CFCD97BF97F3ULL, 0x80E8A40ECCD228A4ULL}, {0xC8A883C0FDAF7DF0ULL, 0x6122CD128006B2CDULL},
+    {0xFAD2A4B13D1B5D6CULL, 0x796B805720085F81ULL}, {0x9CC3A6EEC6311A63ULL, 0xCBE3303674053BB0ULL},
+    {0xC3F490AA77BD60FCULL, 0xBEDBFC4411068A9CULL}, {0xF4F1B4D515ACB93BULL, 0xEE92FB5515482D44ULL},
+    {0x991711052D8BF3C5ULL, 0x751BDD152D4D1C4AULL}, {0xBF5CD54678EEF0B6ULL, 0xD262D45A78A0635DULL},
+    {0xEF340A98172AACE4ULL, 0x86FB897116C87C34ULL}, {0x9580869F0E7AAC0EULL, 0xD45D35E6AE3D4DA0ULL},
+    {0xBAE0A846D2195712ULL, 0x8974836059CCA109ULL}, {0xE998D258869FACD7ULL, 0x2BD1A438703FC94BULL},
+    {0x91FF83775423CC06ULL, 0x7B6306A34627DDCFULL}, {0xB67F6455292CBF08ULL, 0x1A3BC84C17B1D542ULL},
+    {0xE41F3D6A7377EECAULL, 0x20CABA5F1D9E4A93ULL}, {0x8E938662882AF53EULL, 0x547EB47B7282EE9CULL},
+    {0xB23867FB2A35B28DULL, 0xE99E619A4F23AA43ULL}, {0xDEC681F9F4C31F31ULL, 0x6405FA00E2EC94D4ULL},
+    {0x8B3C113C38F9F37EULL, 0xDE83BC408DD3DD04ULL}, {0xAE0B158B4738705EULL, 0x9624AB50B148D445ULL},
+    {0xD98DDAEE19068C76ULL, 0x3BADD624DD9B0957ULL}, {0x87F8A8D4CFA417C9ULL, 0xE54CA5D70A80E5D6ULL},
+    {0xA9F6D30A038D1DBCULL, 0x5E9FCF4CCD211F4CULL}, {0xD47487CC8470652BULL, 0x7647C3200069671FULL},
+    {0x84C8D4DFD2C63F3BULL, 0x29ECD9F40041E073ULL}, {0xA5FB0A17C777CF09ULL, 0xF468107100525890ULL},
+    {0xCF79CC9DB955C2CCULL, 0x7182148D4066EEB4ULL}, {0x81AC1FE293D599BFULL, 0xC6F14CD848405530ULL},
+    {0xA21727DB38CB002FULL, 0xB8ADA00E5A506A7CULL}, {0xCA9CF1D206FDC03BULL, 0xA6D90811F0E4851CULL},
+    {0xFD442E4688BD304AULL, 0x908F4A166D1DA663ULL}, {0x9E4A9CEC15763E2EULL, 0x9A598E4E043287FEULL},
+    {0xC5DD44271AD3CDBAULL, 0x40EFF1E1853F29FDULL}, {0xF7549530E188C128ULL, 0xD12BEE59E68EF47CULL},
+    {0x9A94DD3E8CF578B9ULL, 0x82BB74F8301958CEULL}, {0xC13A148E3032D6E7ULL, 0xE36A52363C1FAF01ULL},
+    {0xF18899B1BC3F8CA1ULL, 0xDC44E6C3CB279AC1ULL}, {0x96F5600F15A7B7E5ULL, 0x29AB103A5EF8C0B9ULL},
+    {0xBCB2B812DB11A5DEULL, 0x7415D448F6B6F0E7ULL}, {0xEBDF661791D60F56ULL, 0x111B495B3464AD21ULL},
+    {0x936B9FCEBB25C995ULL, 0xCAB10DD900BEEC34ULL}, {0xB84687C269EF3BFBULL, 0x3D5D514F40EEA742ULL},
+    {0xE65829B3046B0AFAULL, 0x0CB4A5A3112A5112ULL}, {0x8FF71A0FE2C2E6DCULL, 0x47F0E785EABA72ABULL},
+    {0xB3F4E093DB73A093ULL, 0x59ED216765690F56ULL}, {0xE0F218B8D25088B8ULL, 0x306869C13EC3532CULL},
+    {0x8C974F7383725573ULL, 0x1E414218C73A13FBULL}, {0xAFBD2350644EEACFULL, 0xE5D1929EF90898FAULL},
+    {0xDBAC6C247D62A583ULL, 0xDF45F746B74ABF39ULL}, {0x894BC396CE5DA772ULL, 0x6B8BBA8C328EB783ULL},
+    {0xAB9EB47C81F5114FULL, 0x066EA92F3F326564ULL}, {0xD686619BA27255A2ULL, 0xC80A537B0EFEFEBDULL},
+    {0x8613FD0145877585ULL, 0xBD06742CE95F5F36ULL}, {0xA798FC4196E952E7ULL, 0x2C48113823B73704ULL},
+    {0xD17F3B51FCA3A7A0ULL, 0xF75A15862CA504C5ULL}, {0x82EF85133DE648C4ULL, 0x9A984D73DBE722FBULL},
+    {0xA3AB66580D5FDAF5ULL, 0xC13E60D0D2E0EBBAULL}, {0xCC963FEE10B7D1B3ULL, 0x318DF905079926A8ULL},
+    {0xFFBBCFE994E5C61FULL, 0xFDF17746497F7052ULL}, {0x9FD561F1FD0F9BD3ULL, 0xFEB6EA8BEDEFA633ULL},
+    {0xC7CABA6E7C5382C8ULL, 0xFE64A52EE96B8FC0ULL}, {0xF9BD690A1B68637BULL, 0x3DFDCE7AA3C673B0ULL},
+    {0x9C1661A651213E2DULL, 0x06BEA10CA65C084EULL}, {0xC31BFA0FE5698DB8ULL, 0x486E494FCFF30A62ULL},
+    {0xF3E2F893DEC3F126ULL, 0x5A89DBA3C3EFCCFAULL}, {0x986DDB5C6B3A76B7ULL, 0xF89629465A75E01CULL},
+    {0xBE89523386091465ULL, 0xF6BBB397F1135823ULL}, {0xEE2BA6C0678B597FULL, 0x746AA07DED582E2CULL},
+    {0x94DB483840B717EFULL, 0xA8C2A44EB4571CDCULL}, {0xBA121A4650E4DDEBULL, 0x92F34D62616CE413ULL},
+    {0xE896A0D7E51E1566ULL, 0x77B020BAF9C81D17ULL}, {0x915E2486EF32CD60ULL, 0x0ACE1474DC1D122EULL},
+    {0xB5B5ADA8AAFF80B8ULL, 0x0D819992132456BAULL}, {0xE3231912D5BF60E6ULL, 0x10E1FFF697ED6C69ULL},
+    {0x8DF5EFABC5979C8FULL, 0xCA8D3FFA1EF463C1ULL}, {0xB1736B96B6FD83B3ULL, 0xBD308FF8A6B17CB2ULL},
+    {0xDDD0467C64BCE4A0ULL, 0xAC7CB3F6D05DDBDEULL}, {0x8AA22C0DBEF60EE4ULL, 0x6BCDF07A423AA96BULL},
+    {0xAD4AB7112EB3929DULL, 0x86C16C98D2C953C6ULL}, {0xD89D64D57A607744ULL, 0xE871C7BF077BA8B7ULL},
+    {0x87625F056C7C4A8BULL, 0x11471CD764AD4972ULL}, {0xA93AF6C6C79B5D2DULL, 0xD598E40D3DD89BCFULL},
+    {0xD389B47879823479ULL, 0x4AFF1D108D4EC2C3ULL}, {0x843610CB4BF160CBULL, 0xCEDF722A585139BAULL},
+    {0xA54394FE1EEDB8FEULL, 0xC2974EB4EE658828ULL}, {0xCE947A3DA6A9273EULL, 0x733D226229FEEA32ULL},
+    {0x811CCC668829B887ULL, 0x0806357D5A3F525FULL}, {0xA163FF802A3426A8ULL, 0xCA07C2DCB0CF26F7ULL},
+    {0xC9BCFF6034C13052ULL, 0xFC89B393DD02F0B5ULL}, {0xFC2C3F3841F17C67ULL, 0xBBAC2078D443ACE2ULL},
+    {0x9D9BA7832936EDC0ULL, 0xD54B944B84AA4C0DULL}, {0xC5029163F384A931ULL, 0x0A9E795E65D4DF11ULL},
+    {0xF64335BCF065D37DULL, 0x4D4617B5FF4A16D5ULL}, {0x99EA0196163FA42EULL, 0x504BCED1BF8E4E45ULL},
+    {0xC06481FB9BCF8D39ULL, 0xE45EC2862F71E1D6ULL}, {0xF07DA27A82C37088ULL, 0x5D767327BB4E5A4CULL},
+    {0x964E858C91BA2655ULL, 0x3A6A07F8D510F86FULL}, {0xBBE226EFB628AFEAULL, 0x890489F70A55368BULL},
+    {0xEADAB0ABA3B2DBE5ULL, 0x2B45AC74CCEA842EULL}, {0x92C8AE6B464FC96FULL, 0x3B0B8BC90012929DULL},
+    {0xB77ADA0617E3BBCBULL, 0x09CE6EBB40173744ULL}, {0xE55990879DDCAABDULL, 0xCC420A6A101D0515ULL},
+    {0x8F57FA54C2A9EAB6ULL, 0x9FA946824A12232DULL}, {0xB32DF8E9F3546564ULL, 0x47939822DC96ABF9ULL},
+    {0xDFF9772470297EBDULL, 0x59787E2B93BC56F7ULL}, {0x8BFBEA76C619EF36ULL, 0x57EB4EDB3C55B65AULL},
+    {0xAEFAE51477A06B03ULL, 0xEDE622920B6B23F1ULL}, {0xDAB99E59958885C4ULL, 0xE95FAB368E45ECEDULL},
+    {0x88B402F7FD75539BULL, 0x11DBCB0218EBB414ULL}, {0xAAE103B5FCD2A881ULL, 0xD652BDC29F26A119ULL},
+    {0xD59944A37C0752A2ULL, 0x4BE76D3346F0495FULL}, {0x857FCAE62D8493A5ULL, 0x6F70A4400C562DDBULL},
+    {0xA6DFBD9FB8E5B88EULL, 0xCB4CCD500F6BB952ULL}, {0xD097AD07A71F26B2ULL, 0x7E2000A41346A7A7ULL},
+    {0x825ECC24C873782FULL, 0x8ED400668C0C28C8ULL}, {0xA2F67F2DFA90563BULL, 0x728900802F0F32FAULL},
+    {0xCBB41EF979346BCAULL, 0x4F2B40A03AD2FFB9ULL}, {0xFEA126B7D78186BCULL, 0xE2F610C84987BFA8ULL},
+    {0x9F24B832E6B0F436ULL, 0x0DD9CA7D2DF4D7C9ULL}, {0xC6EDE63FA05D3143ULL, 0x91503D1C79720DBBULL},
+    {0xF8A95FCF88747D94ULL, 0x75A44C6397CE912AULL}, {0x9B69DBE1B548CE7CULL, 0xC986AFBE3EE11ABAULL},
+    {0xC24452DA229B021BULL, 0xFBE85BADCE996168ULL}, {0xF2D56790AB41C2A2ULL, 0xFAE27299423FB9C3ULL},
+    {0x97C560BA6B0919A5ULL, 0xDCCD879FC967D41AULL}, {0xBDB6B8E905CB600FULL, 0x5400E987BBC1C920ULL},
+    {0xED246723473E3813ULL, 0x290123E9AAB23B68ULL}, {0x9436C0760C86E30BULL, 0xF9A0B6720AAF6521ULL},
+    {0xB94470938FA89BCEULL, 0xF808E40E8D5B3E69ULL}, {0xE7958CB87392C2C2ULL, 0xB60B1D1230B20E04ULL},
+    {0x90BD77F3483BB9B9ULL, 0xB1C6F22B5E6F48C2ULL}, {0xB4ECD5F01A4AA828ULL, 0x1E38AEB6360B1AF3ULL},
+    {0xE2280B6C20DD5232ULL, 0x25C6DA63C38DE1B0ULL}, {0x8D590723948A535FULL, 0x579C487E5A38AD0EULL},
+    {0xB0AF48EC79ACE837ULL, 0x2D835A9DF0C6D851ULL}, {0xDCDB1B2798182244ULL, 0xF8E431456CF88E65ULL},
+    {0x8A08F0F8BF0F156BULL, 0x1B8E9ECB641B58FFULL}, {0xAC8B2D36EED2DAC5ULL, 0xE272467E3D222F3FULL},
+    {0xD7ADF884AA879177ULL, 0x5B0ED81DCC6ABB0FULL}, {0x86CCBB52EA94BAEAULL, 0x98E947129FC2B4E9ULL},
+    {0xA87FEA27A539E9A5ULL, 0x3F2398D747B36224ULL}, {0xD29FE4B18E88640EULL, 0x8EEC7F0D19A03AADULL},
+    {0x83A3EEEEF9153E89ULL, 0x1953CF68300424ACULL}, {0xA48CEAAAB75A8E2BULL, 0x5FA8C3423C052DD7ULL},
+    {0xCDB02555653131B6ULL, 0x3792F412CB06794DULL}, {0x808E17555F3EBF11ULL, 0xE2BBD88BBEE40BD0ULL},
+    {0xA0B19D2AB70E6ED6ULL, 0x5B6ACEAEAE9D0EC4ULL}, {0xC8DE047564D20A8BULL, 0xF245825A5A445275ULL},
+    {0xFB158592BE068D2EULL, 0xEED6E2F0F0D56712ULL}, {0x9CED737BB6C4183DULL, 0x55464DD69685606BULL},
+    {0xC428D05AA4751E4CULL, 0xAA97E14C3C26B886ULL}, {0xF53304714D9265DFULL, 0xD53DD99F4B3066A8ULL},
+    {0x993FE2C6D07B7FABULL, 0xE546A8038EFE4029ULL}, {0xBF8FDB78849A5F96ULL, 0xDE98520472BDD033ULL},
+    {0xEF73D256A5C0F77CULL, 0x963E66858F6D4440ULL}, {0x95A8637627989AADULL, 0xDDE7001379A44AA8ULL},
+    {0xBB127C53B17EC159ULL, 0x5560C018580D5D52ULL}, {0xE9D71B689DDE71AFULL, 0xAAB8F01E6E10B4A6ULL},
+    {0x9226712162AB070DULL, 0xCAB3961304CA70E8ULL}, {0xB6B00D69BB55C8D1ULL, 0x3D607B97C5FD0D22ULL},
+    {0xE45C10C42A2B3B05ULL, 0x8CB89A7DB77C506AULL}, {0x8EB98A7A9A5B04E3ULL, 0x77F3608E92ADB242ULL},
+    {0xB267ED1940F1C61CULL, 0x55F038B237591ED3ULL}, {0xDF01E85F912E37A3ULL, 0x6B6C46DEC52F6688ULL},
+    {0x8B61313BBABCE2C6ULL, 0x2323AC4B3B3DA015ULL}, {0xAE397D8AA96C1B77ULL, 0xABEC975E0A0D081AULL},
+    {0xD9C7DCED53C72255ULL, 0x96E7BD358C904A21ULL}, {0x881CEA14545C7575ULL, 0x7E50D64177DA2E54ULL},
+    {0xAA242499697392D2ULL, 0xDDE50BD1D5D0B9E9ULL}, {0xD4AD2DBFC3D07787ULL, 0x955E4EC64B44E864ULL},
+    {0x84EC3C97DA624AB4ULL, 0xBD5AF13BEF0B113EULL}, {0xA6274BBDD0FADD61ULL, 0xECB1AD8AEACDD58EULL},
+    {0xCFB11EAD453994BAULL, 0x67DE18EDA5814AF2ULL}, {0x81CEB32C4B43FCF4ULL, 0x80EACF948770CED7ULL},
+    {0xA2425FF75E14FC31ULL, 0xA1258379A94D028DULL}, {0xCAD2F7F5359A3B3EULL, 0x096EE45813A04330ULL},
+    {0xFD87B5F28300CA0DULL, 0x8BCA9D6E188853FCULL}, {0x9E74D1B791E07E48ULL, 0x775EA264CF55347DULL},
+    {0xC612062576589DDAULL, 0x95364AFE032A819DULL}, {0xF79687AED3EEC551ULL, 0x3A83DDBD83F52204ULL},
+    {0x9ABE14CD44753B52ULL, 0xC4926A9672793542ULL}, {0xC16D9A0095928A27ULL, 0x75B7053C0F178293ULL},
+    {0xF1C90080BAF72CB1ULL, 0x5324C68B12DD6338ULL}, {0x971DA05074DA7BEEULL, 0xD3F6FC16EBCA5E03ULL},
+    {0xBCE5086492111AEAULL, 0x88F4BB1CA6BCF584ULL}, {0xEC1E4A7DB69561A5ULL, 0x2B31E9E3D06C32E5ULL},
+    {0x9392EE8E921D5D07ULL, 0x3AFF322E62439FCFULL}, {0xB877AA3236A4B449ULL, 0x09BEFEB9FAD487C2ULL},
+    {0xE69594BEC44DE15BULL, 0x4C2EBE687989A9B3ULL}, {0x901D7CF73AB0ACD9ULL, 0x0F9D37014BF60A10ULL},
+    {0xB424DC35095CD80FULL, 0x538484C19EF38C94ULL}, {0xE12E13424BB40E13ULL, 0x2865A5F206B06FB9ULL},
+    {0x8CBCCC096F5088CBULL, 0xF93F87B7442E45D3ULL}, {0xAFEBFF0BCB24AAFEULL, 0xF78F69A51539D748ULL},
+    {0xDBE6FECEBDEDD5BEULL, 0xB573440E5A884D1BULL}, {0x89705F4136B4A597ULL, 0x31680A88F8953030ULL},
+    {0xABCC77118461CEFCULL, 0xFDC20D2B36BA7C3DULL}, {0xD6BF94D5E57A42BCULL, 0x3D32907604691B4CULL},
+    {0x8637BD05AF6C69B5ULL, 0xA63F9A49C2C1B10FULL}, {0xA7C5AC471B478423ULL, 0x0FCF80DC33721D53ULL},
+    {0xD1B71758E219652BULL, 0xD3C36113404EA4A8ULL}, {0x83126E978D4FDF3BULL, 0x645A1CAC083126E9ULL},
+    {0xA3D70A3D70A3D70AULL, 0x3D70A3D70A3D70A3ULL}, {0xCCCCCCCCCCCCCCCCULL, 0xCCCCCCCCCCCCCCCCULL},
+    {0x8000000000000000ULL, 0x0000000000000000ULL}, {0xA000000000000000ULL, 0x0000000000000000ULL},
+    {0xC800000000000000ULL, 0x0000000000000000ULL}, {0xFA00000000000000ULL, 0x0000000000000000ULL},
+    {0x9C40000000000000ULL, 0x0000000000000000ULL}, {0xC350000000000000ULL, 0x0000000000000000ULL},
+    {0xF424000000000000ULL, 0x0000000000000000ULL}, {0x9896800000000000ULL, 0x0000000000000000ULL},
+    {0xBEBC200000000000ULL, 0x0000000000000000ULL}, {0xEE6B280000000000ULL, 0x0000000000000000ULL},
+    {0x9502F90000000000ULL, 0x0000000000000000ULL}, {0xBA43B74000000000ULL, 0x0000000000000000ULL},
+    {0xE8D4A51000000000ULL, 0x0000000000000000ULL}, {0x9184E72A00000000ULL, 0x0000000000000000ULL},
+    {0xB5E620F480000000ULL, 0x0000000000000000ULL}, {0xE35FA931A0000000ULL, 0x0000000000000000ULL},
+    {0x8E1BC9BF04000000ULL, 0x0000000000000000ULL}, {0xB1A2BC2EC5000000ULL, 0x0000000000000000ULL},
+    {0xDE0B6B3A76400000ULL, 0x0000000000000000ULL}, {0x8AC7230489E80000ULL, 0x0000000000000000ULL},
+    {0xAD78EBC5AC620000ULL, 0x0000000000000000ULL}, {0xD8D726B7177A8000ULL, 0x0000000000000000ULL},
+    {0x878678326EAC9000ULL, 0x0000000000000000ULL}, {0xA968163F0A57B400ULL, 0x0000000000000000ULL},
+    {0xD3C21BCECCEDA100ULL, 0x0000000000000000ULL}, {0x84595161401484A0ULL, 0x0000000000000000ULL},
+    {0xA56FA5B99019A5C8ULL, 0x0000000000000000ULL}, {0xCECB8F27F4200F3AULL, 0x0000000000000000ULL},
+    {0x813F3978F8940984ULL, 0x4000000000000000ULL}, {0xA18F07D736B90BE5ULL, 0x5000000000000000ULL},
+    {0xC9F2C9CD04674EDEULL, 0xA400000000000000ULL}, {0xFC6F7C4045812296ULL, 0x4D00000000000000ULL},
+    {0x9DC5ADA82B70B59DULL, 0xF020000000000000ULL}, {0xC5371912364CE305ULL, 0x6C28000000000000ULL},
+    {0xF684DF56C3E01BC6ULL, 0xC732000000000000ULL}, {0x9A130B963A6C115CULL, 0x3C7F400000000000ULL},
+    {0xC097CE7BC90715B3ULL, 0x4B9F100000000000ULL}, {0xF0BDC21ABB48DB20ULL, 0x1E86D40000000000ULL},
+    {0x96769950B50D88F4ULL, 0x1314448000000000ULL}, {0xBC143FA4E250EB31ULL, 0x17D955A000000000ULL},
+    {0xEB194F8E1AE525FDULL, 0x5DCFAB0800000000ULL}, {0x92EFD1B8D0CF37BEULL, 0x5AA1CAE500000000ULL},
+    {0xB7ABC627050305ADULL, 0xF14A3D9E40000000ULL}, {0xE596B7B0C643C719ULL, 0x6D9CCD05D0000000ULL},
+    {0x8F7E32CE7BEA5C6FULL, 0xE4820023A2000000ULL}, {0xB35DBF821AE4F38BULL, 0xDDA2802C8A800000ULL},
+    {0xE0352F62A19E306EULL, 0xD50B2037AD200000ULL}, {0x8C213D9DA502DE45ULL, 0x4526F422CC340000ULL},
+    {0xAF298D050E4395D6ULL, 0x9670B12B7F410000ULL}, {0xDAF3F04651D47B4CULL, 0x3C0CDD765F114000ULL},
+    {0x88D8762BF324CD0FULL, 0xA5880A69FB6AC800ULL}, {0xAB0E93B6EFEE0053ULL, 0x8EEA0D047A457A00ULL},
+    {0xD5D238A4ABE98068ULL, 0x72A4904598D6D880ULL}, {0x85A36366EB71F041ULL, 0x47A6DA2B7F864750ULL},
+    {0xA70C3C40A64E6C51ULL, 0x999090B65F67D924ULL}, {0xD0CF4B50CFE20765ULL, 0xFFF4B4E3F741CF6DULL},
+    {0x82818F1281ED449FULL, 0xBFF8F10E7A8921A4ULL}, {0xA321F2D7226895C7ULL, 0xAFF72D52192B6A0DULL},
+    {0xCBEA6F8CEB02BB39ULL, 0x9BF4F8A69F764490ULL}, {0xFEE50B7025C36A08ULL, 0x02F236D04753D5B4ULL},
+    {0x9F4F2726179A2245ULL, 0x01D762422C946590ULL}, {0xC722F0EF9D80AAD6ULL, 0x424D3AD2B7B97EF5ULL},
+    {0xF8EBAD2B84E0D58BULL, 0xD2E0898765A7DEB2ULL}, {0x9B934C3B330C8577ULL, 0x63CC55F49F88EB2FULL},
+    {0xC2781F49FFCFA6D5ULL, 0x3CBF6B71C76B25FBULL}, {0xF316271C7FC3908AULL, 0x8BEF464E3945EF7AULL},
+    {0x97EDD871CFDA3A56ULL, 0x97758BF0E3CBB5ACULL}, {0xBDE94E8E43D0C8ECULL, 0x3D52EEED1CBEA317ULL},
+    {0xED63A231D4C4FB27ULL, 0x4CA7AAA863EE4BDDULL}, {0x945E455F24FB1CF8ULL, 0x8FE8CAA93E74EF6AULL},
+    {0xB975D6B6EE39E436ULL, 0xB3E2FD538E122B44ULL}, {0xE7D34C64A9C85D44ULL, 0x60DBBCA87196B616ULL},
+    {0x90E40FBEEA1D3A4AULL, 0xBC8955E946FE31CDULL}, {0xB51D13AEA4A488DDULL, 0x6BABAB6398BDBE41ULL},
+    {0xE264589A4DCDAB14ULL, 0xC696963C7EED2DD1ULL}, {0x8D7EB76070A08AECULL, 0xFC1E1DE5CF543CA2ULL},
+    {0xB0DE65388CC8ADA8ULL, 0x3B25A55F43294BCBULL}, {0xDD15FE86AFFAD912ULL, 0x49EF0EB713F39EBEULL},
+    {0x8A2DBF142DFCC7ABULL, 0x6E3569326C784337ULL}, {0xACB92ED9397BF996ULL, 0x49C2C37F07965404ULL},
+    {0xD7E77A8F87DAF7FBULL, 0xDC33745EC97BE906ULL}, {0x86F0AC99B4E8DAFDULL, 0x69A028BB3DED71A3ULL},
+    {0xA8ACD7C0222311BCULL, 0xC40832EA0D68CE0CULL}, {0xD2D80DB02AABD62BULL, 0xF50A3FA490C30190ULL},
+    {0x83C7088E1AAB65DBULL, 0x792667C6DA79E0FAULL}, {0xA4B8CAB1A1563F52ULL, 0x577001B891185938ULL},
+    {0xCDE6FD5E09ABCF26ULL, 0xED4C0226B55E6F86ULL}, {0x80B05E5AC60B6178ULL, 0x544F8158315B05B4ULL},
+    {0xA0DC75F1778E39D6ULL, 0x696361AE3DB1C721ULL}, {0xC913936DD571C84CULL, 0x03BC3A19CD1E38E9ULL},
+    {0xFB5878494ACE3A5FULL, 0x04AB48A04065C723ULL}, {0x9D174B2DCEC0E47BULL, 0x62EB0D64283F9C76ULL},
+    {0xC45D1DF942711D9AULL, 0x3BA5D0BD324F8394ULL}, {0xF5746577930D6500ULL, 0xCA8F44EC7EE36479ULL},
+    {0x9968BF6ABBE85F20ULL, 0x7E998B13CF4E1ECBULL}, {0xBFC2EF456AE276E8ULL, 0x9E3FEDD8C321A67EULL},
+    {0xEFB3AB16C59B14A2ULL, 0xC5CFE94EF3EA101EULL}, {0x95D04AEE3B80ECE5ULL, 0xBBA1F1D158724A12ULL},
+    {0xBB445DA9CA61281FULL, 0x2A8A6E45AE8EDC97ULL}, {0xEA1575143CF97226ULL, 0xF52D09D71A3293BDULL},
+    {0x924D692CA61BE758ULL, 0x593C2626705F9C56ULL}, {0xB6E0C377CFA2E12EULL, 0x6F8B2FB00C77836CULL},
+    {0xE498F455C38B997AULL, 0x0B6DFB9C0F956447ULL}, {0x8EDF98B59A373FECULL, 0x4724BD4189BD5EACULL},
+    {0xB2977EE300C50FE7ULL, 0x58EDEC91EC2CB657ULL}, {0xDF3D5E9BC0F653E1ULL, 0x2F2967B66737E3EDULL},
+    {0x8B865B215899F46CULL, 0xBD79E0D20082EE74ULL}, {0xAE67F1E9AEC07187ULL, 0xECD8590680A3AA11ULL},
+    {0xDA01EE641A708DE9ULL, 0xE80E6F4820CC9495ULL}, {0x884134FE908658B2ULL, 0x3109058D147FDCDDULL},
+    {0xAA51823E34A7EEDEULL, 0xBD4B46F0599FD415ULL}, {0xD4E5E2CDC1D1EA96ULL, 0x6C9E18AC7007C91AULL},
+    {0x850FADC09923329EULL, 0x03E2CF6BC604DDB0ULL}, {0xA6539930BF6BFF45ULL, 0x84DB8346B786151CULL},
+    {0xCFE87F7CEF46FF16ULL, 0xE612641865679A63ULL}, {0x81F14FAE158C5F6EULL, 0x4FCB7E8F3F60C07EULL},
+    {0xA26DA3999AEF7749ULL, 0xE3BE5E330F38F09DULL}, {0xCB090C8001AB551CULL, 0x5CADF5BFD3072CC5ULL},
+    {0xFDCB4FA002162A63ULL, 0x73D9732FC7C8F7F6ULL}, {0x9E9F11C4014DDA7EULL, 0x2867E7FDDCDD9AFAULL},
+    {0xC646D63501A1511DULL, 0xB281E1FD541501B8ULL}, {0xF7D88BC24209A565ULL, 0x1F225A7CA91A4226ULL},
+    {0x9AE757596946075FULL, 0x3375788DE9B06958ULL}, {0xC1A12D2FC3978937ULL, 0x0052D6B1641C83AEULL},
+    {0xF209787BB47D6B84ULL, 0xC0678C5DBD23A49AULL}, {0x9745EB4D50CE6332ULL, 0xF840B7BA963646E0ULL},
+    {0xBD176620A501FBFFULL, 0xB650E5A93BC3D898ULL}, {0xEC5D3FA8CE427AFFULL, 0xA3E51F138AB4CEBEULL},
+    {0x93BA47C980E98CDFULL, 0xC66F336C36B10137ULL}, {0xB8A8D9BBE123F017ULL, 0xB80B0047445D4184ULL},
+    {0xE6D3102AD96CEC1DULL, 0xA60DC059157491E5ULL}, {0x9043EA1AC7E41392ULL, 0x87C89837AD68DB2FULL},
+    {0xB454E4A179DD1877ULL, 0x29BABE4598C311FBULL}, {0xE16A1DC9D8545E94ULL, 0xF4296DD6FEF3D67AULL},
+    {0x8CE2529E2734BB1DULL, 0x1899E4A65F58660CULL}, {0xB01AE745B101E9E4ULL, 0x5EC05DCFF72E7F8FULL},
+    {0xDC21A1171D42645DULL, 0x76707543F4FA1F73ULL}, {0x899504AE72497EBAULL, 0x6A06494A791C53A8ULL},
+    {0xABFA45DA0EDBDE69ULL, 0x0487DB9D17636892ULL}, {0xD6F8D7509292D603ULL, 0x45A9D2845D3C42B6ULL},
+    {0x865B86925B9BC5C2ULL, 0x0B8A2392BA45A9B2ULL}, {0xA7F26836F282B732ULL, 0x8E6CAC7768D7141EULL},
+    {0xD1EF0244AF2364FFULL, 0x3207D795430CD926ULL}, {0x8335616AED761F1FULL, 0x7F44E6BD49E807B8ULL},
+    {0xA402B9C5A8D3A6E7ULL, 0x5F16206C9C6209A6ULL}, {0xCD036837130890A1ULL, 0x36DBA887C37A8C0FULL},
+    {0x802221226BE55A64ULL, 0xC2494954DA2C9789ULL}, {0xA02AA96B06DEB0FDULL, 0xF2DB9BAA10B7BD6CULL},
+    {0xC83553C5C8965D3DULL, 0x6F92829494E5ACC7ULL}, {0xFA42A8B73ABBF48CULL, 0xCB772339BA1F17F9ULL},
+    {0x9C69A97284B578D7ULL, 0xFF2A760414536EFBULL}, {0xC38413CF25E2D70DULL, 0xFEF5138519684ABAULL},
+    {0xF46518C2EF5B8CD1ULL, 0x7EB258665FC25D69ULL}, {0x98BF2F79D5993802ULL, 0xEF2F773FFBD97A61ULL},
+    {0xBEEEFB584AFF8603ULL, 0xAAFB550FFACFD8FAULL}, {0xEEAABA2E5DBF6784ULL, 0x95BA2A53F983CF38ULL},
+    {0x952AB45CFA97A0B2ULL, 0xDD945A747BF26183ULL}, {0xBA756174393D88DFULL, 0x94F971119AEEF9E4ULL},
+    {0xE912B9D1478CEB17ULL, 0x7A37CD5601AAB85DULL}, {0x91ABB422CCB812EEULL, 0xAC62E055C10AB33AULL},
+    {0xB616A12B7FE617AAULL, 0x577B986B314D6009ULL}, {0xE39C49765FDF9D94ULL, 0xED5A7E85FDA0B80BULL},
+    {0x8E41ADE9FBEBC27DULL, 0x14588F13BE847307ULL}, {0xB1D219647AE6B31CULL, 0x596EB2D8AE258FC8ULL},
+    {0xDE469FBD99A05FE3ULL, 0x6FCA5F8ED9AEF3BBULL}, {0x8AEC23D680043BEEULL, 0x25DE7BB9480D5854ULL},
+    {0xADA72CCC20054AE9ULL, 0xAF561AA79A10AE6AULL}, {0xD910F7FF28069DA4ULL, 0x1B2BA1518094DA04ULL},
+    {0x87AA9AFF79042286ULL, 0x90FB44D2F05D0842ULL}, {0xA99541BF57452B28ULL, 0x353A1607AC744A53ULL},
+    {0xD3FA922F2D1675F2ULL, 0x42889B8997915CE8ULL}, {0x847C9B5D7C2E09B7ULL, 0x69956135FEBADA11ULL},
+    {0xA59BC234DB398C25ULL, 0x43FAB9837E699095ULL}, {0xCF02B2C21207EF2EULL, 0x94F967E45E03F4BBULL},
+    {0x8161AFB94B44F57DULL, 0x1D1BE0EEBAC278F5ULL}, {0xA1BA1BA79E1632DCULL, 0x6462D92A69731732ULL},
+    {0xCA28A291859BBF93ULL, 0x7D7B8F7503CFDCFEULL}, {0xFCB2CB35E702AF78ULL, 0x5CDA735244C3D43EULL},
+    {0x9DEFBF01B061ADABULL, 0x3A0888136AFA64A7ULL}, {0xC56BAEC21C7A1916ULL, 0x088AAA1845B8FDD0ULL},
+    {0xF6C69A72A3989F5BULL, 0x8AAD549E57273D45ULL}, {0x9A3C2087A63F6399ULL, 0x36AC54E2F678864BULL},
+    {0xC0CB28A98FCF3C7FULL, 0x84576A1BB416A7DDULL}, {0xF0FDF2D3F3C30B9FULL, 0x656D44A2A11C51D5ULL},
+    {0x969EB7C47859E743ULL, 0x9F644AE5A4B1B325ULL}, {0xBC4665B596706114ULL, 0x873D5D9F0DDE1FEEULL},
+    {0xEB57FF22FC0C7959ULL, 0xA90CB506D155A7EAULL}, {0x9316FF75DD87CBD8ULL, 0x09A7F12442D588F2ULL},
+    {0xB7DCBF5354E9BECEULL, 0x0C11ED6D538AEB2FULL}, {0xE5D3EF282A242E81ULL, 0x8F1668C8A86DA5FAULL},
+    {0x8FA475791A569D10ULL, 0xF96E017D694487BCULL}, {0xB38D92D760EC4455ULL, 0x37C981DCC395A9ACULL},
+    {0xE070F78D3927556AULL, 0x85BBE253F47B1417ULL}, {0x8C469AB843B89562ULL, 0x93956D7478CCEC8EULL},
+    {0xAF58416654A6BABBULL, 0x387AC8D1970027B2ULL}, {0xDB2E51BFE9D0696AULL, 0x06997B05FCC0319EULL},
+    {0x88FCF317F22241E2ULL, 0x441FECE3BDF81F03ULL}, {0xAB3C2FDDEEAAD25AULL, 0xD527E81CAD7626C3ULL},
+    {0xD60B3BD56A5586F1ULL, 0x8A71E223D8D3B074ULL}, {0x85C7056562757456ULL, 0xF6872D5667844E49ULL},
+    {0xA738C6BEBB12D16CULL, 0xB428F8AC016561DBULL}, {0xD106F86E69D785C7ULL, 0xE13336D701BEBA52ULL},
+    {0x82A45B450226B39CULL, 0xECC0024661173473ULL}, {0xA34D721642B06084ULL, 0x27F002D7F95D0190ULL},
+    {0xCC20CE9BD35C78A5ULL, 0x31EC038DF7B441F4ULL}, {0xFF290242C83396CEULL, 0x7E67047175A15271ULL},
+    {0x9F79A169BD203E41ULL, 0x0F0062C6E984D386ULL}, {0xC75809C42C684DD1ULL, 0x52C07B78A3E60868ULL},
+    {0xF92E0C3537826145ULL, 0xA7709A56CCDF8A82ULL}, {0x9BBCC7A142B17CCBULL, 0x88A66076400BB691ULL},
+    {0xC2ABF989935DDBFEULL, 0x6ACFF893D00EA435ULL}, {0xF356F7EBF83552FEULL, 0x0583F6B8C4124D43ULL},
+    {0x98165AF37B2153DEULL, 0xC3727A337A8B704AULL}, {0xBE1BF1B059E9A8D6ULL, 0x744F18C0592E4C5CULL},
+    {0xEDA2EE1C7064130CULL, 0x1162DEF06F79DF73ULL}, {0x9485D4D1C63E8BE7ULL, 0x8ADDCB5645AC2BA8ULL},
+    {0xB9A74A0637CE2EE1ULL, 0x6D953E2BD7173692ULL}, {0xE8111C87C5C1BA99ULL, 0xC8FA8DB6CCDD0437ULL},
+    {0x910AB1D4DB9914A0ULL, 0x1D9C9892400A22A2ULL}, {0xB54D5E4A127F59C8ULL, 0x2503BEB6D00CAB4BULL},
+    {0xE2A0B5DC971F303AULL, 0x2E44AE64840FD61DULL}, {0x8DA471A9DE737E24ULL, 0x5CEAECFED289E5D2ULL},
+    {0xB10D8E1456105DADULL, 0x7425A83E872C5F47ULL}, {0xDD50F1996B947518ULL, 0xD12F124E28F77719ULL},
+    {0x8A5296FFE33CC92FULL, 0x82BD6B70D99AAA6FULL}, {0xACE73CBFDC0BFB7BULL, 0x636CC64D1001550BULL},
+    {0xD8210BEFD30EFA5AULL, 0x3C47F7E05401AA4EULL}, {0x8714A775E3E95C78ULL, 0x65ACFAEC34810A71ULL},
+    {0xA8D9D1535CE3B396ULL, 0x7F1839A741A14D0DULL}, {0xD31045A8341CA07CULL, 0x1EDE48111209A050ULL},
+    {0x83EA2B892091E44DULL, 0x934AED0AAB460432ULL}, {0xA4E4B66B68B65D60ULL, 0xF81DA84D5617853FULL},
+    {0xCE1DE40642E3F4B9ULL, 0x36251260AB9D668EULL}, {0x80D2AE83E9CE78F3ULL, 0xC1D72B7C6B426019ULL},
+    {0xA1075A24E4421730ULL, 0xB24CF65B8612F81FULL}, {0xC94930AE1D529CFCULL, 0xDEE033F26797B627ULL},
+    {0xFB9B7CD9A4A7443CULL, 0x169840EF017DA3B1ULL}, {0x9D412E0806E88AA5ULL, 0x8E1F289560EE864EULL},
+    {0xC491798A08A2AD4EULL, 0xF1A6F2BAB92A27E2ULL}, {0xF5B5D7EC8ACB58A2ULL, 0xAE10AF696774B1DBULL},
+    {0x9991A6F3D6BF1765ULL, 0xACCA6DA1E0A8EF29ULL}, {0xBFF610B0CC6EDD3FULL, 0x17FD090A58D32AF3ULL},
+    {0xEFF394DCFF8A948EULL, 0xDDFC4B4CEF07F5B0ULL}, {0x95F83D0A1FB69CD9ULL, 0x4ABDAF101564F98EULL},
+    {0xBB764C4CA7A4440FULL, 0x9D6D1AD41ABE37F1ULL}, {0xEA53DF5FD18D5513ULL, 0x84C86189216DC5EDULL},
+    {0x92746B9BE2F8552CULL, 0x32FD3CF5B4E49BB4ULL}, {0xB7118682DBB66A77ULL, 0x3FBC8C33221DC2A1ULL},
+    {0xE4D5E82392A40515ULL, 0x0FABAF3FEAA5334AULL}, {0x8F05B1163BA6832DULL, 0x29CB4D87F2A7400EULL},
+    {0xB2C71D5BCA9023F8ULL, 0x743E20E9EF511012ULL}, {0xDF78E4B2BD342CF6ULL, 0x914DA9246B255416ULL},
+    {0x8BAB8EEFB6409C1AULL, 0x1AD089B6C2F7548EULL}, {0xAE9672ABA3D0C320ULL, 0xA184AC2473B529B1ULL},
+    {0xDA3C0F568CC4F3E8ULL, 0xC9E5D72D90A2741EULL}, {0x8865899617FB1871ULL, 0x7E2FA67C7A658892ULL},
+    {0xAA7EEBFB9DF9DE8DULL, 0xDDBB901B98FEEAB7ULL}, {0xD51EA6FA85785631ULL, 0x552A74227F3EA565ULL},
+    {0x8533285C936B35DEULL, 0xD53A88958F87275FULL}, {0xA67FF273B8460356ULL, 0x8A892ABAF368F137ULL},
+    {0xD01FEF10A657842CULL, 0x2D2B7569B0432D85ULL}, {0x8213F56A67F6B29BULL, 0x9C3B29620E29FC73ULL},
+    {0xA298F2C501F45F42ULL, 0x8349F3BA91B47B8FULL}, {0xCB3F2F7642717713ULL, 0x241C70A936219A73ULL},
+    {0xFE0EFB53D30DD4D7ULL, 0xED238CD383AA0110ULL}, {0x9EC95D1463E8A506ULL, 0xF4363804324A40AAULL},
+    {0xC67BB4597CE2CE48ULL, 0xB143C6053EDCD0D5ULL}, {0xF81AA16FDC1B81DAULL, 0xDD94B7868E94050AULL},
+    {0x9B10A4E5E9913128ULL, 0xCA7CF2B4191C8326ULL}, {0xC1D4CE1F63F57D72ULL, 0xFD1C2F611F63A3F0ULL},
+    {0xF24A01A73CF2DCCFULL, 0xBC633B39673C8CECULL}, {0x976E41088617CA01ULL, 0xD5BE0503E085D813ULL},
+    {0xBD49D14AA79DBC82ULL, 0x4B2D8644D8A74E18ULL}, {0xEC9C459D51852BA2ULL, 0xDDF8E7D60ED1219EULL},
+    {0x93E1AB8252F33B45ULL, 0xCABB90E5C942B503ULL}, {0xB8DA1662E7B00A17ULL, 0x3D6A751F3B936243ULL},
+    {0xE7109BFBA19C0C9DULL, 0x0CC512670A783AD4ULL}, {0x906A617D450187E2ULL, 0x27FB2B80668B24C5ULL},
+    {0xB484F9DC9641E9DAULL, 0xB1F9F660802DEDF6ULL}, {0xE1A63853BBD26451ULL, 0x5E7873F8A0396973ULL},
+    {0x8D07E33455637EB2ULL, 0xDB0B487B6423E1E8ULL}, {0xB049DC016ABC5E5FULL, 0x91CE1A9A3D2CDA62ULL},
+    {0xDC5C5301C56B75F7ULL, 0x7641A140CC7810FBULL}, {0x89B9B3E11B6329BAULL, 0xA9E904C87FCB0A9DULL},
+    {0xAC2820D9623BF429ULL, 0x546345FA9FBDCD44ULL}, {0xD732290FBACAF133ULL, 0xA97C177947AD4095ULL},
+    {0x867F59A9D4BED6C0ULL, 0x49ED8EABCCCC485DULL}, {0xA81F301449EE8C70ULL, 0x5C68F256BFFF5A74ULL},
+    {0xD226FC195C6A2F8CULL, 0x73832EEC6FFF3111ULL}, {0x83585D8FD9C25DB7ULL, 0xC831FD53C5FF7EABULL},
+    {0xA42E74F3D032F525ULL, 0xBA3E7CA8B77F5E55ULL}, {0xCD3A1230C43FB26FULL, 0x28CE1BD2E55F35EBULL},
+    {0x80444B5E7AA7CF85ULL, 0x7980D163CF5B81B3ULL}, {0xA0555E361951C366ULL, 0xD7E105BCC332621FULL},
+    {0xC86AB5C39FA63440ULL, 0x8DD9472BF3FEFAA7ULL}, {0xFA856334878FC150ULL, 0xB14F98F6F0FEB951ULL},
+    {0x9C935E00D4B9D8D2ULL, 0x6ED1BF9A569F33D3ULL}, {0xC3B8358109E84F07ULL, 0x0A862F80EC4700C8ULL},
+    {0xF4A642E14C6262C8ULL, 0xCD27BB612758C0FAULL}, {0x98E7E9CCCFBD7DBDULL, 0x8038D51CB897789CULL},
+    {0xBF21E44003ACDD2CULL, 0xE0470A63E6BD56C3ULL}, {0xEEEA5D5004981478ULL, 0x1858CCFCE06CAC74ULL},
+    {0x95527A5202DF0CCBULL, 0x0F37801E0C43EBC8ULL}, {0xBAA718E68396CFFDULL, 0xD30560258F54E6BAULL},
+    {0xE950DF20247C83FDULL, 0x47C6B82EF32A2069ULL}, {0x91D28B7416CDD27EULL, 0x4CDC331D57FA5441ULL},
+    {0xB6472E511C81471DULL, 0xE0133FE4ADF8E952ULL}, {0xE3D8F9E563A198E5ULL, 0x58180FDDD97723A6ULL},
+    {0x8E679C2F5E44FF8FULL, 0x570F09EAA7EA7648ULL}, {0xB201833B35D63F73ULL, 0x2CD2CC6551E513DAULL},
+    {0xDE81E40A034BCF4FULL, 0xF8077F7EA65E58D1ULL}, {0x8B112E86420F6191ULL, 0xFB04AFAF27FAF782ULL},
+    {0xADD57A27D29339F6ULL, 0x79C5DB9AF1F9B563ULL}, {0xD94AD8B1C7380874ULL, 0x18375281AE7822BCULL},
+    {0x87CEC76F1C830548ULL, 0x8F2293910D0B15B5ULL}, {0xA9C2794AE3A3C69AULL, 0xB2EB3875504DDB22ULL},
+    {0xD433179D9C8CB841ULL, 0x5FA60692A46151EBULL}, {0x849FEEC281D7F328ULL, 0xDBC7C41BA6BCD333ULL},
+    {0xA5C7EA73224DEFF3ULL, 0x12B9B522906C0800ULL}, {0xCF39E50FEAE16BEFULL, 0xD768226B34870A00ULL},
+    {0x81842F29F2CCE375ULL, 0xE6A1158300D46640ULL}, {0xA1E53AF46F801C53ULL, 0x60495AE3C1097FD0ULL},
+    {0xCA5E89B18B602368ULL, 0x385BB19CB14BDFC4ULL}, {0xFCF62C1DEE382C42ULL, 0x46729E03DD9ED7B5ULL},
+    {0x9E19DB92B4E31BA9ULL, 0x6C07A2C26A8346D1ULL}, {0xC5A05277621BE293ULL, 0xC7098B7305241885ULL},
+    {0xF70867153AA2DB38ULL, 0xB8CBEE4FC66D1EA7ULL},
+};
+
+// 向上取整的10^e，用于最短格式化（Schubfach算法）
+static inline bs_u128 bs_pow10_ceil(int e) {
+    const uint64_t* entry = bs_pow10_table[e - BS_POW10_MIN_EXP];
+    bs_u128 r;
+    r.lo = entry[1] + 1;
+    r.hi = entry[0] + (r.lo == 0);
+    return r;
+}
+
+// floor(log10(2^e))、floor(log10(3/4 * 2^e))与floor(log2(10^e))
+static inline int bs_floor_log10_pow2(int e) {
+    return (e * 1262611) >> 22;
+}
+
+static inline int bs_floor_log10_three_quarter_pow2(int e) {
+    return (e * 1262611 - 524031) >> 22;
+}
+
+static inline int bs_floor_log2_pow10(int e) {
+    return (e * 1741647) >> 19;
+}
+
+// 计算g * cp / 2^128，舍入到奇数
+static inline uint64_t bs_round_to_odd(bs_u128 g, uint64_t cp) {
+    bs_u128 x = bs_mul64(g.lo, cp);
+    bs_u128 y = bs_mul64(g.hi, cp);
+    uint64_t z = y.lo + x.hi;
+    uint64_t high = y.hi + (z < x.hi);
+    return high | (z > 1);
+}
+
+// 把有限正double转换为最短的十进制digits * 10^exponent
+static void bs_shortest_decimal(uint64_t significand, int biased_exponent, uint64_t* digits, int* exponent) {
+    uint64_t c;
+    int q;
+    if (biased_exponent != 0) {
+        c = ((uint64_t)1 << 52) | significand;
+        q = biased_exponent - 1075;
+        // 小整数直接输出
+        if (q <= 0 && -q < 53 && (c & (((uint64_t)1 << -q) - 1)) == 0) {
+            *digits = c >> -q;
+            *exponent = 0;
+            return;
+        }
+    } else {
+        c = significand;
+        q = -1074;
+    }
+    
+    bool is_even = (c % 2) == 0;
+    bool lower_closer = significand == 0 && biased_exponent > 1;
+    
+    uint64_t cbl = 4 * c - 2 + lower_closer;
+    uint64_t cb = 4 * c;
+    uint64_t cbr = 4 * c + 2;
+    
+    int k = lower_closer ? bs_floor_log10_three_quarter_pow2(q) : bs_floor_log10_pow2(q);
+    int h = q + bs_floor_log2_pow10(-k) + 1;
+    
+    bs_u128 g = bs_pow10_ceil(-k);
+    uint64_t vbl = bs_round_to_odd(g, cbl << h);
+    uint64_t vb = bs_round_to_odd(g, cb << h);
+    uint64_t vbr = bs_round_to_odd(g, cbr << h);
+    
+    uint64_t lower = vbl + !is_even;
+    uint64_t upper = vbr - !is_even;
+    
+    // 先尝试少一位数字的候选
+    uint64_t s = vb / 4;
+    if (s >= 10) {
+        uint64_t sp = s / 10;
+        bool up_inside = lower <= 40 * sp;
+        bool wp_inside = 40 * sp + 40 <= upper;
+        if (up_inside != wp_inside) {
+            *digits = sp + wp_inside;
+            *exponent = k + 1;
+            return;
+        }
+    }
+    
+    bool u_inside = lower <= 4 * s;
+    bool w_inside = 4 * s + 4 <= upper;
+    if (u_inside != w_inside) {
+        *digits = s + w_inside;
+        *exponent = k;
+        return;
+    }
+    
+    // 两个候选都在区间内时取最近的，距离相同时取偶数
+    uint64_t mid = 4 * s + 2;
+    bool round_up = vb > mid || (vb == mid && (s & 1) != 0);
+    *digits = s + round_up;
+    *exponent = k;
+}
+
+size_t bs_float_to_chars(double value, char* buffer) {
+    if (!buffer) {
+        return 0;
+    }
+    
+    uint64_t bits = bs_double_to_bits(value);
+    uint64_t significand = bits & (((uint64_t)1 << 52) - 1);
+    int biased_exponent = (int)((bits >> 52) & 0x7FF);
+    char* out = buffer;
+    
+    if (biased_exponent == 0x7FF) {
+        if (significand != 0) {
+            memcpy(out, "nan", 3);
+            return 3;
+        }
+        if (bits >> 63) {
+            *out++ = '-';
+        }
+        memcpy(out, "inf", 3);
+        return (size_t)(out - buffer) + 3;
+    }
+    
+    if (bits >> 63) {
+        *out++ = '-';
+    }
+    if (biased_exponent == 0 && significand == 0) {
+        *out++ = '0';
+        return (size_t)(out - buffer);
+    }
+    
+    uint64_t digits;
+    int exponent;
+    bs_shortest_decimal(significand, biased_exponent, &digits, &exponent);
+    while (digits % 10 == 0) {
+        digits /= 10;
+        exponent++;
+    }
+    
+    // 数值为0.d1d2...dn * 10^point
+    int count = (int)bs_count_digits(digits);
+    int point = count + exponent;
+    
+    if (count <= point && point <= 21) {
+        // 整数：数字后补零
+        bs_write_digits(digits, out, (unsigned)count);
+        memset(out + count, '0', (size_t)(point - count));
+        out += point;
+    } else if (0 < point && point <= 21) {
+        // 小数点在数字中间
+        bs_write_digits(digits, out, (unsigned)count);
+        memmove(out + point + 1, out + point, (size_t)(count - point));
+        out[point] = '.';
+        out += count + 1;
+    } else if (-6 < point && point <= 0) {
+        // 0.000ddd
+        out[0] = '0';
+        out[1] = '.';
+        memset(out + 2, '0', (size_t)-point);
+        out += 2 - point;
+        bs_write_digits(digits, out, (unsigned)count);
+        out += count;
+    } else {
+        // 科学计数法：d[.ddd]e±x
+        bs_write_digits(digits, out + 1, (unsigned)count);
+        out[0] = out[1];
+        if (count > 1) {
+            out[1] = '.';
+            out += count + 1;
+        } else {
+            out += 1;
+        }
+        int exp10 = point - 1;
+        *out++ = 'e';
+        *out++ = exp10 < 0 ? '-' : '+';
+        unsigned magnitude = (unsigned)(exp10 < 0 ? -exp10 : exp10);
+        unsigned exp_digits = bs_count_digits(magnitude);
+        bs_write_digits(magnitude, out, exp_digits);
+        out += exp_digits;
+    }
+    
+    return (size_t)(out - buffer);
+}
+
+bs_string* bs_string_from_float(double value) {
+    // 按最大长度分配，直接格式化到字符串缓冲区
+    bs_string* result = bs_string_alloc(BS_FLOAT_MAX_CHARS, BS_ENCODING_UTF8);
+    if (!result) {
+        return NULL;
+    }
+    
+    size_t length = bs_float_to_chars(value, (char*)result->data);
+    result->data[length] = '\0';
+    result->byte_length = length;
+    result->length = length; // 全部是ASCII
+    return result;
+}
+
+// 计算w * 10^q最接近的double（Eisel-Lemire算法），返回不含符号位的位模式
+// w必须是精确值；对于不超过19位的十进制数，此算法总能得到正确舍入的结果
+static uint64_t bs_decimal_to_double_bits(uint64_t w, int64_t q) {
+    if (w == 0 || q < -342) {
+        return 0;
+    }
+    if (q > 308) {
+        return (uint64_t)0x7FF << 52;
+    }
+    
+    int lz = (int)bs_clz64(w);
+    w <<= lz;
+    
+    // 截断表项在[-27, -1]内需要加一，与原算法使用的表一致
+    const uint64_t* entry = bs_pow10_table[q - BS_POW10_MIN_EXP];
+    uint64_t pow_hi = entry[0];
+    uint64_t pow_lo = entry[1];
+    if (q < 0 && q >= -27) {
+        pow_lo++;
+        pow_hi += (pow_lo == 0);
+    }
+    
+    // 55位精度足够时不需要第二次乘法
+    bs_u128 product = bs_mul64(w, pow_hi);
+    if ((product.hi & 0x1FF) == 0x1FF) {
+        bs_u128 second = bs_mul64(w, pow_lo);
+        product.lo += second.hi;
+        if (second.hi > product.lo) {
+            product.hi++;
+        }
+    }
+    
+    uint64_t upper_bit = product.hi >> 63;
+    uint64_t mantissa = product.hi >> (upper_bit + 9);
+    int64_t power2 = (((152170 + 65536) * q) >> 16) + 63 + (int64_t)upper_bit - lz + 1023;
+    
+    if (power2 <= 0) {
+        // 非规格化数
+        if (-power2 + 1 >= 64) {
+            return 0;
+        }
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        power2 = mantissa < ((uint64_t)1 << 52) ? 0 : 1;
+        return ((uint64_t)power2 << 52) | (mantissa & (((uint64_t)1 << 52) - 1));
+    }
+    
+    // 恰好位于两个double中间时向偶数舍入
+    if (product.lo <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 &&
+        (mantissa << (upper_bit + 9)) == product.hi) {
+        mantissa &= ~(uint64_t)1;
+    }
+    
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= ((uint64_t)2 << 52)) {
+        mantissa = (uint64_t)1 << 52;
+        power2++;
+    }
+    mantissa &= ~((uint64_t)1 << 52);
+    if (power2 >= 0x7FF) {
+        return (uint64_t)0x7FF << 52;
+    }
+    return ((uint64_t)power2 << 52) | mantissa;
+}
+
+static inline bool bs_is_digit(uint8_t c) {
+    return (uint8_t)(c - '0') < 10;
+}
+
+// 不区分大小写地比较ASCII字母
+static bool bs_ascii_iequals(const uint8_t* data, size_t length, const char* word) {
+    size_t word_length = strlen(word);
+    if (length != word_length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        if ((data[i] | 0x20) != (uint8_t)word[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 超过19位有效数字且快速算法无法确定舍入时，交给strtod处理
+// 只传递数字和指数，不含小数点，因此不受区域设置影响
+#define BS_FLOAT_SLOW_DIGITS 768
+
+static double bs_parse_float_slow(const uint8_t* int_begin, size_t int_digits,
+                                  const uint8_t* frac_begin, size_t frac_digits,
+                                  int64_t exp_number) {
+    char buffer[BS_FLOAT_SLOW_DIGITS + 2 + BS_INT_MAX_CHARS + 1];
+    size_t count = 0;
+    int64_t dropped = 0;
+    bool sticky = false;
+    
+    for (size_t part = 0; part < 2; part++) {
+        const uint8_t* p = part == 0 ? int_begin : frac_begin;
+        size_t n = part == 0 ? int_digits : frac_digits;
+        for (size_t i = 0; i < n; i++) {
+            if (count == 0 && p[i] == '0') {
+                continue;
+            }
+            if (count < BS_FLOAT_SLOW_DIGITS) {
+                buffer[count++] = (char)p[i];
+            } else {
+                sticky |= p[i] != '0';
+                dropped++;
+            }
+        }
+    }
+    
+    // 被丢弃的非零数字只影响舍入方向，用一个额外的1代替
+    if (sticky) {
+        buffer[count++] = '1';
+        dropped--;
+    }
+    
+    buffer[count++] = 'e';
+    count += bs_int_to_chars(exp_number - (int64_t)frac_digits + dropped, buffer + count);
+    buffer[count] = '\0';
+    return strtod(buffer, NULL);
+}
+
+bool bs_parse_float(const char* str, size_t length, double* value) {
+    if (!str || length == 0) {
+        return false;
+    }
+    
+    const uint8_t* p = (const uint8_t*)str;
+    const uint8_t* end = p + length;
+    bool negative = false;
+    if (*p == '-' || *p == '+') {
+        negative = *p == '-';
+        p++;
+    }
+    if (p == end) {
+        return false;
+    }
+    
+    // 特殊值
+    if (!bs_is_digit(*p) && *p != '.') {
+        size_t rest = (size_t)(end - p);
+        double special;
+        if (bs_ascii_iequals(p, rest, "inf") || bs_ascii_iequals(p, rest, "infinity")) {
+            special = bs_bits_to_double((uint64_t)0x7FF << 52);
+        } else if (bs_ascii_iequals(p, rest, "nan")) {
+            special = bs_bits_to_double(((uint64_t)0x7FF << 52) | ((uint64_t)1 << 51));
+        } else {
+            return false;
+        }
+        if (value) {
+            *value = negative ? -special : special;
+        }
+        return true;
+    }
+    
+    // 整数部分，每次处理8位
+    uint64_t w = 0;
+    const uint8_t* int_begin = p;
+#ifndef BS_BIG_ENDIAN
+    while (end - p >= 8) {
+        uint64_t chunk = bs_load_u64(p);
+        if (!bs_is_eight_digits(chunk)) {
+            break;
+        }
+        w = w * 100000000ULL + bs_parse_eight_digits(chunk);
+        p += 8;
+    }
+#endif
+    while (p < end && bs_is_digit(*p)) {
+        w = w * 10 + (uint64_t)(*p - '0');
+        p++;
+    }
+    size_t int_digits = (size_t)(p - int_begin);
+    
+    // 小数部分
+    const uint8_t* frac_begin = p;
+    size_t frac_digits = 0;
+    if (p < end && *p == '.') {
+        p++;
+        frac_begin = p;
+#ifndef BS_BIG_ENDIAN
+        while (end - p >= 8) {
+            uint64_t chunk = bs_load_u64(p);
+            if (!bs_is_eight_digits(chunk)) {
+                break;
+            }
+            w = w * 100000000ULL + bs_parse_eight_digits(chunk);
+            p += 8;
+        }
+#endif
+        while (p < end && bs_is_digit(*p)) {
+            w = w * 10 + (uint64_t)(*p - '0');
+            p++;
+        }
+        frac_digits = (size_t)(p - frac_begin);
+    }
+    if (int_digits + frac_digits == 0) {
+        return false;
+    }
+    
+    // 指数部分，过大的指数不再累加以免溢出
+    int64_t exp_number = 0;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool exp_negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            exp_negative = *p == '-';
+            p++;
+        }
+        if (p == end || !bs_is_digit(*p)) {
+            return false;
+        }
+        while (p < end && bs_is_digit(*p)) {
+            if (exp_number < 0x10000000) {
+                exp_number = exp_number * 10 + (*p - '0');
+            }
+            p++;
+        }
+        if (exp_negative) {
+            exp_number = -exp_number;
+        }
+    }
+    if (p != end) {
+        return false;
+    }
+    
+    int64_t exponent = exp_number - (int64_t)frac_digits;
+    
+    // 有效数字超过19位时w已经溢出，重新读取前19位
+    bool truncated = false;
+    size_t digit_count = int_digits + frac_digits;
+    if (digit_count > 19) {
+        const uint8_t* start = int_begin;
+        while (start < end && (*start == '0' || *start == '.')) {
+            digit_count -= *start == '0';
+            start++;
+        }
+        if (digit_count > 19) {
+            const uint64_t min_19_digits = 1000000000000000000ULL;
+            const uint8_t* int_end = int_begin + int_digits;
+            truncated = true;
+            w = 0;
+            p = int_begin;
+            while (w < min_19_digits && p < int_end) {
+                w = w * 10 + (uint64_t)(*p - '0');
+                p++;
+            }
+            if (w >= min_19_digits) {
+                exponent = (int64_t)(int_end - p) + exp_number;
+            } else {
+                p = frac_begin;
+                while (w < min_19_digits && p < frac_begin + frac_digits) {
+                    w = w * 10 + (uint64_t)(*p - '0');
+                    p++;
+                }
+                exponent = exp_number - (int64_t)(p - frac_begin);
+            }
+        }
+    }
+    
+    double result;
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    // 尾数和10的幂都能精确表示时，一次浮点运算即可得到正确舍入的结果
+    static const double exact_pow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    if (!truncated && exponent >= -22 && exponent <= 22 && w <= ((uint64_t)1 << 53)) {
+        result = (double)w;
+        result = exponent < 0 ? result / exact_pow10[-exponent] : result * exact_pow10[exponent];
+        if (value) {
+            *value = negative ? -result : result;
+        }
+        return true;
+    }
+#endif
+    
+    uint64_t bits = bs_decimal_to_double_bits(w, exponent);
+    if (truncated && bits != bs_decimal_to_double_bits(w + 1, exponent)) {
+        result = bs_parse_float_slow(int_begin, int_digits, frac_begin, frac_digits, exp_number);
+    } else {
+        result = bs_bits_to_double(bits);
+    }
+    
+    if (value) {
+        *value = negative ? -result : result;
+    }
+    return true;
+}
+
+bool bs_string_try_parse_float(const bs_string* str, double* value) {
+    if (!str) {
+        return false;
+    }
+    return bs_parse_float((const char*)str->data, str->byte_length, value);
+}
+
+double bs_string_to_float(const bs_string* str) {
+    double value = 0.0;
+    return bs_string_try_parse_float(str, &value) ? value : 0.0;
+}
+
+size_t bs_string_array_parse_float(const bs_string_array* array, double* values, bool* ok) {
+    if (!array || !values) {
+        return 0;
+    }
+    
+    size_t parsed = 0;
+    for (size_t i = 0; i < array->length; i++) {
+        bool success = bs_string_try_parse_float(array->items[i], &values[i]);
+        if (!success) {
+            values[i] = 0.0;
+        }
+        if (ok) {
+            ok[i] = success;
+        }
+        parsed += success;
+    }
+    return parsed;
+}
+
+size_t bs_compact_array_parse_float(const bs_compact_array* array, double* values, bool* ok) {
+    if (!array || !values) {
+        return 0;
+    }
+    
+    size_t parsed = 0;
+    for (size_t i = 0; i < array->length; i++) {
+        size_t start = array->offsets[i];
+        bool success = bs_parse_float((const char*)(array->data + start), array->offsets[i + 1] - start, &values[i]);
+        if (!success) {
+            values[i] = 0.0;
+        }
+        if (ok) {
+            ok[i] = success;
+        }
+        parsed += success;
+    }
+    return parsed;
+}
+
+bs_compact_array* bs_compact_array_from_floats(const double* values, size_t count) {
+    if (!values && count > 0) {
+        return NULL;
+    }
+    
+    // 按最大长度分配并直接格式化，最后把整块内存收缩到实际大小
+    bs_compact_array* result = bs_compact_array_alloc(count, count * BS_FLOAT_MAX_CHARS);
+    if (!result) {
+        return NULL;
+    }
+    
+    size_t offset = 0;
+    for (size_t i = 0; i < count; i++) {
+        offset += bs_float_to_chars(values[i], (char*)(result->data + offset));
+        result->offsets[i + 1] = offset;
+    }
+    result->data[offset] = '\0';
+    
+    size_t used = (size_t)(result->data - (uint8_t*)result) + offset + 1;
+    bs_compact_array* shrunk = (bs_compact_array*)realloc(result, used);
+    if (shrunk) {
+        result = shrunk;
+        result->offsets = (size_t*)((uint8_t*)result + sizeof(bs_compact_array));
+        result->data = (uint8_t*)result->offsets + (count + 1) * sizeof(size_t);
+    }
+    
+    return result;
+}
+
+// 格式化字符串
+bs_string* bs_string_format(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    bs_string* result = bs_string_vformat(format, args);
+    va_end(args);
+    return result;
+}
+
+bs_string* bs_string_vformat(const char* format, va_list args) {
+    if (!format) {
+        return bs_string_new("");
+    }
+    
+    // 短结果一次格式化到栈缓冲区，放不下时按精确长度直接格式化到字符串缓冲区
+    char stack_buffer[256];
+    va_list args_copy;
+    va_copy(args_copy, args);
+    int len = vsnprintf(stack_buffer, sizeof(stack_buffer), format, args_copy);
+    va_end(args_copy);
+    
+    if (len < 0) {
+        return bs_string_new("");
+    }
+    
+    bs_string* result = bs_string_alloc((size_t)len, BS_ENCODING_UTF8);
+    if (!result) {
+        return NULL;
+    }
+    
+    if ((size_t)len < sizeof(stack_buffer)) {
+        memcpy(result->data, stack_buffer, (size_t)len);
+    } else {
+        va_copy(args_copy, args);
+        vsnprintf((char*)result->data, (size_t)len + 1, format, args_copy);
+        va_end(args_copy);
+    }
+    
+    result->length = utf8_strlen((const char*)result->data, (size_t)len);
+    return result;
+}
+
+// 字符串构建器实现
+
+#define BS_BUILDER_DEFAULT_CHUNK 4096
+#define BS_BUILDER_MAX_CHUNK (1024 * 1024)
+
+typedef struct bs_builder_block {
+    uint8_t* data;      // 紧跟在块头之后
+    size_t used;
+    size_t capacity;
+} bs_builder_block;
+
+struct bs_builder {
+    bs_builder_block** chunks;  // 块指针数组，数组扩容时块本身不移动
+    size_t chunk_count;
+    size_t chunk_capacity;
+    size_t total;               // 已写入的字节数
+    size_t first_chunk_size;
+    size_t next_chunk_size;
+};
+
+static bs_builder_block* bs_builder_block_new(size_t capacity) {
+    bs_builder_block* chunk = (bs_builder_block*)malloc(sizeof(bs_builder_block) + capacity);
+    if (!chunk) {
+        return NULL;
+    }
+    chunk->data = (uint8_t*)(chunk + 1);
+    chunk->used = 0;
+    chunk->capacity = capacity;
+    return chunk;
+}
+
+bs_builder* bs_builder_new(size_t chunk_size) {
+    bs_builder* builder = (bs_builder*)malloc(sizeof(bs_builder));
+    if (!builder) {
+        return NULL;
+    }
+    
+    builder->first_chunk_size = chunk_size ? chunk_size : BS_BUILDER_DEFAULT_CHUNK;
+    builder->next_chunk_size = builder->first_chunk_size;
+    builder->chunks = NULL;
+    builder->chunk_count = 0;
+    builder->chunk_capacity = 0;
+    builder->total = 0;
+    return builder;
+}
+
+void bs_builder_free(bs_builder* builder) {
+    if (!builder) {
+        return;
+    }
+    for (size_t i = 0; i < builder->chunk_count; i++) {
+        free(builder->chunks[i]);
+    }
+    free(builder->chunks);
+    free(builder);
+}
+
+void bs_builder_clear(bs_builder* builder) {
+    if (!builder) {
+        return;
+    }
+    for (size_t i = 1; i < builder->chunk_count; i++) {
+        free(builder->chunks[i]);
+    }
+    if (builder->chunk_count > 0) {
+        builder->chunks[0]->used = 0;
+        builder->chunk_count = 1;
+    }
+    builder->total = 0;
+    builder->next_chunk_size = builder->first_chunk_size;
+    if (builder->chunk_count > 0 && builder->next_chunk_size < BS_BUILDER_MAX_CHUNK) {
+        builder->next_chunk_size *= 2;
+    }
+}
+
+// 追加一个至少能容纳min_bytes的新块
+static bs_builder_block* bs_builder_grow(bs_builder* builder, size_t min_bytes) {
+    if (builder->chunk_count == builder->chunk_capacity) {
+        size_t new_capacity = builder->chunk_capacity ? builder->chunk_capacity * 2 : 8;
+        bs_builder_block** chunks = (bs_builder_block**)realloc(builder->chunks, new_capacity * sizeof(bs_builder_block*));
+        if (!chunks) {
+            return NULL;
+        }
+        builder->chunks = chunks;
+        builder->chunk_capacity = new_capacity;
+    }
+    
+    size_t capacity = builder->next_chunk_size;
+    if (capacity < min_bytes) {
+        capacity = min_bytes;
+    }
+    bs_builder_block* chunk = bs_builder_block_new(capacity);
+    if (!chunk) {
+        return NULL;
+    }
+    
+    builder->chunks[builder->chunk_count++] = chunk;
+    if (builder->next_chunk_size < BS_BUILDER_MAX_CHUNK) {
+        builder->next_chunk_size *= 2;
+    }
+    return chunk;
+}
+
+// 返回至少有bytes字节连续空间的写入位置，写入后用bs_builder_commit提交
+static uint8_t* bs_builder_reserve(bs_builder* builder, size_t bytes) {
+    bs_builder_block* chunk = builder->chunk_count ? builder->chunks[builder->chunk_count - 1] : NULL;
+    if (!chunk || chunk->capacity - chunk->used < bytes) {
+        chunk = bs_builder_grow(builder, bytes);
+        if (!chunk) {
+            return NULL;
+        }
+    }
+    return chunk->data + chunk->used;
+}
+
+static inline void bs_builder_commit(bs_builder* builder, size_t bytes) {
+    builder->chunks[builder->chunk_count - 1]->used += bytes;
+    builder->total += bytes;
+}
+
+bool bs_builder_append(bs_builder* builder, const char* data, size_t length) {
+    if (!builder || (!data && length > 0)) {
+        return false;
+    }
+    if (length == 0) {
+        return true;
+    }
+    
+    // 先填满当前块，剩余部分放入一个足够大的新块
+    bs_builder_block* chunk = builder->chunk_count ? builder->chunks[builder->chunk_count - 1] : NULL;
+    size_t first = 0;
+    if (chunk) {
+        size_t room = chunk->capacity - chunk->used;
+        first = room < length ? room : length;
+    }
+    if (first < length && !bs_builder_grow(builder, length - first)) {
+        return false;
+    }
+    
+    if (first > 0) {
+        memcpy(chunk->data + chunk->used, data, first);
+        chunk->used += first;
+    }
+    if (first < length) {
+        chunk = builder->chunks[builder->chunk_count - 1];
+        memcpy(chunk->data, data + first, length - first);
+        chunk->used = length - first;
+    }
+    builder->total += length;
+    return true;
+}
+
+bool bs_builder_append_cstr(bs_builder* builder, const char* str) {
+    if (!str) {
+        return false;
+    }
+    return bs_builder_append(builder, str, strlen(str));
+}
+
+bool bs_builder_append_string(bs_builder* builder, const bs_string* str) {
+    if (!str) {
+        return false;
+    }
+    return bs_builder_append(builder, (const char*)str->data, str->byte_length);
+}
+
+bool bs_builder_append_char(bs_builder* builder, char c) {
+    if (!builder) {
+        return false;
+    }
+    uint8_t* out = bs_builder_reserve(builder, 1);
+    if (!out) {
+        return false;
+    }
+    *out = (uint8_t)c;
+    bs_builder_commit(builder, 1);
+    return true;
+}
+
+bool bs_builder_append_codepoint(bs_builder* builder, uint32_t codepoint) {
+    if (!builder) {
+        return false;
+    }
+    uint8_t* out = bs_builder_reserve(builder, 4);
+    if (!out) {
+        return false;
+    }
+    bs_builder_commit(builder, utf8_encode_char(codepoint, out));
+    return true;
+}
+
+bool bs_builder_append_int(bs_builder* builder, int64_t value) {
+    if (!builder) {
+        return false;
+    }
+    uint8_t* out = bs_builder_reserve(builder, BS_INT_MAX_CHARS);
+    if (!out) {
+        return false;
+    }
+    bs_builder_commit(builder, bs_int_to_chars(value, (char*)out));
+    return true;
+}
+
+bool bs_builder_append_float(bs_builder* builder, double value) {
+    if (!builder) {
+        return false;
+    }
+    uint8_t* out = bs_builder_reserve(builder, BS_FLOAT_MAX_CHARS);
+    if (!out) {
+        return false;
+    }
+    bs_builder_commit(builder, bs_float_to_chars(value, (char*)out));
+    return true;
+}
+
+bool bs_builder_append_json_string(bs_builder* builder, const char* data, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+    if (!builder || (!data && length > 0)) {
+        return false;
+    }
+    
+    // 失败时回退到追加前的状态
+    size_t saved_count = builder->chunk_count;
+    size_t saved_used = saved_count ? builder->chunks[saved_count - 1]->used : 0;
+    size_t saved_total = builder->total;
+    
+    const uint8_t* p = (const uint8_t*)data;
+    const uint8_t* end = p + length;
+    bool ok = bs_builder_append_char(builder, '"');
+    while (ok && p < end) {
+        // 不需要转义的字节整段复制
+        const uint8_t* run = p;
+        while (p < end && *p >= 0x20 && *p != '"' && *p != '\\') {
+            p++;
+        }
+        if (p > run) {
+            ok = bs_builder_append(builder, (const char*)run, (size_t)(p - run));
+            continue;
+        }
+        
+        char escape[6] = {'\\', 0, 0, 0, 0, 0};
+        size_t escape_length = 2;
+        switch (*p) {
+            case '"': escape[1] = '"'; break;
+            case '\\': escape[1] = '\\'; break;
+            case '\n': escape[1] = 'n'; break;
+            case '\r': escape[1] = 'r'; break;
+            case '\t': escape[1] = 't'; break;
+            case '\b': escape[1] = 'b'; break;
+            case '\f': escape[1] = 'f'; break;
+            default:
+                escape[1] = 'u';
+                escape[2] = '0';
+                escape[3] = '0';
+                escape[4] = hex[*p >> 4];
+                escape[5] = hex[*p & 0x0F];
+                escape_length = 6;
+                break;
+        }
+        ok = bs_builder_append(builder, escape, escape_length);
+        p++;
+    }
+    if (ok) {
+        ok = bs_builder_append_char(builder, '"');
+    }
+    
+    if (!ok) {
+        for (size_t i = saved_count; i < builder->chunk_count; i++) {
+            free(builder->chunks[i]);
+        }
+        builder->chunk_count = saved_count;
+        if (saved_count) {
+            builder->chunks[saved_count - 1]->used = saved_used;
+        }
+        builder->total = saved_total;
+    }
+    return ok;
+}
+
+bool bs_builder_append_csv_field(bs_builder* builder, const char* data, size_t length,
+                                 const bs_csv_dialect* dialect) {
+    if (!builder || (!data && length > 0)) {
+        return false;
+    }
+    
+    char delimiter = dialect ? dialect->delimiter : ',';
+    char quote = dialect ? dialect->quote : '"';
+    
+    bool needs_quotes = false;
+    size_t quote_count = 0;
+    for (size_t i = 0; i < length; i++) {
+        char c = data[i];
+        if (c == quote) {
+            quote_count++;
+            needs_quotes = true;
+        } else if (c == delimiter || c == '\n' || c == '\r') {
+            needs_quotes = true;
+        }
+    }
+    if (!needs_quotes) {
+        return bs_builder_append(builder, data, length);
+    }
+    
+    // 转义后的长度已知，一次预留
+    size_t escaped_length = length + quote_count + 2;
+    uint8_t* out = bs_builder_reserve(builder, escaped_length);
+    if (!out) {
+        return false;
+    }
+    size_t pos = 0;
+    out[pos++] = (uint8_t)quote;
+    for (size_t i = 0; i < length; i++) {
+        if (data[i] == quote) {
+            out[pos++] = (uint8_t)quote;
+        }
+        out[pos++] = (uint8_t)data[i];
+    }
+    out[pos++] = (uint8_t)quote;
+    bs_builder_commit(builder, pos);
+    return true;
+}
+
+size_t bs_builder_length(const bs_builder* builder) {
+    return builder ? builder->total : 0;
+}
+
+size_t bs_builder_chunk_count(const bs_builder* builder) {
+    return builder ? builder->chunk_count : 0;
+}
+
+bs_string bs_builder_chunk(const bs_builder* builder, size_t index) {
+    if (!builder || index >= builder->chunk_count) {
+        return bs_string_view_len(NULL, 0);
+    }
+    const bs_builder_block* chunk = builder->chunks[index];
+    return bs_string_view_len((const char*)chunk->data, chunk->used);
+}
+
+bs_string* bs_builder_finish(bs_builder* builder) {
+    if (!builder) {
+        return NULL;
+    }
+    
+    bs_string* result = bs_string_alloc(builder->total, BS_ENCODING_UTF8);
+    if (!result) {
+        return NULL;
+    }
+    
+    uint8_t* out = result->data;
+    for (size_t i = 0; i < builder->chunk_count; i++) {
+        memcpy(out, builder->chunks[i]->data, builder->chunks[i]->used);
+        out += builder->chunks[i]->used;
+    }
+    result->length = utf8_strlen((const char*)result->data, result->byte_length);
+    
+    bs_builder_clear(builder);
+    return result;
+}
+
+// 批量输出
+#define BS_IOV_BATCH 256  // 一次writev的最大项数，不超过各平台的IOV_MAX
+
+// 跳过已写出的written字节，返回剩余的第一项
+static bs_iovec* bs_iovec_advance(bs_iovec* iov, size_t* count, size_t written) {
+    while (*count > 0 && written >= iov->length) {
+        written -= iov->length;
+        iov++;
+        (*count)--;
+    }
+    if (*count > 0) {
+        iov->data += written;
+        iov->length -= written;
+    }
+    return iov;
+}
+
+// 写一次，返回写出的字节数，出错返回-1
+static ptrdiff_t bs_writev_once(int fd, const bs_iovec* iov, size_t count) {
+#if defined(_WIN32)
+    // 没有writev，只写第一段，剩余部分由调用者继续
+    (void)count;
+    unsigned chunk = iov->length > 0x40000000 ? 0x40000000u : (unsigned)iov->length;
+    return (ptrdiff_t)_write(fd, iov->data, chunk);
+#else
+    struct iovec batch[BS_IOV_BATCH];
+    size_t n = count < BS_IOV_BATCH ? count : BS_IOV_BATCH;
+    for (size_t i = 0; i < n; i++) {
+        batch[i].iov_base = (void*)iov[i].data;
+        batch[i].iov_len = iov[i].length;
+    }
+    return (ptrdiff_t)writev(fd, batch, (int)n);
+#endif
+}
+
+bs_iovec* bs_writev_some(int fd, bs_iovec* iov, size_t* count) {
+    if (fd < 0 || !count || (!iov && *count > 0)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (*count == 0) {
+        // 已经写完的列表（可能是NULL）直接成功返回，返回值只需不为NULL
+        static bs_iovec bs_iovec_empty;
+        return iov ? iov : &bs_iovec_empty;
+    }
+    
+    iov = bs_iovec_advance(iov, count, 0);
+    while (*count > 0) {
+        ptrdiff_t written = bs_writev_once(fd, iov, *count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return NULL;
+        }
+        iov = bs_iovec_advance(iov, count, (size_t)written);
+    }
+    return iov;
+}
+
+bool bs_writev_all(int fd, bs_iovec* iov, size_t count) {
+    if (fd < 0 || (!iov && count > 0)) {
+        return false;
+    }
+    
+    iov = bs_iovec_advance(iov, &count, 0);
+    while (count > 0) {
+        ptrdiff_t written = bs_writev_once(fd, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        iov = bs_iovec_advance(iov, &count, (size_t)written);
+    }
+    return true;
+}
+
+bool bs_write_all(int fd, const bs_string* const* strings, size_t count) {
+    if (fd < 0 || (!strings && count > 0)) {
+        return false;
+    }
+    
+    // 每次最多转换BS_IOV_BATCH项，写完再转换下一批
+    bs_iovec batch[BS_IOV_BATCH];
+    size_t i = 0;
+    while (i < count) {
+        size_t n = 0;
+        for (; i < count && n < BS_IOV_BATCH; i++) {
+            if (strings[i] && strings[i]->byte_length > 0) {
+                batch[n].data = strings[i]->data;
+                batch[n].length = strings[i]->byte_length;
+                n++;
+            }
+        }
+        if (!bs_writev_all(fd, batch, n)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool bs_write_array(int fd, const bs_string_array* array) {
+    if (!array) {
+        return false;
+    }
+    return bs_write_all(fd, (const bs_string* const*)array->items, array->length);
+}
+
+bool bs_builder_flush(bs_builder* builder, int fd) {
+    if (!builder || fd < 0) {
+        return false;
+    }
+    
+    // 各块一起用writev写出，不拼接
+    bs_iovec batch[BS_IOV_BATCH];
+    size_t i = 0;
+    while (i < builder->chunk_count) {
+        size_t n = 0;
+        for (; i < builder->chunk_count && n < BS_IOV_BATCH; i++, n++) {
+            batch[n].data = builder->chunks[i]->data;
+            batch[n].length = builder->chunks[i]->used;
+        }
+        if (!bs_writev_all(fd, batch, n)) {
+            return false;
+        }
+    }
+    bs_builder_clear(builder);
+    return true;
+}
+
+bool bs_builder_flush_file(bs_builder* builder, FILE* file) {
+    if (!builder || !file) {
+        return false;
+    }
+    
+    for (size_t i = 0; i < builder->chunk_count; i++) {
+        const bs_builder_block* chunk = builder->chunks[i];
+        if (fwrite(chunk->data, 1, chunk->used, file) != chunk->used) {
+            return false;
+        }
+    }
+    bs_builder_clear(builder);
+    return true;
+}
+
+// 绳索实现
+
+#define BS_ROPE_LEAF_MAX 1024
+#define BS_ROPE_LEAF_MIN (BS_ROPE_LEAF_MAX / 4)
+#define BS_ROPE_BULK_LEAF (BS_ROPE_LEAF_MAX * 3 / 4)   // 批量构建时每块的目标大小
+#define BS_ROPE_PIECE (BS_ROPE_LEAF_MAX / 2)           // 一次插入叶子的最大字节数
+#define BS_ROPE_FANOUT 16
+#define BS_ROPE_INNER_MIN (BS_ROPE_FANOUT / 2)
+
+struct bs_rope_node {
+    size_t bytes;       // 子树的字节数
+    size_t chars;       // 子树的字符数
+    size_t lines;       // 子树的换行数
+    unsigned count;     // 内部节点的子节点数
+    bool is_leaf;
+};
+
+typedef struct bs_rope_node bs_rope_node;
+
+typedef struct {
+    bs_rope_node base;
+    uint8_t text[BS_ROPE_LEAF_MAX];
+} bs_rope_leaf;
+
+typedef struct {
+    bs_rope_node base;
+    bs_rope_node* children[BS_ROPE_FANOUT];
+} bs_rope_inner;
+
+struct bs_rope {
+    bs_rope_node* root;  // 空绳索为NULL
+};
+
+#define BS_ROPE_LEAF(node) ((bs_rope_leaf*)(node))
+#define BS_ROPE_INNER(node) ((bs_rope_inner*)(node))
+
+static size_t bs_count_newlines(const uint8_t* data, size_t length) {
+    size_t lines = 0;
+    const uint8_t* end = data + length;
+    while (data < end) {
+        const uint8_t* found = (const uint8_t*)memchr(data, '\n', (size_t)(end - data));
+        if (!found) {
+            break;
+        }
+        lines++;
+        data = found + 1;
+    }
+    return lines;
+}
+
+// 向前调整到UTF-8字符的起始字节
+// 最多后退3个字节；找不到首字节（无效UTF-8）时直接在pos处切分，保证两侧大小不失控
+static size_t bs_utf8_boundary_before(const uint8_t* data, size_t pos) {
+    size_t start = pos;
+    for (int i = 0; i < 3 && start > 0 && (data[start] & 0xC0) == 0x80; i++) {
+        start--;
+    }
+    return (data[start] & 0xC0) == 0x80 ? pos : start;
+}
+
+// 叶子内第char_index个字符的字节偏移
+static size_t bs_rope_leaf_byte_offset(const bs_rope_leaf* leaf, size_t char_index) {
+    if (char_index >= leaf->base.chars) {
+        return leaf->base.bytes;
+    }
+    size_t pos = 0;
+    while (char_index > 0 && pos < leaf->base.bytes) {
+        pos++;
+        while (pos < leaf->base.bytes && (leaf->text[pos] & 0xC0) == 0x80) {
+            pos++;
+        }
+        char_index--;
+    }
+    return pos;
+}
+
+static void bs_rope_leaf_set(bs_rope_leaf* leaf, const uint8_t* data, size_t length) {
+    memcpy(leaf->text, data, length);
+    leaf->base.bytes = length;
+    leaf->base.chars = utf8_strlen((const char*)data, length);
+    leaf->base.lines = bs_count_newlines(data, length);
+}
+
+static bs_rope_leaf* bs_rope_leaf_new(const uint8_t* data, size_t length) {
+    bs_rope_leaf* leaf = (bs_rope_leaf*)malloc(sizeof(bs_rope_leaf));
+    if (!leaf) {
+        return NULL;
+    }
+    leaf->base.is_leaf = true;
+    leaf->base.count = 0;
+    bs_rope_leaf_set(leaf, data, length);
+    return leaf;
+}
+
+static bs_rope_inner* bs_rope_inner_new(void) {
+    bs_rope_inner* inner = (bs_rope_inner*)malloc(sizeof(bs_rope_inner));
+    if (!inner) {
+        return NULL;
+    }
+    inner->base.is_leaf = false;
+    inner->base.count = 0;
+    inner->base.bytes = 0;
+    inner->base.chars = 0;
+    inner->base.lines = 0;
+    return inner;
+}
+
+static void bs_rope_node_free(bs_rope_node* node) {
+    if (!node) {
+        return;
+    }
+    if (!node->is_leaf) {
+        bs_rope_inner* inner = BS_ROPE_INNER(node);
+        for (unsigned i = 0; i < node->count; i++) {
+            bs_rope_node_free(inner->children[i]);
+        }
+    }
+    free(node);
+}
+
+// 根据子节点重新计算统计值
+static void bs_rope_inner_recount(bs_rope_inner* inner) {
+    inner->base.bytes = 0;
+    inner->base.chars = 0;
+    inner->base.lines = 0;
+    for (unsigned i = 0; i < inner->base.count; i++) {
+        inner->base.bytes += inner->children[i]->bytes;
+        inner->base.chars += inner->children[i]->chars;
+        inner->base.lines += inner->children[i]->lines;
+    }
+}
+
+// 自底向上批量构建，各层节点尽量均匀
+static bs_rope_node* bs_rope_build(const uint8_t* data, size_t length) {
+    if (length == 0) {
+        return NULL;
+    }
+    
+    size_t count = (length + BS_ROPE_BULK_LEAF - 1) / BS_ROPE_BULK_LEAF;
+    bs_rope_node** nodes = (bs_rope_node**)malloc(count * sizeof(bs_rope_node*));
+    if (!nodes) {
+        return NULL;
+    }
+    
+    size_t built = 0;
+    size_t pos = 0;
+    while (pos < length) {
+        size_t remaining_leaves = count > built ? count - built : 1;
+        size_t target = (length - pos + remaining_leaves - 1) / remaining_leaves;
+        size_t end = pos + target;
+        if (end >= length) {
+            end = length;
+        } else {
+            size_t boundary = bs_utf8_boundary_before(data, end);
+            if (boundary > pos) {
+                end = boundary;
+            }
+        }
+        
+        bs_rope_leaf* leaf = built < count ? bs_rope_leaf_new(data + pos, end - pos) : NULL;
+        if (!leaf) {
+            for (size_t i = 0; i < built; i++) {
+                free(nodes[i]);
+            }
+            free(nodes);
+            return NULL;
+        }
+        nodes[built++] = &leaf->base;
+        pos = end;
+    }
+    count = built;
+    
+    while (count > 1) {
+        size_t groups = (count + BS_ROPE_FANOUT - 1) / BS_ROPE_FANOUT;
+        size_t next = 0;
+        size_t index = 0;
+        for (size_t g = 0; g < groups; g++) {
+            size_t take = (count - index) / (groups - g);
+            bs_rope_inner* inner = bs_rope_inner_new();
+            if (!inner) {
+                // 已分组的节点挂在前面的内部节点上，一起释放
+                for (size_t i = 0; i < next; i++) {
+                    bs_rope_node_free(nodes[i]);
+                }
+                for (size_t i = index; i < count; i++) {
+                    bs_rope_node_free(nodes[i]);
+                }
+                free(nodes);
+                return NULL;
+            }
+            for (size_t i = 0; i < take; i++) {
+                inner->children[i] = nodes[index + i];
+            }
+            inner->base.count = (unsigned)take;
+            bs_rope_inner_recount(inner);
+            index += take;
+            nodes[next++] = &inner->base;
+        }
+        count = next;
+    }
+    
+    bs_rope_node* root = nodes[0];
+    free(nodes);
+    return root;
+}
+
+bs_rope* bs_rope_new(void) {
+    bs_rope* rope = (bs_rope*)malloc(sizeof(bs_rope));
+    if (!rope) {
+        return NULL;
+    }
+    rope->root = NULL;
+    return rope;
+}
+
+bs_rope* bs_rope_from_cstr(const char* data, size_t length) {
+    if (!data && length > 0) {
+        return NULL;
+    }
+    
+    bs_rope* rope = bs_rope_new();
+    if (!rope) {
+        return NULL;
+    }
+    if (length > 0) {
+        rope->root = bs_rope_build((const uint8_t*)data, length);
+        if (!rope->root) {
+            free(rope);
+            return NULL;
+        }
+    }
+    return rope;
+}
+
+bs_rope* bs_rope_from_string(const bs_string* str) {
+    if (!str) {
+        return NULL;
+    }
+    return bs_rope_from_cstr((const char*)str->data, str->byte_length);
+}
+
+void bs_rope_free(bs_rope* rope) {
+    if (!rope) {
+        return;
+    }
+    bs_rope_node_free(rope->root);
+    free(rope);
+}
+
+size_t bs_rope_length(const bs_rope* rope) {
+    return rope && rope->root ? rope->root->chars : 0;
+}
+
+size_t bs_rope_byte_length(const bs_rope* rope) {
+    return rope && rope->root ? rope->root->bytes : 0;
+}
+
+size_t bs_rope_line_count(const bs_rope* rope) {
+    return rope && rope->root ? rope->root->lines + 1 : 1;
+}
+
+// 在子树中插入不超过BS_ROPE_PIECE字节的文本
+// 节点需要分裂时返回新的右侧兄弟节点；*failed表示内存不足，此时子树保持不变
+static bs_rope_node* bs_rope_insert_piece(bs_rope_node* node, size_t index, const uint8_t* data,
+                                          size_t length, bool* failed) {
+    if (node->is_leaf) {
+        bs_rope_leaf* leaf = BS_ROPE_LEAF(node);
+        size_t offset = bs_rope_leaf_byte_offset(leaf, index);
+        
+        if (node->bytes + length <= BS_ROPE_LEAF_MAX) {
+            memmove(leaf->text + offset + length, leaf->text + offset, node->bytes - offset);
+            memcpy(leaf->text + offset, data, length);
+            node->bytes += length;
+            node->chars += utf8_strlen((const char*)data, length);
+            node->lines += bs_count_newlines(data, length);
+            return NULL;
+        }
+        
+        // 放不下时拼接后从中间的字符边界分成两块
+        uint8_t buffer[BS_ROPE_LEAF_MAX + BS_ROPE_PIECE];
+        size_t total = node->bytes + length;
+        memcpy(buffer, leaf->text, offset);
+        memcpy(buffer + offset, data, length);
+        memcpy(buffer + offset + length, leaf->text + offset, node->bytes - offset);
+        
+        size_t mid = bs_utf8_boundary_before(buffer, total / 2);
+        bs_rope_leaf* right = bs_rope_leaf_new(buffer + mid, total - mid);
+        if (!right) {
+            *failed = true;
+            return NULL;
+        }
+        bs_rope_leaf_set(leaf, buffer, mid);
+        return &right->base;
+    }
+    
+    bs_rope_inner* inner = BS_ROPE_INNER(node);
+    unsigned i = 0;
+    while (i + 1 < node->count && index > inner->children[i]->chars) {
+        index -= inner->children[i]->chars;
+        i++;
+    }
+    
+    // 节点已满时预先分配分裂用的节点，保证失败时不留下半完成的修改
+    bs_rope_inner* spare = NULL;
+    if (node->count == BS_ROPE_FANOUT) {
+        spare = bs_rope_inner_new();
+        if (!spare) {
+            *failed = true;
+            return NULL;
+        }
+    }
+    
+    bs_rope_node* child = inner->children[i];
+    size_t old_bytes = child->bytes;
+    size_t old_chars = child->chars;
+    size_t old_lines = child->lines;
+    bs_rope_node* split = bs_rope_insert_piece(child, index, data, length, failed);
+    if (*failed) {
+        free(spare);
+        return NULL;
+    }
+    
+    if (!split) {
+        free(spare);
+        node->bytes += child->bytes - old_bytes;
+        node->chars += child->chars - old_chars;
+        node->lines += child->lines - old_lines;
+        return NULL;
+    }
+    
+    // 把分裂出的节点放在child之后
+    bs_rope_node* children[BS_ROPE_FANOUT + 1];
+    memcpy(children, inner->children, (i + 1) * sizeof(bs_rope_node*));
+    children[i + 1] = split;
+    memcpy(children + i + 2, inner->children + i + 1, (node->count - i - 1) * sizeof(bs_rope_node*));
+    unsigned total = node->count + 1;
+    
+    if (total <= BS_ROPE_FANOUT) {
+        memcpy(inner->children, children, total * sizeof(bs_rope_node*));
+        node->count = total;
+        bs_rope_inner_recount(inner);
+        return NULL;
+    }
+    
+    unsigned left = total / 2;
+    memcpy(inner->children, children, left * sizeof(bs_rope_node*));
+    memcpy(spare->children, children + left, (total - left) * sizeof(bs_rope_node*));
+    node->count = left;
+    spare->base.count = total - left;
+    bs_rope_inner_recount(inner);
+    bs_rope_inner_recount(spare);
+    return &spare->base;
+}
+
+// 插入一块文本，根节点分裂时树增高一层
+static bool bs_rope_insert_chunk(bs_rope* rope, size_t index, const uint8_t* data, size_t length) {
+    if (!rope->root) {
+        rope->root = bs_rope_build(data, length);
+        return rope->root != NULL;
+    }
+    
+    bs_rope_inner* new_root = NULL;
+    bool may_split = rope->root->is_leaf ? rope->root->bytes + length > BS_ROPE_LEAF_MAX
+                                         : rope->root->count == BS_ROPE_FANOUT;
+    if (may_split) {
+        new_root = bs_rope_inner_new();
+        if (!new_root) {
+            return false;
+        }
+    }
+    
+    bool failed = false;
+    bs_rope_node* split = bs_rope_insert_piece(rope->root, index, data, length, &failed);
+    if (failed) {
+        free(new_root);
+        return false;
+    }
+    if (!split) {
+        free(new_root);
+        return true;
+    }
+    
+    new_root->children[0] = rope->root;
+    new_root->children[1] = split;
+    new_root->base.count = 2;
+    bs_rope_inner_recount(new_root);
+    rope->root = &new_root->base;
+    return true;
+}
+
+bool bs_rope_insert(bs_rope* rope, size_t index, const char* data, size_t length) {
+    if (!rope || (!data && length > 0) || index > bs_rope_length(rope)) {
+        return false;
+    }
+    if (length == 0) {
+        return true;
+    }
+    
+    const uint8_t* bytes = (const uint8_t*)data;
+    if (!rope->root || length <= BS_ROPE_PIECE) {
+        return bs_rope_insert_chunk(rope, index, bytes, length);
+    }
+    
+    // 长文本按字符边界分段插入，失败时删除已经插入的部分
+    size_t pos = 0;
+    size_t inserted_chars = 0;
+    while (pos < length) {
+        size_t end = pos + BS_ROPE_PIECE;
+        if (end >= length) {
+            end = length;
+        } else {
+            size_t boundary = bs_utf8_boundary_before(bytes, end);
+            if (boundary > pos) {
+                end = boundary;
+            }
+        }
+        
+        if (!bs_rope_insert_chunk(rope, index + inserted_chars, bytes + pos, end - pos)) {
+            bs_rope_delete(rope, index, inserted_chars);
+            return false;
+        }
+        inserted_chars += utf8_strlen((const char*)bytes + pos, end - pos);
+        pos = end;
+    }
+    return true;
+}
+
+bool bs_rope_append(bs_rope* rope, const char* data, size_t length) {
+    return bs_rope_insert(rope, bs_rope_length(rope), data, length);
+}
+
+static bool bs_rope_node_underfull(const bs_rope_node* node) {
+    return node->is_leaf ? node->bytes < BS_ROPE_LEAF_MIN : node->count < BS_ROPE_INNER_MIN;
+}
+
+// 合并第i和第i+1个子节点，放不下时在两者之间平均分配
+// @return 合并成一个节点时返回true
+static bool bs_rope_merge_children(bs_rope_inner* parent, unsigned i) {
+    bs_rope_node* a = parent->children[i];
+    bs_rope_node* b = parent->children[i + 1];
+    bool merged;
+    
+    if (a->is_leaf) {
+        bs_rope_leaf* la = BS_ROPE_LEAF(a);
+        bs_rope_leaf* lb = BS_ROPE_LEAF(b);
+        if (a->bytes + b->bytes <= BS_ROPE_LEAF_MAX) {
+            memcpy(la->text + a->bytes, lb->text, b->bytes);
+            a->bytes += b->bytes;
+            a->chars += b->chars;
+            a->lines += b->lines;
+            free(b);
+            merged = true;
+        } else {
+            // 只有一方不足时才会走到这里，总量小于LEAF_MAX + LEAF_MIN
+            uint8_t buffer[BS_ROPE_LEAF_MAX + BS_ROPE_LEAF_MIN];
+            size_t total = a->bytes + b->bytes;
+            memcpy(buffer, la->text, a->bytes);
+            memcpy(buffer + a->bytes, lb->text, b->bytes);
+            size_t mid = bs_utf8_boundary_before(buffer, total / 2);
+            bs_rope_leaf_set(la, buffer, mid);
+            bs_rope_leaf_set(lb, buffer + mid, total - mid);
+            merged = false;
+        }
+    } else {
+        bs_rope_inner* ia = BS_ROPE_INNER(a);
+        bs_rope_inner* ib = BS_ROPE_INNER(b);
+        unsigned total = a->count + b->count;
+        if (total <= BS_ROPE_FANOUT) {
+            memcpy(ia->children + a->count, ib->children, b->count * sizeof(bs_rope_node*));
+            a->count = total;
+            bs_rope_inner_recount(ia);
+            free(b);
+            merged = true;
+        } else {
+            bs_rope_node* children[2 * BS_ROPE_FANOUT];
+            memcpy(children, ia->children, a->count * sizeof(bs_rope_node*));
+            memcpy(children + a->count, ib->children, b->count * sizeof(bs_rope_node*));
+            unsigned left = total / 2;
+            memcpy(ia->children, children, left * sizeof(bs_rope_node*));
+            memcpy(ib->children, children + left, (total - left) * sizeof(bs_rope_node*));
+            a->count = left;
+            b->count = total - left;
+            bs_rope_inner_recount(ia);
+            bs_rope_inner_recount(ib);
+            merged = false;
+        }
+    }
+    
+    if (merged) {
+        memmove(parent->children + i + 1, parent->children + i + 2,
+                (parent->base.count - i - 2) * sizeof(bs_rope_node*));
+        parent->base.count--;
+    }
+    return merged;
+}
+
+// 删除子树中[start, end)范围内的字符，调用者保证范围不覆盖整个子树
+static void bs_rope_delete_range(bs_rope_node* node, size_t start, size_t end) {
+    if (node->is_leaf) {
+        bs_rope_leaf* leaf = BS_ROPE_LEAF(node);
+        size_t from = bs_rope_leaf_byte_offset(leaf, start);
+        size_t to = bs_rope_leaf_byte_offset(leaf, end);
+        node->lines -= bs_count_newlines(leaf->text + from, to - from);
+        memmove(leaf->text + from, leaf->text + to, node->bytes - to);
+        node->bytes -= to - from;
+        node->chars -= end - start;
+        return;
+    }
+    
+    bs_rope_inner* inner = BS_ROPE_INNER(node);
+    unsigned kept = 0;
+    size_t offset = 0;
+    for (unsigned i = 0; i < node->count; i++) {
+        bs_rope_node* child = inner->children[i];
+        size_t child_start = offset;
+        size_t child_end = offset + child->chars;
+        offset = child_end;
+        
+        if (child_end <= start || child_start >= end) {
+            inner->children[kept++] = child;
+        } else if (start <= child_start && child_end <= end) {
+            bs_rope_node_free(child);
+        } else {
+            size_t local_start = start > child_start ? start - child_start : 0;
+            size_t local_end = (end < child_end ? end : child_end) - child_start;
+            bs_rope_delete_range(child, local_start, local_end);
+            inner->children[kept++] = child;
+        }
+    }
+    node->count = kept;
+    
+    // 删除后边界上的子节点可能过小，与相邻节点合并或重新分配
+    unsigned i = 0;
+    while (node->count > 1 && i < node->count) {
+        if (!bs_rope_node_underfull(inner->children[i])) {
+            i++;
+            continue;
+        }
+        unsigned left = i + 1 < node->count ? i : i - 1;
+        if (bs_rope_merge_children(inner, left)) {
+            i = left;
+        } else {
+            i++;
+        }
+    }
+    bs_rope_inner_recount(inner);
+}
+
+void bs_rope_delete(bs_rope* rope, size_t index, size_t count) {
+    if (!rope || !rope->root || count == 0) {
+        return;
+    }
+    
+    size_t length = rope->root->chars;
+    if (index >= length) {
+        return;
+    }
+    size_t end = count > length - index ? length : index + count;
+    
+    if (index == 0 && end == length) {
+        bs_rope_node_free(rope->root);
+        rope->root = NULL;
+        return;
+    }
+    
+    bs_rope_delete_range(rope->root, index, end);
+    
+    // 只剩一个子节点的根降低一层
+    while (!rope->root->is_leaf && rope->root->count == 1) {
+        bs_rope_node* child = BS_ROPE_INNER(rope->root)->children[0];
+        free(rope->root);
+        rope->root = child;
+    }
+}
+
+// 找到包含第index个字符的叶子，*local返回叶子内的字符位置
+static const bs_rope_leaf* bs_rope_find_leaf(const bs_rope_node* node, size_t index, size_t* local) {
+    while (!node->is_leaf) {
+        const bs_rope_inner* inner = (const bs_rope_inner*)node;
+        unsigned i = 0;
+        while (i + 1 < node->count && index >= inner->children[i]->chars) {
+            index -= inner->children[i]->chars;
+            i++;
+        }
+        node = inner->children[i];
+    }
+    *local = index;
+    return (const bs_rope_leaf*)node;
+}
+
+uint32_t bs_rope_char_at(const bs_rope* rope, size_t index) {
+    if (index >= bs_rope_length(rope)) {
+        return 0;
+    }
+    size_t local;
+    const bs_rope_leaf* leaf = bs_rope_find_leaf(rope->root, index, &local);
+    return utf8_decode_char(leaf->text + bs_rope_leaf_byte_offset(leaf, local));
+}
+
+// 第index个字符之前的字节数
+static size_t bs_rope_char_to_byte(const bs_rope_node* node, size_t index) {
+    size_t bytes = 0;
+    while (!node->is_leaf) {
+        const bs_rope_inner* inner = (const bs_rope_inner*)node;
+        unsigned i = 0;
+        while (i + 1 < node->count && index >= inner->children[i]->chars) {
+            index -= inner->children[i]->chars;
+            bytes += inner->children[i]->bytes;
+            i++;
+        }
+        node = inner->children[i];
+    }
+    return bytes + bs_rope_leaf_byte_offset((const bs_rope_leaf*)node, index);
+}
+
+// 复制字节范围[from, to)
+static void bs_rope_copy_bytes(const bs_rope_node* node, size_t from, size_t to, uint8_t* out) {
+    if (node->is_leaf) {
+        memcpy(out, ((const bs_rope_leaf*)node)->text + from, to - from);
+        return;
+    }
+    
+    const bs_rope_inner* inner = (const bs_rope_inner*)node;
+    size_t offset = 0;
+    for (unsigned i = 0; i < node->count && offset < to; i++) {
+        const bs_rope_node* child = inner->children[i];
+        size_t child_end = offset + child->bytes;
+        if (child_end > from) {
+            size_t local_from = from > offset ? from - offset : 0;
+            size_t local_to = (to < child_end ? to : child_end) - offset;
+            bs_rope_copy_bytes(child, local_from, local_to, out);
+            out += local_to - local_from;
+        }
+        offset = child_end;
+    }
+}
+
+bs_string* bs_rope_substring(const bs_rope* rope, size_t start, size_t length) {
+    if (!rope) {
+        return NULL;
+    }
+    
+    size_t total = bs_rope_length(rope);
+    if (start > total) {
+        start = total;
+    }
+    if (length > total - start) {
+        length = total - start;
+    }
+    
+    size_t from = 0;
+    size_t to = 0;
+    if (length > 0) {
+        from = bs_rope_char_to_byte(rope->root, start);
+        to = bs_rope_char_to_byte(rope->root, start + length);
+    }
+    
+    bs_string* result = bs_string_alloc(to - from, BS_ENCODING_UTF8);
+    if (!result) {
+        return NULL;
+    }
+    if (to > from) {
+        bs_rope_copy_bytes(rope->root, from, to, result->data);
+    }
+    result->length = length;
+    return result;
+}
+
+bs_string* bs_rope_to_string(const bs_rope* rope) {
+    return bs_rope_substring(rope, 0, bs_rope_length(rope));
+}
+
+size_t bs_rope_line_to_char(const bs_rope* rope, size_t line) {
+    if (line == 0 || !rope || !rope->root) {
+        return 0;
+    }
+    if (line > rope->root->lines) {
+        return rope->root->chars;
+    }
+    
+    // 找到第line个换行符，返回它之后的位置
+    const bs_rope_node* node = rope->root;
+    size_t chars = 0;
+    while (!node->is_leaf) {
+        const bs_rope_inner* inner = (const bs_rope_inner*)node;
+        unsigned i = 0;
+        while (i + 1 < node->count && line > inner->children[i]->lines) {
+            line -= inner->children[i]->lines;
+            chars += inner->children[i]->chars;
+            i++;
+        }
+        node = inner->children[i];
+    }
+    
+    const bs_rope_leaf* leaf = (const bs_rope_leaf*)node;
+    for (size_t pos = 0; pos < node->bytes; pos++) {
+        uint8_t byte = leaf->text[pos];
+        chars += (byte & 0xC0) != 0x80;
+        if (byte == '\n' && --line == 0) {
+            break;
+        }
+    }
+    return chars;
+}
+
+size_t bs_rope_char_to_line(const bs_rope* rope, size_t index) {
+    if (!rope || !rope->root) {
+        return 0;
+    }
+    if (index >= rope->root->chars) {
+        return rope->root->lines;
+    }
+    
+    const bs_rope_node* node = rope->root;
+    size_t lines = 0;
+    while (!node->is_leaf) {
+        const bs_rope_inner* inner = (const bs_rope_inner*)node;
+        unsigned i = 0;
+        while (i + 1 < node->count && index >= inner->children[i]->chars) {
+            index -= inner->children[i]->chars;
+            lines += inner->children[i]->lines;
+            i++;
+        }
+        node = inner->children[i];
+    }
+    
+    const bs_rope_leaf* leaf = (const bs_rope_leaf*)node;
+    size_t offset = bs_rope_leaf_byte_offset(leaf, index);
+    return lines + bs_count_newlines(leaf->text, offset);
+}
+
+// 从path[depth]开始向下走到最左边的叶子
+static void bs_rope_iter_descend(bs_rope_iter* it) {
+    while (!it->path[it->depth]->is_leaf && it->depth + 1 < BS_ROPE_MAX_DEPTH) {
+        const bs_rope_inner* inner = (const bs_rope_inner*)it->path[it->depth];
+        it->child[it->depth] = 0;
+        it->path[it->depth + 1] = inner->children[0];
+        it->depth++;
+    }
+}
+
+void bs_rope_iter_init(bs_rope_iter* it, const bs_rope* rope) {
+    if (!it) {
+        return;
+    }
+    if (!rope || !rope->root) {
+        it->depth = -1;
+        return;
+    }
+    it->path[0] = rope->root;
+    it->depth = 0;
+    bs_rope_iter_descend(it);
+}
+
+bool bs_rope_iter_next(bs_rope_iter* it, bs_string* chunk) {
+    if (!it || it->depth < 0) {
+        return false;
+    }
+    
+    const bs_rope_node* node = it->path[it->depth];
+    if (chunk) {
+        chunk->data = (uint8_t*)((const bs_rope_leaf*)node)->text;
+        chunk->byte_length = node->bytes;
+        chunk->length = node->chars;
+        chunk->encoding = BS_ENCODING_UTF8;
+        chunk->is_view = true;
+        chunk->hash_cached = false;
+        chunk->hash = 0;
+    }
+    
+    // 回到还有下一个子节点的祖先，再走到它的最左叶子
+    it->depth--;
+    while (it->depth >= 0) {
+        const bs_rope_inner* inner = (const bs_rope_inner*)it->path[it->depth];
+        if (++it->child[it->depth] < inner->base.count) {
+            it->path[it->depth + 1] = inner->children[it->child[it->depth]];
+            it->depth++;
+            bs_rope_iter_descend(it);
+            break;
+        }
+        it->depth--;
+    }
+    return true;
+}
+
+// 字符串哈希实现（wyhash）
+
+static const uint64_t bs_hash_secret[4] = {
+    0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL
+};
+
+static inline uint64_t bs_hash_mix(uint64_t a, uint64_t b) {
+    bs_u128 product = bs_mul64(a, b);
+    return product.hi ^ product.lo;
+}
+
+static inline uint64_t bs_load_u32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint64_t bs_hash_bytes(const void* key, size_t length, uint64_t seed) {
+    const uint8_t* p = (const uint8_t*)key;
+    const uint64_t* secret = bs_hash_secret;
+    uint64_t a;
+    uint64_t b;
+    
+    seed ^= bs_hash_mix(seed ^ secret[0], secret[1]);
+    if (length <= 16) {
+        if (length >= 4) {
+            size_t shift = (length >> 3) << 2;
+            a = (bs_load_u32(p) << 32) | bs_load_u32(p + shift);
+            b = (bs_load_u32(p + length - 4) << 32) | bs_load_u32(p + length - 4 - shift);
+        } else if (length > 0) {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[length >> 1] << 8) | p[length - 1];
+            b = 0;
+        } else {
+            a = 0;
+            b = 0;
+        }
+    } else {
+        size_t i = length;
+        if (i > 48) {
+            // 三路独立的乘法链，充分利用指令级并行
+            uint64_t see1 = seed;
+            uint64_t see2 = seed;
+            do {
+                seed = bs_hash_mix(bs_load_u64(p) ^ secret[1], bs_load_u64(p + 8) ^ seed);
+                see1 = bs_hash_mix(bs_load_u64(p + 16) ^ secret[2], bs_load_u64(p + 24) ^ see1);
+                see2 = bs_hash_mix(bs_load_u64(p + 32) ^ secret[3], bs_load_u64(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = bs_hash_mix(bs_load_u64(p) ^ secret[1], bs_load_u64(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = bs_load_u64(p + i - 16);
+        b = bs_load_u64(p + i - 8);
+    }
+    
+    a ^= secret[1];
+    b ^= seed;
+    bs_u128 product = bs_mul64(a, b);
+    return bs_hash_mix(product.lo ^ secret[0] ^ length, product.hi ^ secret[1]);
+}
+
+// 字符串驻留表实现
+
+#define BS_INTERN_SHARD_BITS 6
+#define BS_INTERN_SHARDS (1u << BS_INTERN_SHARD_BITS)
+#define BS_INTERN_MIN_BUCKETS 64
+
+#if defined(_WIN32)
+typedef SRWLOCK bs_rwlock;
+#define bs_rwlock_read(lock) AcquireSRWLockShared(lock)
+#define bs_rwlock_read_unlock(lock) ReleaseSRWLockShared(lock)
+#define bs_rwlock_write(lock) AcquireSRWLockExclusive(lock)
+#define bs_rwlock_write_unlock(lock) ReleaseSRWLockExclusive(lock)
+#else
+typedef pthread_rwlock_t bs_rwlock;
+#define bs_rwlock_read(lock) pthread_rwlock_rdlock(lock)
+#define bs_rwlock_read_unlock(lock) pthread_rwlock_unlock(lock)
+#define bs_rwlock_write(lock) pthread_rwlock_wrlock(lock)
+#define bs_rwlock_write_unlock(lock) pthread_rwlock_unlock(lock)
+#endif
+
+typedef struct bs_intern_entry {
+    bs_string str;                  // 必须是第一个成员，返回给调用者的就是它
+    uint64_t hash;
+    size_t refs;                    // bs_intern_acquire持有的引用数
+    bool permanent;                 // 被bs_intern驻留过，不会删除
+    struct bs_intern_entry* next;
+} bs_intern_entry;
+
+typedef struct {
+    bs_rwlock lock;
+    bs_intern_entry** buckets;
+    size_t bucket_count;            // 2的幂
+    size_t count;
+} bs_intern_shard;
+
+static bs_intern_shard bs_intern_shards[BS_INTERN_SHARDS];
+
+#if defined(_WIN32)
+// 全零的SRWLOCK就是已初始化的状态
+static void bs_intern_init(void) {}
+#else
+static pthread_once_t bs_intern_once = PTHREAD_ONCE_INIT;
+
+static void bs_intern_init_locks(void) {
+    for (unsigned i = 0; i < BS_INTERN_SHARDS; i++) {
+        pthread_rwlock_init(&bs_intern_shards[i].lock, NULL);
+    }
+}
+
+static void bs_intern_init(void) {
+    pthread_once(&bs_intern_once, bs_intern_init_locks);
+}
+#endif
+
+static bs_intern_shard* bs_intern_shard_for(uint64_t hash) {
+    // 高位选分片，低位选桶
+    return &bs_intern_shards[hash >> (64 - BS_INTERN_SHARD_BITS)];
+}
+
+static bs_intern_entry* bs_intern_lookup(const bs_intern_shard* shard, const uint8_t* data, size_t length,
+                                         uint64_t hash) {
+    if (shard->bucket_count == 0) {
+        return NULL;
+    }
+    bs_intern_entry* entry = shard->buckets[hash & (shard->bucket_count - 1)];
+    while (entry) {
+        if (entry->hash == hash && entry->str.byte_length == length &&
+            memcmp(entry->str.data, data, length) == 0) {
+            return entry;
+        }
+        entry = entry->next;
+    }
+    return NULL;
+}
+
+// 在已持有写锁的分片中插入新条目
+static bs_intern_entry* bs_intern_insert(bs_intern_shard* shard, const uint8_t* data, size_t length,
+                                         uint64_t hash) {
+    if (shard->count >= shard->bucket_count) {
+        size_t new_count = shard->bucket_count ? shard->bucket_count * 2 : BS_INTERN_MIN_BUCKETS;
+        bs_intern_entry** buckets = (bs_intern_entry**)calloc(new_count, sizeof(bs_intern_entry*));
+        if (buckets) {
+            for (size_t i = 0; i < shard->bucket_count; i++) {
+                bs_intern_entry* entry = shard->buckets[i];
+                while (entry) {
+                    bs_intern_entry* next = entry->next;
+                    size_t index = entry->hash & (new_count - 1);
+                    entry->next = buckets[index];
+                    buckets[index] = entry;
+                    entry = next;
+                }
+            }
+            free(shard->buckets);
+            shard->buckets = buckets;
+            shard->bucket_count = new_count;
+        } else if (shard->bucket_count == 0) {
+            return NULL;
+        }
+    }
+    
+    // 条目和字符串内容一次分配
+    bs_intern_entry* entry = (bs_intern_entry*)malloc(sizeof(bs_intern_entry) + length + 1);
+    if (!entry) {
+        return NULL;
+    }
+    uint8_t* text = (uint8_t*)(entry + 1);
+    memcpy(text, data, length);
+    text[length] = '\0';
+    
+    entry->str.data = text;
+    entry->str.length = utf8_strlen((const char*)text, length);
+    entry->str.byte_length = length;
+    entry->str.encoding = BS_ENCODING_UTF8;
+    entry->str.is_view = true;
+    entry->str.hash_cached = true;
+    entry->str.hash = hash;
+    entry->hash = hash;
+    entry->refs = 0;
+    entry->permanent = false;
+    
+    size_t index = hash & (shard->bucket_count - 1);
+    entry->next = shard->buckets[index];
+    shard->buckets[index] = entry;
+    shard->count++;
+    return entry;
+}
+
+const bs_string* bs_intern(const char* data, size_t length) {
+    if (!data && length > 0) {
+        return NULL;
+    }
+    
+    bs_intern_init();
+    const uint8_t* bytes = length > 0 ? (const uint8_t*)data : (const uint8_t*)"";
+    uint64_t hash = bs_hash(bytes, length, 0);
+    bs_intern_shard* shard = bs_intern_shard_for(hash);
+    
+    // 已经永久驻留的字符串只需要读锁
+    bs_rwlock_read(&shard->lock);
+    bs_intern_entry* entry = bs_intern_lookup(shard, bytes, length, hash);
+    bool done = entry && entry->permanent;
+    bs_rwlock_read_unlock(&shard->lock);
+    if (done) {
+        return &entry->str;
+    }
+    
+    bs_rwlock_write(&shard->lock);
+    entry = bs_intern_lookup(shard, bytes, length, hash);
+    if (!entry) {
+        entry = bs_intern_insert(shard, bytes, length, hash);
+    }
+    if (entry) {
+        entry->permanent = true;
+    }
+    bs_rwlock_write_unlock(&shard->lock);
+    return entry ? &entry->str : NULL;
+}
+
+const bs_string* bs_intern_cstr(const char* str) {
+    return str ? bs_intern(str, strlen(str)) : NULL;
+}
+
+const bs_string* bs_intern_string(const bs_string* str) {
+    return str ? bs_intern((const char*)str->data, str->byte_length) : NULL;
+}
+
+const bs_string* bs_intern_acquire(const char* data, size_t length) {
+    if (!data && length > 0) {
+        return NULL;
+    }
+    
+    bs_intern_init();
+    const uint8_t* bytes = length > 0 ? (const uint8_t*)data : (const uint8_t*)"";
+    uint64_t hash = bs_hash(bytes, length, 0);
+    bs_intern_shard* shard = bs_intern_shard_for(hash);
+    
+    bs_rwlock_write(&shard->lock);
+    bs_intern_entry* entry = bs_intern_lookup(shard, bytes, length, hash);
+    if (!entry) {
+        entry = bs_intern_insert(shard, bytes, length, hash);
+    }
+    if (entry) {
+        entry->refs++;
+    }
+    bs_rwlock_write_unlock(&shard->lock);
+    return entry ? &entry->str : NULL;
+}
+
+void bs_intern_release(const bs_string* interned) {
+    if (!interned) {
+        return;
+    }
+    
+    bs_intern_entry* entry = (bs_intern_entry*)interned;
+    bs_intern_shard* shard = bs_intern_shard_for(entry->hash);
+    
+    bs_rwlock_write(&shard->lock);
+    if (entry->refs > 0 && --entry->refs == 0 && !entry->permanent) {
+        bs_intern_entry** link = &shard->buckets[entry->hash & (shard->bucket_count - 1)];
+        while (*link != entry) {
+            link = &(*link)->next;
+        }
+        *link = entry->next;
+        shard->count--;
+        free(entry);
+    }
+    bs_rwlock_write_unlock(&shard->lock);
+}
+
+uint64_t bs_intern_hash(const bs_string* interned) {
+    return interned ? ((const bs_intern_entry*)interned)->hash : 0;
+}
+
+size_t bs_intern_count(void) {
+    bs_intern_init();
+    size_t total = 0;
+    for (unsigned i = 0; i < BS_INTERN_SHARDS; i++) {
+        bs_rwlock_read(&bs_intern_shards[i].lock);
+        total += bs_intern_shards[i].count;
+        bs_rwlock_read_unlock(&bs_intern_shards[i].lock);
+    }
+    return total;
+}
+
+// 公开的哈希接口
+
+uint64_t bs_hash(const void* data, size_t length, uint64_t seed) {
+    if (!data) {
+        length = 0;
+        data = "";
+    }
+    return bs_hash_bytes(data, length, seed);
+}
+
+uint64_t bs_string_hash(const bs_string* str) {
+    if (!str) {
+        return bs_hash(NULL, 0, 0);
+    }
+    uint64_t hash;
+    if (bs_hash_cache_get(str, &hash)) {
+        return hash;
+    }
+    
+    // 结果缓存在字符串里，内容修改时失效
+    hash = bs_hash(str->data, str->byte_length, 0);
+    bs_hash_cache_set(str, hash);
+    return hash;
+}
+
+uint64_t bs_string_hash_seeded(const bs_string* str, uint64_t seed) {
+    if (!str) {
+        return bs_hash(NULL, 0, seed);
+    }
+    return bs_hash(str->data, str->byte_length, seed);
+}
+
+// 原地修改
+
+// 从字节位置pos开始前进chars个字符
+static size_t bs_utf8_advance(const uint8_t* data, size_t byte_length, size_t pos, size_t chars) {
+    while (chars > 0 && pos < byte_length) {
+        pos += utf8_char_size(data + pos);
+        chars--;
+    }
+    return pos < byte_length ? pos : byte_length;
+}
+
+// 把字节区间[from, to)替换为data
+// 拥有内存的字符串原地修改并返回自身；视图不拥有内存，返回新的字符串
+// 内存不足时返回原字符串，内容不变
+static bs_string* bs_string_splice(bs_string* str, size_t from, size_t to, const uint8_t* data, size_t length) {
+    size_t removed = to - from;
+    size_t new_length = str->byte_length - removed + length;
+    size_t new_chars = bs_char_length(str) - utf8_strlen((const char*)str->data + from, removed) +
+                       utf8_strlen((const char*)data, length);
+    
+    if (str->is_view) {
+        bs_string* result = bs_string_alloc(new_length, BS_ENCODING_UTF8);
+        if (!result) {
+            return str;
+        }
+        memcpy(result->data, str->data, from);
+        if (length > 0) {
+            memcpy(result->data + from, data, length);
+        }
+        memcpy(result->data + from + length, str->data + to, str->byte_length - to);
+        result->length = new_chars;
+        return result;
+    }
+    
+    // 插入的内容可能来自str自身，扩容前先复制出来
+    uint8_t* copy = NULL;
+    uintptr_t begin = (uintptr_t)str->data;
+    if (length > 0 && (uintptr_t)data >= begin && (uintptr_t)data <= begin + str->byte_length) {
+        copy = (uint8_t*)malloc(length);
+        if (!copy) {
+            return str;
+        }
+        memcpy(copy, data, length);
+        data = copy;
+    }
+    
+    if (new_length > str->byte_length) {
+        uint8_t* grown = (uint8_t*)realloc(str->data, new_length + 1);
+        if (!grown) {
+            free(copy);
+            return str;
+        }
+        str->data = grown;
+    }
+    
+    memmove(str->data + from + length, str->data + to, str->byte_length - to);
+    if (length > 0) {
+        memcpy(str->data + from, data, length);
+    }
+    str->data[new_length] = '\0';
+    str->byte_length = new_length;
+    str->length = new_chars;
+    str->hash_cached = false;
+    
+    free(copy);
+    return str;
+}
+
+bs_string* bs_string_insert(bs_string* str, size_t position, const bs_string* insert) {
+    if (!str) {
+        return insert ? bs_string_copy(insert) : NULL;
+    }
+    if (!insert || insert->byte_length == 0) {
+        return str;
+    }
+    
+    size_t offset = bs_utf8_advance(str->data, str->byte_length, 0, position);
+    return bs_string_splice(str, offset, offset, insert->data, insert->byte_length);
+}
+
+bs_string* bs_string_delete(bs_string* str, size_t start, size_t length) {
+    if (!str || length == 0 || start >= bs_char_length(str)) {
+        return str;
+    }
+    
+    size_t from = bs_utf8_advance(str->data, str->byte_length, 0, start);
+    size_t to = bs_utf8_advance(str->data, str->byte_length, from, length);
+    return bs_string_splice(str, from, to, NULL, 0);
+}
+
+bs_string* bs_string_replace(bs_string* str, const bs_string* find, const bs_string* replace) {
+    if (!str || !find || find->byte_length == 0) {
+        return str;
+    }
+    
+    size_t pos = bs_find_bytes(str->data, str->byte_length, find->data, find->byte_length);
+    if (pos == str->byte_length) {
+        return str;
+    }
+    
+    const uint8_t* data = replace ? replace->data : NULL;
+    size_t length = replace ? replace->byte_length : 0;
+    return bs_string_splice(str, pos, pos + find->byte_length, data, length);
+}
+
+// 字符串比较
+// 返回a和b前length字节中第一个不同字节的下标，全部相同时返回length
+// SSE2下每次比较64字节，四组比较结果拼成64位掩码，不足64字节的部分用重叠读取补齐，
+// 不同字节出现在哪一组都只有一次分支；其余情况每次比较8字节，异或结果的最低非零字节就是第一个不同的位置
+#ifdef BS_HAVE_SSE2
+static inline uint64_t bs_mismatch_mask16(const uint8_t* a, const uint8_t* b) {
+    __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)a), _mm_loadu_si128((const __m128i*)b));
+    return (uint64_t)((unsigned)_mm_movemask_epi8(eq) ^ 0xFFFFu);
+}
+
+static inline uint64_t bs_mismatch_mask64(const uint8_t* a, const uint8_t* b) {
+    return bs_mismatch_mask16(a, b) | bs_mismatch_mask16(a + 16, b + 16) << 16 |
+           bs_mismatch_mask16(a + 32, b + 32) << 32 | bs_mismatch_mask16(a + 48, b + 48) << 48;
+}
+#endif
+
+static size_t bs_mismatch(const uint8_t* a, const uint8_t* b, size_t length) {
+    size_t i = 0;
+#ifdef BS_HAVE_SSE2
+    uint64_t mask;
+    if (length >= 64) {
+        for (; i + 64 <= length; i += 64) {
+            mask = bs_mismatch_mask64(a + i, b + i);
+            if (mask) {
+                return i + bs_ctz64(mask);
+            }
+        }
+        if (i == length) {
+            return length;
+        }
+        // 最后一块与前一块重叠，重叠部分已知相同，不影响结果
+        i = length - 64;
+        mask = bs_mismatch_mask64(a + i, b + i);
+        return mask ? i + bs_ctz64(mask) : length;
+    }
+    if (length >= 16) {
+        size_t last = length - 16;
+        size_t second = last < 16 ? last : 16;
+        size_t third = last < 32 ? last : 32;
+        mask = bs_mismatch_mask16(a, b) | bs_mismatch_mask16(a + second, b + second) << second |
+               bs_mismatch_mask16(a + third, b + third) << third | bs_mismatch_mask16(a + last, b + last) << last;
+        return mask ? bs_ctz64(mask) : length;
+    }
+#endif
+    for (; i + 8 <= length; i += 8) {
+        uint64_t diff = bs_load_u64(a + i) ^ bs_load_u64(b + i);
+        if (diff) {
+#ifdef BS_BIG_ENDIAN
+            return i + bs_clz64(diff) / 8;
+#else
+            return i + bs_ctz64(diff) / 8;
+#endif
+        }
+    }
+    for (; i < length; i++) {
+        if (a[i] != b[i]) {
+            return i;
+        }
+    }
+    return length;
+}
+
+// 只判断是否相等：不需要定位，所有块的异或结果合并后一次判断，首尾两次读取覆盖不足一块的部分
+static bool bs_bytes_equal(const uint8_t* a, const uint8_t* b, size_t length) {
+#ifdef BS_HAVE_SSE2
+    if (length >= 16) {
+        const uint8_t* a_last = a + length - 16;
+        const uint8_t* b_last = b + length - 16;
+        __m128i diff = _mm_xor_si128(_mm_loadu_si128((const __m128i*)a_last), _mm_loadu_si128((const __m128i*)b_last));
+        for (size_t i = 0; i + 16 < length; i += 16) {
+            diff = _mm_or_si128(diff, _mm_xor_si128(_mm_loadu_si128((const __m128i*)(a + i)),
+                                                    _mm_loadu_si128((const __m128i*)(b + i))));
+        }
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) == 0xFFFF;
+    }
+#endif
+    if (length >= 8) {
+        uint64_t diff = bs_load_u64(a + length - 8) ^ bs_load_u64(b + length - 8);
+        for (size_t i = 0; i + 8 < length; i += 8) {
+            diff |= bs_load_u64(a + i) ^ bs_load_u64(b + i);
+        }
+        return diff == 0;
+    }
+    if (length >= 4) {
+        uint32_t x, y, u, v;
+        memcpy(&x, a, 4);
+        memcpy(&y, b, 4);
+        memcpy(&u, a + length - 4, 4);
+        memcpy(&v, b + length - 4, 4);
+        return ((x ^ y) | (u ^ v)) == 0;
+    }
+    for (size_t i = 0; i < length; i++) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * 按码点顺序比较，NULL小于任何字符串
+ * UTF-8按无符号字节比较的结果与按码点比较相同，不需要解码
+ */
+int bs_string_compare(const bs_string* str1, const bs_string* str2) {
+    if (str1 == str2) {
+        return 0;
+    }
+    if (!str1 || !str2) {
+        return str1 ? 1 : -1;
+    }
+    
+    size_t length = str1->byte_length < str2->byte_length ? str1->byte_length : str2->byte_length;
+    size_t pos = bs_mismatch(str1->data, str2->data, length);
+    if (pos < length) {
+        return str1->data[pos] < str2->data[pos] ? -1 : 1;
+    }
+    if (str1->byte_length == str2->byte_length) {
+        return 0;
+    }
+    return str1->byte_length < str2->byte_length ? -1 : 1;
+}
+
+bool bs_string_equals(const bs_string* str1, const bs_string* str2) {
+    if (str1 == str2) {
+        return true;
+    }
+    if (!str1 || !str2 || str1->byte_length != str2->byte_length) {
+        return false;
+    }
+    // 两边都缓存了哈希时，哈希不同就一定不相等，不用比较内容
+    uint64_t hash1, hash2;
+    if (bs_hash_cache_get(str1, &hash1) && bs_hash_cache_get(str2, &hash2) && hash1 != hash2) {
+        return false;
+    }
+    return bs_bytes_equal(str1->data, str2->data, str1->byte_length);
+}
+
+/**
+ * 只忽略ASCII字母的大小写，与bs_string_to_lower一致，其他字节必须完全相同
+ */
+bool bs_string_equals_ignore_case(const bs_string* str1, const bs_string* str2) {
+    if (str1 == str2) {
+        return true;
+    }
+    if (!str1 || !str2 || str1->byte_length != str2->byte_length) {
+        return false;
+    }
+    
+    const uint8_t* a = str1->data;
+    const uint8_t* b = str2->data;
+    size_t length = str1->byte_length;
+    size_t i = 0;
+    while (i < length) {
+        // 跳过完全相同的部分，只在不同的字节处检查大小写
+        i += bs_mismatch(a + i, b + i, length - i);
+        if (i == length) {
+            break;
+        }
+        uint8_t x = a[i] | 0x20;
+        if (x != (b[i] | 0x20) || x < 'a' || x > 'z') {
+            return false;
+        }
+        i++;
+    }
+    return true;
+}
+
+bool bs_string_starts_with(const bs_string* str, const bs_string* prefix) {
+    if (!str || !prefix || prefix->byte_length > str->byte_length) {
+        return false;
+    }
+    return bs_bytes_equal(str->data, prefix->data, prefix->byte_length);
+}
+
+bool bs_string_ends_with(const bs_string* str, const bs_string* suffix) {
+    if (!str || !suffix || suffix->byte_length > str->byte_length) {
         return false;
     }
+    const uint8_t* tail = str->data + (str->byte_length - suffix->byte_length);
+    return bs_bytes_equal(tail, suffix->data, suffix->byte_length);
+}
+
+// 并行执行
+#if defined(_WIN32)
+typedef HANDLE bs_thread;
+#else
+typedef pthread_t bs_thread;
+#endif
+
+typedef struct bs_parallel_task {
+    void (*fn)(void* ctx, size_t index);
+    void* ctx;
+    size_t index;
+    bs_thread thread;
+    bool started;
+} bs_parallel_task;
+
+#if defined(_WIN32)
+static DWORD WINAPI bs_parallel_entry(LPVOID arg) {
+    bs_parallel_task* task = (bs_parallel_task*)arg;
+    task->fn(task->ctx, task->index);
+    return 0;
+}
+#else
+static void* bs_parallel_entry(void* arg) {
+    bs_parallel_task* task = (bs_parallel_task*)arg;
+    task->fn(task->ctx, task->index);
+    return NULL;
+}
+#endif
+
+static size_t bs_cpu_count(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+#else
+    return 1;
+#endif
+}
+
+static inline size_t bs_atomic_fetch_add(volatile size_t* value, size_t delta) {
+#if defined(_MSC_VER) && defined(_WIN64)
+    return (size_t)InterlockedExchangeAdd64((volatile LONG64*)value, (LONG64)delta);
+#elif defined(_MSC_VER)
+    return (size_t)InterlockedExchangeAdd((volatile LONG*)value, (LONG)delta);
+#else
+    return __atomic_fetch_add(value, delta, __ATOMIC_RELAXED);
+#endif
+}
+
+// 在count个线程上执行fn(ctx, 0)到fn(ctx, count - 1)，当前线程执行第0个
+// 线程创建失败时剩下的任务由当前线程依次执行，结果不变
+static void bs_run_parallel(size_t count, void (*fn)(void* ctx, size_t index), void* ctx) {
+    bs_parallel_task* tasks = count > 1 ? (bs_parallel_task*)calloc(count, sizeof(bs_parallel_task)) : NULL;
+    if (!tasks) {
+        for (size_t i = 0; i < count; i++) {
+            fn(ctx, i);
+        }
+        return;
+    }
+    
+    for (size_t i = 1; i < count; i++) {
+        tasks[i].fn = fn;
+        tasks[i].ctx = ctx;
+        tasks[i].index = i;
+#if defined(_WIN32)
+        tasks[i].thread = CreateThread(NULL, 0, bs_parallel_entry, &tasks[i], 0, NULL);
+        tasks[i].started = tasks[i].thread != NULL;
+#else
+        tasks[i].started = pthread_create(&tasks[i].thread, NULL, bs_parallel_entry, &tasks[i]) == 0;
+#endif
+    }
+    fn(ctx, 0);
+    for (size_t i = 1; i < count; i++) {
+        if (!tasks[i].started) {
+            fn(ctx, i);
+            continue;
+        }
+#if defined(_WIN32)
+        WaitForSingleObject(tasks[i].thread, INFINITE);
+        CloseHandle(tasks[i].thread);
+#else
+        pthread_join(tasks[i].thread, NULL);
+#endif
+    }
+    free(tasks);
+}
+
+// 字符串数组排序
+// 排序键：depth起的7个字节按大端序放在高56位，最低字节是剩余字节数（7以上记为8）。
+// 整数比较的结果与从depth开始逐字节比较一致：补0后相同时较短的字符串是前缀，排在前面；
+// 键相同且剩余字节数小于8时两个字符串完全相同
+#define BS_SORT_STEP 7
+#define BS_SORT_INSERTION_THRESHOLD 16
+#define BS_SORT_PARALLEL_MIN 65536
+
+typedef struct bs_sort_item {
+    uint64_t key;
+    bs_string* str;
+} bs_sort_item;
+
+static inline uint64_t bs_load_u64_be(const uint8_t* p) {
+    uint64_t value = bs_load_u64(p);
+#if defined(BS_BIG_ENDIAN)
+    return value;
+#elif defined(_MSC_VER)
+    return _byteswap_uint64(value);
+#else
+    return __builtin_bswap64(value);
+#endif
+}
+
+static inline uint64_t bs_sort_key(const bs_string* str, size_t depth) {
+    if (str->byte_length >= depth + 8) {
+        return (bs_load_u64_be(str->data + depth) & ~(uint64_t)0xFF) | 8;
+    }
+    size_t remaining = str->byte_length > depth ? str->byte_length - depth : 0;
+    uint64_t key = remaining;
+    for (size_t i = 0; i < remaining; i++) {
+        key |= (uint64_t)str->data[depth + i] << (56 - 8 * i);
+    }
+    return key;
+}
+
+// 两个元素的键都取自depth，键相同时从depth + 7继续比较剩下的字节
+static int bs_sort_compare_items(const bs_sort_item* a, const bs_sort_item* b, size_t depth) {
+    if (a->key != b->key) {
+        return a->key < b->key ? -1 : 1;
+    }
+    if ((a->key & 0xFF) < 8) {
+        return 0;
+    }
+    size_t start = depth + BS_SORT_STEP;
+    size_t length_a = a->str->byte_length - start;
+    size_t length_b = b->str->byte_length - start;
+    size_t length = length_a < length_b ? length_a : length_b;
+    size_t pos = bs_mismatch(a->str->data + start, b->str->data + start, length);
+    if (pos < length) {
+        return a->str->data[start + pos] < b->str->data[start + pos] ? -1 : 1;
+    }
+    return length_a < length_b ? -1 : (length_a > length_b);
+}
+
+static void bs_sort_insertion(bs_sort_item* items, size_t count, size_t depth) {
+    for (size_t i = 1; i < count; i++) {
+        bs_sort_item item = items[i];
+        size_t j = i;
+        while (j > 0 && bs_sort_compare_items(&item, &items[j - 1], depth) < 0) {
+            items[j] = items[j - 1];
+            j--;
+        }
+        items[j] = item;
+    }
+}
+
+static inline uint64_t bs_sort_median3(uint64_t a, uint64_t b, uint64_t c) {
+    if (a < b) {
+        return b < c ? b : (a < c ? c : a);
+    }
+    return a < c ? a : (b < c ? c : b);
+}
+
+static inline void bs_sort_swap(bs_sort_item* a, bs_sort_item* b) {
+    bs_sort_item temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+static void bs_sort_items(bs_sort_item* items, size_t count, size_t depth);
+
+// 键全部相同且字符串还有剩余的一组，取下一层的键继续排序
+static void bs_sort_next_depth(bs_sort_item* items, size_t count, size_t depth) {
+    depth += BS_SORT_STEP;
+    for (size_t i = 0; i < count; i++) {
+        items[i].key = bs_sort_key(items[i].str, depth);
+    }
+    bs_sort_items(items, count, depth);
+}
+
+// 多关键字快速排序：按当前层的键三路划分，小于和大于的部分在同一层继续，
+// 等于的部分进入下一层。递归处理较小的部分，循环处理最大的部分，栈深度为O(log n)
+static void bs_sort_items(bs_sort_item* items, size_t count, size_t depth) {
+    while (count > BS_SORT_INSERTION_THRESHOLD) {
+        uint64_t pivot;
+        if (count > 128) {
+            size_t step = count / 8;
+            size_t mid = count / 2;
+            pivot = bs_sort_median3(
+                bs_sort_median3(items[0].key, items[step].key, items[2 * step].key),
+                bs_sort_median3(items[mid - step].key, items[mid].key, items[mid + step].key),
+                bs_sort_median3(items[count - 1 - 2 * step].key, items[count - 1 - step].key, items[count - 1].key));
+        } else {
+            pivot = bs_sort_median3(items[0].key, items[count / 2].key, items[count - 1].key);
+        }
+        
+        size_t lt = 0;
+        size_t i = 0;
+        size_t gt = count;
+        while (i < gt) {
+            uint64_t key = items[i].key;
+            if (key < pivot) {
+                bs_sort_swap(&items[lt++], &items[i++]);
+            } else if (key > pivot) {
+                bs_sort_swap(&items[i], &items[--gt]);
+            } else {
+                i++;
+            }
+        }
+        
+        size_t less = lt;
+        size_t greater = count - gt;
+        // 剩余字节数小于8时这一组字符串完全相同，不需要继续
+        size_t equal = (pivot & 0xFF) < 8 ? 0 : gt - lt;
+        
+        if (equal >= less && equal >= greater) {
+            bs_sort_items(items, less, depth);
+            bs_sort_items(items + gt, greater, depth);
+            items += lt;
+            count = equal;
+            depth += BS_SORT_STEP;
+            for (size_t j = 0; j < count; j++) {
+                items[j].key = bs_sort_key(items[j].str, depth);
+            }
+        } else if (less >= greater) {
+            bs_sort_items(items + gt, greater, depth);
+            bs_sort_next_depth(items + lt, equal, depth);
+            count = less;
+        } else {
+            bs_sort_items(items, less, depth);
+            bs_sort_next_depth(items + lt, equal, depth);
+            items += gt;
+            count = greater;
+        }
+    }
+    bs_sort_insertion(items, count, depth);
+}
+
+static int bs_sort_qsort_compare(const void* a, const void* b) {
+    return bs_string_compare(*(bs_string* const*)a, *(bs_string* const*)b);
+}
+
+void bs_string_sort(bs_string** strings, size_t count) {
+    if (!strings || count < 2) {
+        return;
+    }
+    
+    bs_sort_item* items = (bs_sort_item*)malloc(count * sizeof(bs_sort_item));
+    if (!items) {
+        // 内存不足时退回原地的qsort
+        qsort(strings, count, sizeof(bs_string*), bs_sort_qsort_compare);
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        items[i].key = bs_sort_key(strings[i], 0);
+        items[i].str = strings[i];
+    }
+    bs_sort_items(items, count, 0);
+    for (size_t i = 0; i < count; i++) {
+        strings[i] = items[i].str;
+    }
+    free(items);
+}
+
+// 并行排序（抽样排序）
+// 桶2i是严格介于第i-1和第i个分隔串之间的字符串，桶2i+1是等于第i个分隔串的字符串，
+// 后者不需要排序。各线程先统计自己那一段里每个桶的数量，再按算好的偏移分散到结果数组
+typedef struct bs_parallel_sort {
+    bs_string** strings;
+    size_t count;
+    size_t threads;
+    size_t chunk;                // 分类和分散阶段每个线程处理的字符串数量
+    bs_string** splitters;
+    size_t splitter_count;
+    size_t bucket_count;
+    uint16_t* buckets;           // 每个字符串所在的桶
+    size_t* offsets;             // threads × bucket_count，先是计数，后是分散时的写入位置
+    size_t* bucket_start;        // bucket_count + 1
+    bs_sort_item* items;
+    volatile size_t next_bucket;
+} bs_parallel_sort;
+
+static size_t bs_sort_classify(const bs_parallel_sort* sort, const bs_string* str) {
+    size_t low = 0;
+    size_t high = sort->splitter_count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        int cmp = bs_string_compare(str, sort->splitters[mid]);
+        if (cmp == 0) {
+            return 2 * mid + 1;
+        }
+        if (cmp < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return 2 * low;
+}
+
+static void bs_parallel_sort_count(void* ctx, size_t index) {
+    bs_parallel_sort* sort = (bs_parallel_sort*)ctx;
+    size_t begin = index * sort->chunk;
+    size_t end = begin + sort->chunk < sort->count ? begin + sort->chunk : sort->count;
+    size_t* counts = sort->offsets + index * sort->bucket_count;
+    for (size_t i = begin; i < end; i++) {
+        size_t bucket = bs_sort_classify(sort, sort->strings[i]);
+        sort->buckets[i] = (uint16_t)bucket;
+        counts[bucket]++;
+    }
+}
+
+static void bs_parallel_sort_scatter(void* ctx, size_t index) {
+    bs_parallel_sort* sort = (bs_parallel_sort*)ctx;
+    size_t begin = index * sort->chunk;
+    size_t end = begin + sort->chunk < sort->count ? begin + sort->chunk : sort->count;
+    size_t* offsets = sort->offsets + index * sort->bucket_count;
+    for (size_t i = begin; i < end; i++) {
+        sort->items[offsets[sort->buckets[i]]++].str = sort->strings[i];
+    }
+}
+
+static void bs_parallel_sort_buckets(void* ctx, size_t index) {
+    bs_parallel_sort* sort = (bs_parallel_sort*)ctx;
+    (void)index;
+    for (;;) {
+        size_t bucket = bs_atomic_fetch_add(&sort->next_bucket, 1);
+        if (bucket >= sort->bucket_count) {
+            break;
+        }
+        if (bucket % 2 == 1) {
+            continue;
+        }
+        
+        // 两侧分隔串的公共前缀也是桶内所有字符串的公共前缀
+        size_t depth = 0;
+        size_t right = bucket / 2;
+        if (right > 0 && right < sort->splitter_count) {
+            const bs_string* a = sort->splitters[right - 1];
+            const bs_string* b = sort->splitters[right];
+            size_t length = a->byte_length < b->byte_length ? a->byte_length : b->byte_length;
+            depth = bs_mismatch(a->data, b->data, length);
+        }
+        
+        bs_sort_item* items = sort->items + sort->bucket_start[bucket];
+        size_t count = sort->bucket_start[bucket + 1] - sort->bucket_start[bucket];
+        for (size_t i = 0; i < count; i++) {
+            items[i].key = bs_sort_key(items[i].str, depth);
+        }
+        bs_sort_items(items, count, depth);
+    }
+}
+
+void bs_string_sort_parallel(bs_string** strings, size_t count, size_t threads) {
+    if (threads == 0) {
+        threads = bs_cpu_count();
+    }
+    if (threads > 1024) {
+        threads = 1024;
+    }
+    if (!strings || threads <= 1 || count < BS_SORT_PARALLEL_MIN) {
+        bs_string_sort(strings, count);
+        return;
+    }
     
-    // 简单实现：使用基础的字符串匹配
-    // 只支持 * 和 ? 通配符
+    // 每个线程大约8个桶，领取桶时负载更均衡；每个分隔串从16个样本中选出
+    const size_t oversample = 16;
+    size_t wanted = threads * 8 - 1;
+    if (wanted > count / (4 * oversample)) {
+        wanted = count / (4 * oversample);
+    }
+    size_t sample_count = wanted * oversample;
     
-    const char* s = (const char*)str->data;
-    const char* p = pattern;
+    bs_parallel_sort sort;
+    memset(&sort, 0, sizeof(sort));
+    sort.strings = strings;
+    sort.count = count;
+    sort.threads = threads;
+    sort.chunk = (count + threads - 1) / threads;
+    sort.splitters = (bs_string**)malloc(sample_count * sizeof(bs_string*));
+    sort.buckets = (uint16_t*)malloc(count * sizeof(uint16_t));
+    sort.items = (bs_sort_item*)malloc(count * sizeof(bs_sort_item));
+    if (!sort.splitters || !sort.buckets || !sort.items) {
+        free(sort.splitters);
+        free(sort.buckets);
+        free(sort.items);
+        bs_string_sort(strings, count);
+        return;
+    }
     
-    // 特殊情况：空字符串
-    if (str->byte_length == 0) {
-        return *p == '\0';
+    // 等距抽样加上小的伪随机偏移，避免输入本身的周期性
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    size_t stride = count / sample_count;
+    for (size_t i = 0; i < sample_count; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        sort.splitters[i] = strings[i * stride + (size_t)((state >> 33) % stride)];
+    }
+    bs_string_sort(sort.splitters, sample_count);
+    for (size_t i = oversample - 1; i < sample_count; i += oversample) {
+        bs_string* candidate = sort.splitters[i];
+        if (sort.splitter_count == 0 || !bs_string_equals(sort.splitters[sort.splitter_count - 1], candidate)) {
+            sort.splitters[sort.splitter_count++] = candidate;
+        }
     }
+    sort.bucket_count = 2 * sort.splitter_count + 1;
     
-    // 特殊情况：空模式
-    if (*p == '\0') {
-        return str->byte_length == 0;
+    sort.offsets = (size_t*)calloc(threads * sort.bucket_count, sizeof(size_t));
+    sort.bucket_start = (size_t*)malloc((sort.bucket_count + 1) * sizeof(size_t));
+    if (!sort.offsets || !sort.bucket_start) {
+        free(sort.offsets);
+        free(sort.bucket_start);
+        free(sort.splitters);
+        free(sort.buckets);
+        free(sort.items);
+        bs_string_sort(strings, count);
+        return;
     }
     
-    // 简单模式匹配
-    if (*p == '*') {
-        // * 可以匹配0个或多个字符
-        while (*(p+1) == '*') p++; // 跳过连续的*
+    bs_run_parallel(threads, bs_parallel_sort_count, &sort);
+    
+    // 计数换成写入位置：桶按顺序排列，同一个桶里线程按顺序排列，结果与串行分散相同
+    size_t position = 0;
+    for (size_t bucket = 0; bucket < sort.bucket_count; bucket++) {
+        sort.bucket_start[bucket] = position;
+        for (size_t t = 0; t < threads; t++) {
+            size_t* slot = &sort.offsets[t * sort.bucket_count + bucket];
+            size_t n = *slot;
+            *slot = position;
+            position += n;
+        }
+    }
+    sort.bucket_start[sort.bucket_count] = position;
+    
+    bs_run_parallel(threads, bs_parallel_sort_scatter, &sort);
+    bs_run_parallel(threads, bs_parallel_sort_buckets, &sort);
+    
+    for (size_t i = 0; i < count; i++) {
+        strings[i] = sort.items[i].str;
+    }
+    
+    free(sort.offsets);
+    free(sort.bucket_start);
+    free(sort.splitters);
+    free(sort.buckets);
+    free(sort.items);
+}
+
+void bs_string_array_sort(bs_string_array* array) {
+    if (array) {
+        bs_string_sort(array->items, array->length);
+    }
+}
+
+void bs_string_array_sort_parallel(bs_string_array* array, size_t threads) {
+    if (array) {
+        bs_string_sort_parallel(array->items, array->length, threads);
+    }
+}
+
+// 线程池实现
+#if defined(_WIN32)
+typedef SRWLOCK bs_mutex;
+typedef CONDITION_VARIABLE bs_cond;
+#define bs_mutex_init(mutex) InitializeSRWLock(mutex)
+#define bs_mutex_destroy(mutex) ((void)(mutex))
+#define bs_mutex_lock(mutex) AcquireSRWLockExclusive(mutex)
+#define bs_mutex_unlock(mutex) ReleaseSRWLockExclusive(mutex)
+#define bs_cond_init(cond) InitializeConditionVariable(cond)
+#define bs_cond_destroy(cond) ((void)(cond))
+#define bs_cond_wait(cond, mutex) SleepConditionVariableSRW(cond, mutex, INFINITE, 0)
+#define bs_cond_broadcast(cond) WakeAllConditionVariable(cond)
+#else
+typedef pthread_mutex_t bs_mutex;
+typedef pthread_cond_t bs_cond;
+#define bs_mutex_init(mutex) pthread_mutex_init(mutex, NULL)
+#define bs_mutex_destroy(mutex) pthread_mutex_destroy(mutex)
+#define bs_mutex_lock(mutex) pthread_mutex_lock(mutex)
+#define bs_mutex_unlock(mutex) pthread_mutex_unlock(mutex)
+#define bs_cond_init(cond) pthread_cond_init(cond, NULL)
+#define bs_cond_destroy(cond) pthread_cond_destroy(cond)
+#define bs_cond_wait(cond, mutex) pthread_cond_wait(cond, mutex)
+#define bs_cond_broadcast(cond) pthread_cond_broadcast(cond)
+#endif
+
+// 每个线程待处理的块区间[next, end)，按缓存行对齐，避免不同线程的区间互相干扰
+typedef struct bs_pool_queue {
+    bs_mutex lock;
+    size_t next;
+    size_t end;
+    char padding[64];
+} bs_pool_queue;
+
+typedef struct bs_pool_worker {
+    bs_thread_pool* pool;
+    size_t index;
+    bs_thread thread;
+} bs_pool_worker;
+
+struct bs_thread_pool {
+    size_t size;                 // 参与计算的线程数，包括提交任务的线程
+    bs_pool_worker* workers;     // size - 1个工作线程
+    bs_pool_queue* queues;       // 每个线程一个
+    bs_mutex lock;               // 保护下面的任务状态
+    bs_cond wake;
+    bs_cond done;
+    bs_mutex submit;             // 同一时刻只执行一个并行循环
+    uint64_t generation;         // 每提交一次加一，工作线程据此发现新任务
+    size_t running;              // 还没做完当前任务的工作线程数
+    bool stopping;
+    // 当前任务
+    void (*fn)(void* ctx, size_t begin, size_t end);
+    void* ctx;
+    size_t count;
+    size_t grain;
+};
+
+static bool bs_pool_take(bs_pool_queue* queue, size_t* chunk) {
+    bool found = false;
+    bs_mutex_lock(&queue->lock);
+    if (queue->next < queue->end) {
+        *chunk = queue->next++;
+        found = true;
+    }
+    bs_mutex_unlock(&queue->lock);
+    return found;
+}
+
+// 从其他线程的区间末尾取走一半放进自己的区间，并取出第一块
+static bool bs_pool_steal(bs_thread_pool* pool, size_t self, size_t* chunk) {
+    for (size_t i = 1; i < pool->size; i++) {
+        bs_pool_queue* victim = &pool->queues[(self + i) % pool->size];
+        size_t begin = 0;
+        size_t end = 0;
+        bs_mutex_lock(&victim->lock);
+        if (victim->next < victim->end) {
+            size_t remaining = victim->end - victim->next;
+            begin = victim->end - (remaining + 1) / 2;
+            end = victim->end;
+            victim->end = begin;
+        }
+        bs_mutex_unlock(&victim->lock);
         
-        if (*(p+1) == '\0') {
-            return true; // 如果模式以*结尾，则匹配任何剩余字符
+        if (begin < end) {
+            bs_pool_queue* own = &pool->queues[self];
+            bs_mutex_lock(&own->lock);
+            own->next = begin + 1;
+            own->end = end;
+            bs_mutex_unlock(&own->lock);
+            *chunk = begin;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void bs_pool_work(bs_thread_pool* pool, size_t self) {
+    size_t chunk;
+    while (bs_pool_take(&pool->queues[self], &chunk) || bs_pool_steal(pool, self, &chunk)) {
+        size_t begin = chunk * pool->grain;
+        size_t end = begin + pool->grain < pool->count ? begin + pool->grain : pool->count;
+        pool->fn(pool->ctx, begin, end);
+    }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI bs_pool_worker_main(LPVOID arg) {
+#else
+static void* bs_pool_worker_main(void* arg) {
+#endif
+    bs_pool_worker* worker = (bs_pool_worker*)arg;
+    bs_thread_pool* pool = worker->pool;
+    uint64_t seen = 0;
+    for (;;) {
+        bs_mutex_lock(&pool->lock);
+        while (!pool->stopping && pool->generation == seen) {
+            bs_cond_wait(&pool->wake, &pool->lock);
         }
+        if (pool->stopping) {
+            bs_mutex_unlock(&pool->lock);
+            break;
+        }
+        seen = pool->generation;
+        bs_mutex_unlock(&pool->lock);
         
-        const char* star_pattern = p + 1;
-        for (size_t i = 0; i <= str->byte_length; i++) {
-            bs_string* substr = bs_string_new_len(s + i, str->byte_length - i);
-            bool result = bs_string_matches(substr, star_pattern);
-            bs_string_free(substr);
-            if (result) {
-                return true;
-            }
+        bs_pool_work(pool, worker->index);
+        
+        bs_mutex_lock(&pool->lock);
+        if (--pool->running == 0) {
+            bs_cond_broadcast(&pool->done);
         }
-        return false;
-    } else if (*p == '?') {
-        // ? 匹配任何单个字符
-        return str->byte_length > 0 && bs_string_matches(
-            bs_string_new_len(s + 1, str->byte_length - 1), 
-            p + 1
-        );
-    } else {
-        // 普通字符匹配
-        return str->byte_length > 0 && *s == *p && bs_string_matches(
-            bs_string_new_len(s + 1, str->byte_length - 1), 
-            p + 1
-        );
+        bs_mutex_unlock(&pool->lock);
     }
+#if defined(_WIN32)
+    return 0;
+#else
+    return NULL;
+#endif
 }
 
-bs_string* bs_string_replace_regex(const bs_string* str, const char* pattern, const char* replacement) {
-    if (!str || !pattern || !replacement) {
-        return bs_string_copy(str);
+bs_thread_pool* bs_thread_pool_new(size_t threads) {
+    if (threads == 0) {
+        threads = bs_cpu_count();
     }
     
-    // 简单实现：只支持直接子字符串替换
-    bs_string* pattern_str = bs_string_new(pattern);
-    bs_string* replacement_str = bs_string_new(replacement);
+    bs_thread_pool* pool = (bs_thread_pool*)calloc(1, sizeof(bs_thread_pool));
+    if (!pool) {
+        return NULL;
+    }
+    pool->queues = (bs_pool_queue*)calloc(threads, sizeof(bs_pool_queue));
+    pool->workers = threads > 1 ? (bs_pool_worker*)calloc(threads - 1, sizeof(bs_pool_worker)) : NULL;
+    if (!pool->queues || (threads > 1 && !pool->workers)) {
+        free(pool->queues);
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+    for (size_t i = 0; i < threads; i++) {
+        bs_mutex_init(&pool->queues[i].lock);
+    }
+    bs_mutex_init(&pool->lock);
+    bs_mutex_init(&pool->submit);
+    bs_cond_init(&pool->wake);
+    bs_cond_init(&pool->done);
     
-    bs_string* result = bs_string_replace(str, pattern_str, replacement_str);
+    // 工作线程的下标从1开始，0留给提交任务的线程；创建失败时按已创建的数量工作
+    pool->size = 1;
+    for (size_t i = 1; i < threads; i++) {
+        bs_pool_worker* worker = &pool->workers[i - 1];
+        worker->pool = pool;
+        worker->index = i;
+#if defined(_WIN32)
+        worker->thread = CreateThread(NULL, 0, bs_pool_worker_main, worker, 0, NULL);
+        if (!worker->thread) {
+            break;
+        }
+#else
+        if (pthread_create(&worker->thread, NULL, bs_pool_worker_main, worker) != 0) {
+            break;
+        }
+#endif
+        pool->size++;
+    }
+    return pool;
+}
+
+void bs_thread_pool_free(bs_thread_pool* pool) {
+    if (!pool) {
+        return;
+    }
     
-    bs_string_free(pattern_str);
-    bs_string_free(replacement_str);
+    bs_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    bs_cond_broadcast(&pool->wake);
+    bs_mutex_unlock(&pool->lock);
+    for (size_t i = 1; i < pool->size; i++) {
+#if defined(_WIN32)
+        WaitForSingleObject(pool->workers[i - 1].thread, INFINITE);
+        CloseHandle(pool->workers[i - 1].thread);
+#else
+        pthread_join(pool->workers[i - 1].thread, NULL);
+#endif
+    }
     
-    return result;
+    for (size_t i = 0; i < pool->size; i++) {
+        bs_mutex_destroy(&pool->queues[i].lock);
+    }
+    bs_mutex_destroy(&pool->lock);
+    bs_mutex_destroy(&pool->submit);
+    bs_cond_destroy(&pool->wake);
+    bs_cond_destroy(&pool->done);
+    free(pool->queues);
+    free(pool->workers);
+    free(pool);
 }
 
-bs_string_array* bs_string_regex_split(const bs_string* str, const char* pattern) {
-    if (!str || !pattern) {
-        return NULL;
+size_t bs_thread_pool_size(const bs_thread_pool* pool) {
+    return pool ? pool->size : 1;
+}
+
+void bs_thread_pool_for(bs_thread_pool* pool, size_t count, size_t grain,
+                        void (*fn)(void* ctx, size_t begin, size_t end), void* ctx) {
+    if (!fn || count == 0) {
+        return;
+    }
+    size_t threads = pool ? pool->size : 1;
+    if (grain == 0) {
+        // 每个线程大约8块，留出窃取的余地
+        grain = (count + threads * 8 - 1) / (threads * 8);
+    }
+    size_t chunks = (count + grain - 1) / grain;
+    if (threads == 1 || chunks == 1) {
+        for (size_t begin = 0; begin < count; begin += grain) {
+            fn(ctx, begin, begin + grain < count ? begin + grain : count);
+        }
+        return;
     }
     
-    // 简单实现：直接使用字符串分割
-    return bs_string_split(str, pattern);
+    bs_mutex_lock(&pool->submit);
+    for (size_t i = 0; i < threads; i++) {
+        bs_pool_queue* queue = &pool->queues[i];
+        bs_mutex_lock(&queue->lock);
+        queue->next = chunks * i / threads;
+        queue->end = chunks * (i + 1) / threads;
+        bs_mutex_unlock(&queue->lock);
+    }
+    
+    bs_mutex_lock(&pool->lock);
+    pool->fn = fn;
+    pool->ctx = ctx;
+    pool->count = count;
+    pool->grain = grain;
+    pool->running = threads - 1;
+    pool->generation++;
+    bs_cond_broadcast(&pool->wake);
+    bs_mutex_unlock(&pool->lock);
+    
+    bs_pool_work(pool, 0);
+    
+    bs_mutex_lock(&pool->lock);
+    while (pool->running > 0) {
+        bs_cond_wait(&pool->done, &pool->lock);
+    }
+    bs_mutex_unlock(&pool->lock);
+    bs_mutex_unlock(&pool->submit);
 }
 
-bs_string_array* bs_string_regex_find_all(const bs_string* str, const char* pattern) {
-    if (!str || !pattern) {
+// 批量转换
+#define BS_BATCH_CHUNK_BYTES (64u << 10)
+
+typedef struct bs_batch {
+    const bs_string_array* input;
+    bs_compact_array* output;
+    size_t* sizes;
+    bs_string_map_fn fn;
+    void* user;
+    bs_string empty;         // 代替数组中的NULL，与bs_string_join一致按空字符串处理
+} bs_batch;
+
+static inline const bs_string* bs_batch_item(const bs_batch* batch, size_t index) {
+    const bs_string* item = batch->input->items[index];
+    return item ? item : &batch->empty;
+}
+
+static void bs_batch_measure(void* ctx, size_t begin, size_t end) {
+    bs_batch* batch = (bs_batch*)ctx;
+    for (size_t i = begin; i < end; i++) {
+        batch->sizes[i] = batch->fn(bs_batch_item(batch, i), NULL, batch->user);
+    }
+}
+
+static void bs_batch_write(void* ctx, size_t begin, size_t end) {
+    bs_batch* batch = (bs_batch*)ctx;
+    const size_t* offsets = batch->output->offsets;
+    for (size_t i = begin; i < end; i++) {
+        batch->fn(bs_batch_item(batch, i), batch->output->data + offsets[i], batch->user);
+    }
+}
+
+// 按平均长度确定每块的字符串数，使每块大约BS_BATCH_CHUNK_BYTES字节输入
+static size_t bs_batch_grain(const bs_string_array* array, size_t threads) {
+    size_t count = array->length;
+    size_t sample = count < 1024 ? count : 1024;
+    size_t bytes = 0;
+    for (size_t i = 0; i < sample; i++) {
+        const bs_string* item = array->items[i * count / sample];
+        bytes += item ? item->byte_length : 0;
+    }
+    size_t average = bytes / sample + 16;
+    size_t grain = BS_BATCH_CHUNK_BYTES / average;
+    // 数组较小时也要切出足够的块分给各个线程
+    size_t balanced = (count + threads * 4 - 1) / (threads * 4);
+    if (grain > balanced) {
+        grain = balanced;
+    }
+    return grain > 0 ? grain : 1;
+}
+
+bs_compact_array* bs_string_array_map(const bs_string_array* array, bs_string_map_fn fn, void* user,
+                                      bs_thread_pool* pool) {
+    if (!array || !fn) {
         return NULL;
     }
     
-    // 简化实现：模式为简单子字符串的情况
-    bs_string* pattern_str = bs_string_new(pattern);
-    
-    // 分配结果数组
-    bs_string_array* result = (bs_string_array*)malloc(sizeof(bs_string_array));
-    if (!result) {
-        bs_string_free(pattern_str);
+    size_t count = array->length;
+    if (count == 0) {
+        return bs_compact_array_alloc(0, 0);
+    }
+    bs_batch batch;
+    batch.input = array;
+    batch.output = NULL;
+    batch.fn = fn;
+    batch.user = user;
+    batch.empty = bs_string_view_len("", 0);
+    batch.sizes = (size_t*)malloc(count * sizeof(size_t));
+    if (!batch.sizes) {
         return NULL;
     }
     
-    // 查找所有匹配
-    size_t pos = 0;
-    size_t max_matches = 16; // 初始容量
-    result->items = (bs_string**)malloc(max_matches * sizeof(bs_string*));
-    result->length = 0;
+    size_t grain = bs_batch_grain(array, bs_thread_pool_size(pool));
+    bs_thread_pool_for(pool, count, grain, bs_batch_measure, &batch);
     
-    while (1) {
-        int64_t match_pos = bs_string_find(str, pattern_str, pos);
-        if (match_pos < 0) {
-            break;
-        }
-        
-        // 计算匹配的字节位置
-        size_t byte_pos = 0;
-        for (size_t i = 0; i < match_pos && byte_pos < str->byte_length; ) {
-            byte_pos += utf8_char_size(str->data + byte_pos);
-            i++;
-        }
-        
-        // 添加匹配的子字符串
-        size_t match_len = pattern_str->byte_length;
-        bs_string* match = bs_string_new_len((const char*)(str->data + byte_pos), match_len);
-        
-        // 如果需要扩容
-        if (result->length >= max_matches) {
-            max_matches *= 2;
-            bs_string** new_items = (bs_string**)realloc(result->items, max_matches * sizeof(bs_string*));
-            if (!new_items) {
-                // 内存分配失败，释放资源
-                bs_string_free(match);
-                for (size_t i = 0; i < result->length; i++) {
-                    bs_string_free(result->items[i]);
-                }
-                free(result->items);
-                free(result);
-                bs_string_free(pattern_str);
-                return NULL;
-            }
-            result->items = new_items;
-        }
-        
-        result->items[result->length++] = match;
-        
-        // 移动到下一个位置
-        pos = match_pos + 1;
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += batch.sizes[i];
+    }
+    batch.output = bs_compact_array_alloc(count, total);
+    if (!batch.output) {
+        free(batch.sizes);
+        return NULL;
     }
+    for (size_t i = 0; i < count; i++) {
+        batch.output->offsets[i + 1] = batch.output->offsets[i] + batch.sizes[i];
+    }
+    free(batch.sizes);
     
-    bs_string_free(pattern_str);
-    return result;
+    bs_thread_pool_for(pool, count, grain, bs_batch_write, &batch);
+    return batch.output;
 }
 
-// 构造函数实现
+// 8个字节一次判断是否是ASCII字母并翻转0x20位：
+// 每个字节的低7位加上偏移后，最高位表示是否不小于下界，异或两次比较的结果得到落在区间内的字节
+static inline uint64_t bs_ascii_case_mask(uint64_t word, uint8_t first, uint8_t last) {
+    const uint64_t ones = 0x0101010101010101ULL;
+    uint64_t low7 = word & (0x7F * ones);
+    uint64_t at_least_first = low7 + (0x80 - first) * ones;
+    uint64_t above_last = low7 + (0x7F - last) * ones;
+    return (at_least_first ^ above_last) & ~word & (0x80 * ones);
+}
 
-bs_string* bs_string_new(const char* str) {
-    if (!str) {
-        return bs_string_new_len("", 0);
+static void bs_ascii_convert_case(const uint8_t* src, uint8_t* dst, size_t length, bool upper) {
+    uint8_t first = upper ? 'a' : 'A';
+    uint8_t last = upper ? 'z' : 'Z';
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word = bs_load_u64(src + i);
+        word ^= bs_ascii_case_mask(word, first, last) >> 2;
+        memcpy(dst + i, &word, sizeof(word));
+    }
+    for (; i < length; i++) {
+        uint8_t c = src[i];
+        dst[i] = (c >= first && c <= last) ? (uint8_t)(c ^ 0x20) : c;
     }
-    return bs_string_new_len(str, strlen(str));
 }
 
-bs_string* bs_string_new_len(const char* str, size_t byte_length) {
+static size_t bs_batch_to_lower(const bs_string* str, uint8_t* out, void* user) {
+    (void)user;
+    if (out) {
+        bs_ascii_convert_case(str->data, out, str->byte_length, false);
+    }
+    return str->byte_length;
+}
+
+static size_t bs_batch_to_upper(const bs_string* str, uint8_t* out, void* user) {
+    (void)user;
+    if (out) {
+        bs_ascii_convert_case(str->data, out, str->byte_length, true);
+    }
+    return str->byte_length;
+}
+
+static size_t bs_batch_trim(const bs_string* str, uint8_t* out, void* user) {
+    bs_string view = bs_string_trim_view(str, *(const unsigned*)user);
+    if (out && view.byte_length > 0) {
+        memcpy(out, view.data, view.byte_length);
+    }
+    return view.byte_length;
+}
+
+bs_compact_array* bs_string_array_to_lower(const bs_string_array* array, bs_thread_pool* pool) {
+    return bs_string_array_map(array, bs_batch_to_lower, NULL, pool);
+}
+
+bs_compact_array* bs_string_array_to_upper(const bs_string_array* array, bs_thread_pool* pool) {
+    return bs_string_array_map(array, bs_batch_to_upper, NULL, pool);
+}
+
+bs_compact_array* bs_string_array_trim(const bs_string_array* array, unsigned flags, bs_thread_pool* pool) {
+    return bs_string_array_map(array, bs_batch_trim, &flags, pool);
+}
+
+// 单个字符串的大小写转换与批量版本使用同一个按字处理的实现，只转换ASCII字母
+static bs_string* bs_string_convert_case(const bs_string* str, bool upper) {
     if (!str) {
-        str = "";
-        byte_length = 0;
+        return NULL;
     }
     
-    bs_string* result = bs_string_alloc(byte_length, BS_ENCODING_UTF8);
+    bs_string* result = bs_string_alloc(str->byte_length, str->encoding);
     if (!result) {
         return NULL;
     }
+    bs_ascii_convert_case(str->data, result->data, str->byte_length, upper);
+    result->length = bs_char_length(str);
+    return result;
+}
+
+bs_string* bs_string_to_upper(const bs_string* str) {
+    return bs_string_convert_case(str, true);
+}
+
+bs_string* bs_string_to_lower(const bs_string* str) {
+    return bs_string_convert_case(str, false);
+}
+
+// 并行查找
+#define BS_SEARCH_CHUNK_BYTES (1u << 20)
+#define BS_SEARCH_PARALLEL_MIN (256u << 10)
+
+typedef struct bs_search_chunk {
+    size_t* positions;
+    size_t count;
+    size_t capacity;
+} bs_search_chunk;
+
+typedef enum {
+    BS_SEARCH_FIND_ALL,
+    BS_SEARCH_COUNT,
+    BS_SEARCH_CONTAINS
+} bs_search_mode;
+
+typedef struct bs_search {
+    const uint8_t* data;
+    const uint8_t* needle;
+    size_t needle_length;
+    size_t starts;           // 可能的起始位置数量
+    size_t chunk_size;
+    bs_search_chunk* chunks;  // 每块的结果，contains时为NULL
+    bs_search_mode mode;
+    volatile size_t found;    // contains找到的匹配数
+    volatile size_t failed;   // 分配失败的块数
+} bs_search;
+
+// 在第index块中查找，匹配起点落在[index * chunk_size, 下一块起点)内
+static void bs_search_chunk_run(bs_search* search, size_t index) {
+    size_t begin = index * search->chunk_size;
+    size_t end = begin + search->chunk_size;
+    if (end > search->starts) {
+        end = search->starts;
+    }
+    // 扫描范围延伸needle_length - 1个字节，覆盖起点在本块内的跨块匹配
+    size_t scan_end = end + search->needle_length - 1;
+    bs_search_chunk* chunk = &search->chunks[index];
+    size_t pos = begin;
     
-    memcpy(result->data, str, byte_length);
-    result->byte_length = byte_length;
-    result->length = utf8_strlen(str, byte_length);
-    result->is_view = false;
+    while (pos < end) {
+        size_t found = pos + bs_find_bytes(search->data + pos, scan_end - pos, search->needle, search->needle_length);
+        if (found >= end) {
+            break;
+        }
+        if (search->mode == BS_SEARCH_CONTAINS) {
+            bs_atomic_fetch_add(&search->found, 1);
+            return;
+        }
+        if (search->mode == BS_SEARCH_COUNT) {
+            chunk->count++;
+        } else {
+            if (chunk->count == chunk->capacity) {
+                size_t capacity = chunk->capacity ? chunk->capacity * 2 : 16;
+                size_t* positions = (size_t*)realloc(chunk->positions, capacity * sizeof(size_t));
+                if (!positions) {
+                    bs_atomic_fetch_add(&search->failed, 1);
+                    return;
+                }
+                chunk->positions = positions;
+                chunk->capacity = capacity;
+            }
+            chunk->positions[chunk->count++] = found;
+        }
+        pos = found + 1;
+    }
+}
+
+static void bs_search_task(void* ctx, size_t begin, size_t end) {
+    bs_search* search = (bs_search*)ctx;
+    for (size_t i = begin; i < end; i++) {
+        if (search->mode == BS_SEARCH_CONTAINS && bs_atomic_fetch_add(&search->found, 0) > 0) {
+            return;
+        }
+        bs_search_chunk_run(search, i);
+    }
+}
+
+// 准备查找并执行，返回块数；没有可能的匹配时返回0
+static size_t bs_search_run(bs_search* search, const bs_string* str, const bs_string* find,
+                            bs_thread_pool* pool) {
+    search->chunks = NULL;
+    search->found = 0;
+    search->failed = 0;
+    if (!str || !find || find->byte_length == 0 || find->byte_length > str->byte_length) {
+        return 0;
+    }
+    
+    search->data = str->data;
+    search->needle = find->data;
+    search->needle_length = find->byte_length;
+    search->starts = str->byte_length - find->byte_length + 1;
     
-    return result;
-}
-
-bs_string* bs_string_new_utf16(const uint16_t* str) {
-    // 简化实现：先转换为UTF-8然后创建
-    if (!str) {
-        return bs_string_new_len("", 0);
+    size_t threads = bs_thread_pool_size(pool);
+    size_t chunk_size = BS_SEARCH_CHUNK_BYTES;
+    if (threads <= 1 || str->byte_length < BS_SEARCH_PARALLEL_MIN) {
+        chunk_size = search->starts;
+    } else if (chunk_size < find->byte_length * 16) {
+        // 长needle时加大块，让重叠部分只占很小比例
+        chunk_size = find->byte_length * 16;
     }
+    search->chunk_size = chunk_size;
+    size_t chunk_count = (search->starts + chunk_size - 1) / chunk_size;
     
-    // 计算UTF-16字符串长度
-    size_t utf16_len = 0;
-    while (str[utf16_len]) {
-        utf16_len++;
+    if (search->mode != BS_SEARCH_CONTAINS) {
+        search->chunks = (bs_search_chunk*)calloc(chunk_count, sizeof(bs_search_chunk));
+        if (!search->chunks) {
+            search->failed = 1;
+            return 0;
+        }
+    }
+    bs_thread_pool_for(chunk_count > 1 ? pool : NULL, chunk_count, 1, bs_search_task, search);
+    return chunk_count;
+}
+
+bs_match_list* bs_string_find_all(const bs_string* str, const bs_string* find, bs_thread_pool* pool) {
+    if (!str || !find) {
+        return NULL;
     }
     
-    // 估算UTF-8可能需要的最大长度（每个UTF-16字符最多3个UTF-8字节）
-    size_t max_utf8_len = utf16_len * 3;
-    uint8_t* utf8_buf = (uint8_t*)malloc(max_utf8_len + 1);
-    if (!utf8_buf) {
+    bs_match_list* list = (bs_match_list*)malloc(sizeof(bs_match_list));
+    if (!list) {
         return NULL;
     }
+    list->positions = NULL;
+    list->length = 0;
     
-    // 执行UTF-16到UTF-8的转换
-    size_t utf8_pos = 0;
-    for (size_t i = 0; i < utf16_len; i++) {
-        uint32_t codepoint = str[i];
-        
-        // 处理代理对
-        if (codepoint >= 0xD800 && codepoint <= 0xDBFF && i + 1 < utf16_len) {
-            uint32_t low_surrogate = str[i + 1];
-            if (low_surrogate >= 0xDC00 && low_surrogate <= 0xDFFF) {
-                codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low_surrogate - 0xDC00);
-                i++; // 跳过下一个字符，因为它是代理对的一部分
+    bs_search search;
+    search.mode = BS_SEARCH_FIND_ALL;
+    size_t chunk_count = bs_search_run(&search, str, find, pool);
+    
+    // 按块的顺序合并，块内的位置已经升序
+    size_t total = 0;
+    for (size_t i = 0; i < chunk_count; i++) {
+        total += search.chunks[i].count;
+    }
+    if (!search.failed && total > 0) {
+        list->positions = (size_t*)malloc(total * sizeof(size_t));
+        if (list->positions) {
+            for (size_t i = 0; i < chunk_count; i++) {
+                if (search.chunks[i].count == 0) {
+                    continue;
+                }
+                memcpy(list->positions + list->length, search.chunks[i].positions,
+                       search.chunks[i].count * sizeof(size_t));
+                list->length += search.chunks[i].count;
             }
+        } else {
+            search.failed = 1;
         }
-        
-        // 编码为UTF-8
-        utf8_pos += utf8_encode_char(codepoint, utf8_buf + utf8_pos);
     }
+    for (size_t i = 0; i < chunk_count; i++) {
+        free(search.chunks[i].positions);
+    }
+    free(search.chunks);
     
-    utf8_buf[utf8_pos] = '\0';
-    
-    // 创建字符串
-    bs_string* result = bs_string_new_len((char*)utf8_buf, utf8_pos);
-    free(utf8_buf);
-    
-    return result;
+    if (search.failed) {
+        free(list);
+        return NULL;
+    }
+    return list;
 }
 
-bs_string* bs_string_new_utf32(const uint32_t* str) {
-    // 实现与UTF-16类似，但处理更直接
-    if (!str) {
-        return bs_string_new_len("", 0);
+void bs_match_list_free(bs_match_list* list) {
+    if (!list) {
+        return;
     }
-    
-    // 计算UTF-32字符串长度
-    size_t utf32_len = 0;
-    while (str[utf32_len]) {
-        utf32_len++;
+    free(list->positions);
+    free(list);
+}
+
+size_t bs_string_count(const bs_string* str, const bs_string* find, bs_thread_pool* pool) {
+    bs_search search;
+    search.mode = BS_SEARCH_COUNT;
+    size_t chunk_count = bs_search_run(&search, str, find, pool);
+    size_t total = 0;
+    for (size_t i = 0; i < chunk_count; i++) {
+        total += search.chunks[i].count;
     }
-    
-    // 估算UTF-8可能需要的最大长度（每个UTF-32字符最多4个UTF-8字节）
-    size_t max_utf8_len = utf32_len * 4;
-    uint8_t* utf8_buf = (uint8_t*)malloc(max_utf8_len + 1);
-    if (!utf8_buf) {
+    free(search.chunks);
+    return total;
+}
+
+bool bs_string_contains_parallel(const bs_string* str, const bs_string* find, bs_thread_pool* pool) {
+    bs_search search;
+    search.mode = BS_SEARCH_CONTAINS;
+    return bs_search_run(&search, str, find, pool) > 0 && search.found > 0;
+}
+
+// 文件映射
+typedef struct bs_mapped_file {
+    bs_string str;           // 必须是第一个成员，bs_string_unmap由此找回映射
+    void* map;
+    size_t map_length;
+} bs_mapped_file;
+
+bs_string* bs_string_map_file(const char* path, unsigned flags) {
+    if (!path) {
+        errno = EINVAL;
         return NULL;
     }
     
-    // 执行UTF-32到UTF-8的转换
-    size_t utf8_pos = 0;
-    for (size_t i = 0; i < utf32_len; i++) {
-        utf8_pos += utf8_encode_char(str[i], utf8_buf + utf8_pos);
+    bs_mapped_file* file = (bs_mapped_file*)malloc(sizeof(bs_mapped_file));
+    if (!file) {
+        errno = ENOMEM;
+        return NULL;
     }
+    file->map = NULL;
+    file->map_length = 0;
     
-    utf8_buf[utf8_pos] = '\0';
-    
-    // 创建字符串
-    bs_string* result = bs_string_new_len((char*)utf8_buf, utf8_pos);
-    free(utf8_buf);
+#if defined(_WIN32)
+    DWORD attributes = (flags & BS_MAP_SEQUENTIAL) ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL;
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, attributes, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        errno = ENOENT;
+        free(file);
+        return NULL;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || (unsigned long long)size.QuadPart > SIZE_MAX) {
+        CloseHandle(handle);
+        errno = EFBIG;
+        free(file);
+        return NULL;
+    }
+    if (size.QuadPart > 0) {
+        // 映射视图会保持映射对象有效，两个句柄都可以立即关闭
+        HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping) {
+            file->map = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+        if (!file->map) {
+            CloseHandle(handle);
+            errno = ENOMEM;
+            free(file);
+            return NULL;
+        }
+        file->map_length = (size_t)size.QuadPart;
+    }
+    CloseHandle(handle);
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        free(file);
+        return NULL;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (unsigned long long)info.st_size > SIZE_MAX) {
+        int error = errno;
+        close(fd);
+        free(file);
+        errno = error ? error : EFBIG;
+        return NULL;
+    }
+    if (info.st_size > 0) {
+        // 映射建立后不再需要文件描述符
+        void* map = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            int error = errno;
+            close(fd);
+            free(file);
+            errno = error;
+            return NULL;
+        }
+        file->map = map;
+        file->map_length = (size_t)info.st_size;
+        if (flags & BS_MAP_SEQUENTIAL) {
+            posix_madvise(map, file->map_length, POSIX_MADV_SEQUENTIAL);
+        }
+        if (flags & BS_MAP_WILLNEED) {
+            posix_madvise(map, file->map_length, POSIX_MADV_WILLNEED);
+        }
+    }
+    close(fd);
+#endif
     
-    return result;
+    // 空文件不能映射，指向一个空字符串
+    file->str.data = file->map ? (uint8_t*)file->map : (uint8_t*)"";
+    file->str.length = file->map_length ? BS_LENGTH_UNKNOWN : 0;
+    file->str.byte_length = file->map_length;
+    file->str.encoding = BS_ENCODING_UTF8;
+    file->str.is_view = true;
+    file->str.hash_cached = false;
+    file->str.hash = 0;
+    return &file->str;
 }
 
-bs_string* bs_string_new_with_encoding(const void* str, size_t byte_length, bs_encoding_t encoding) {
+void bs_string_unmap(bs_string* str) {
     if (!str) {
-        return bs_string_new_len("", 0);
+        return;
     }
     
-    switch (encoding) {
-        case BS_ENCODING_UTF8:
-            return bs_string_new_len((const char*)str, byte_length);
-        
-        case BS_ENCODING_UTF16:
-            return bs_string_new_utf16((const uint16_t*)str);
-        
-        case BS_ENCODING_UTF32:
-            return bs_string_new_utf32((const uint32_t*)str);
-        
-        case BS_ENCODING_ASCII:
-            // ASCII可以直接当作UTF-8处理
-            return bs_string_new_len((const char*)str, byte_length);
-            
-        default:
-            return NULL;
+    bs_mapped_file* file = (bs_mapped_file*)str;
+    if (file->map) {
+#if defined(_WIN32)
+        UnmapViewOfFile(file->map);
+#else
+        munmap(file->map, file->map_length);
+#endif
     }
+    free(file);
 }
 
-bs_string* bs_string_copy(const bs_string* str) {
-    if (!str) {
+// 按行读取
+#define BS_LINE_READER_DEFAULT_SIZE (256u << 10)
+
+struct bs_line_reader {
+    bs_read_fn read;
+    void* ctx;
+    uint8_t* buffer;
+    size_t capacity;
+    size_t start;            // 下一行的起点
+    size_t scanned;          // [start, scanned)中已确认没有换行符
+    size_t end;              // 有效数据的终点
+    bool eof;
+    bool error;
+};
+
+static ptrdiff_t bs_read_fd_source(void* ctx, uint8_t* buffer, size_t capacity) {
+    int fd = (int)(intptr_t)ctx;
+    for (;;) {
+#if defined(_WIN32)
+        int chunk = capacity > 0x40000000 ? 0x40000000 : (int)capacity;
+        int result = _read(fd, buffer, (unsigned)chunk);
+#else
+        ssize_t result = read(fd, buffer, capacity);
+#endif
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        return (ptrdiff_t)result;
+    }
+}
+
+static ptrdiff_t bs_read_file_source(void* ctx, uint8_t* buffer, size_t capacity) {
+    FILE* file = (FILE*)ctx;
+    size_t result = fread(buffer, 1, capacity, file);
+    if (result == 0 && ferror(file)) {
+        return -1;
+    }
+    return (ptrdiff_t)result;
+}
+
+bs_line_reader* bs_line_reader_new(bs_read_fn read, void* ctx, size_t buffer_size) {
+    if (!read) {
         return NULL;
     }
     
-    bs_string* result = bs_string_alloc(str->byte_length, str->encoding);
-    if (!result) {
+    bs_line_reader* reader = (bs_line_reader*)malloc(sizeof(bs_line_reader));
+    if (!reader) {
         return NULL;
     }
-    
-    memcpy(result->data, str->data, str->byte_length);
-    result->byte_length = str->byte_length;
-    result->length = str->length;
-    result->is_view = false;
-    
-    return result;
+    reader->capacity = buffer_size ? buffer_size : BS_LINE_READER_DEFAULT_SIZE;
+    reader->buffer = (uint8_t*)malloc(reader->capacity);
+    if (!reader->buffer) {
+        free(reader);
+        return NULL;
+    }
+    reader->read = read;
+    reader->ctx = ctx;
+    reader->start = 0;
+    reader->scanned = 0;
+    reader->end = 0;
+    reader->eof = false;
+    reader->error = false;
+    return reader;
 }
 
-void bs_string_free(bs_string* str) {
-    if (str) {
-        if (!str->is_view && str->data) {
-            free(str->data);
-        }
-        free(str);
+bs_line_reader* bs_line_reader_new_fd(int fd, size_t buffer_size) {
+    if (fd < 0) {
+        return NULL;
     }
+    return bs_line_reader_new(bs_read_fd_source, (void*)(intptr_t)fd, buffer_size);
 }
 
-// 字符串属性实现
-
-size_t bs_string_length(const bs_string* str) {
-    return str ? str->length : 0;
+bs_line_reader* bs_line_reader_new_file(FILE* file, size_t buffer_size) {
+    if (!file) {
+        return NULL;
+    }
+    return bs_line_reader_new(bs_read_file_source, file, buffer_size);
 }
 
-size_t bs_string_byte_length(const bs_string* str) {
-    return str ? str->byte_length : 0;
+void bs_line_reader_free(bs_line_reader* reader) {
+    if (!reader) {
+        return;
+    }
+    free(reader->buffer);
+    free(reader);
 }
 
-bs_encoding_t bs_string_encoding(const bs_string* str) {
-    return str ? str->encoding : BS_ENCODING_UTF8;
+bool bs_line_reader_error(const bs_line_reader* reader) {
+    return reader ? reader->error : false;
 }
 
-const char* bs_string_c_str(const bs_string* str) {
-    if (!str) {
-        return "";
+// 把未读完的部分移到开头并读入更多数据，返回false表示没有更多数据
+static bool bs_line_reader_fill(bs_line_reader* reader) {
+    if (reader->start > 0) {
+        size_t pending = reader->end - reader->start;
+        memmove(reader->buffer, reader->buffer + reader->start, pending);
+        reader->scanned -= reader->start;
+        reader->end = pending;
+        reader->start = 0;
     }
-    
-    // 确保字符串以null结尾
-    if (str->byte_length > 0 && str->data[str->byte_length - 1] != '\0') {
-        // 如果字符串不是以null结尾的，则创建一个新的
-        bs_string* new_str = bs_string_alloc(str->byte_length + 1, str->encoding);
-        if (!new_str) {
-            return "";
+    if (reader->end == reader->capacity) {
+        // 一行装不下整个缓冲区
+        size_t capacity = reader->capacity * 2;
+        uint8_t* buffer = (uint8_t*)realloc(reader->buffer, capacity);
+        if (!buffer) {
+            reader->error = true;
+            return false;
         }
-        
-        memcpy(new_str->data, str->data, str->byte_length);
-        new_str->data[str->byte_length] = '\0';
-        
-        // 这里简化了实现，实际上应该缓存结果
-        return (const char*)new_str->data;
+        reader->buffer = buffer;
+        reader->capacity = capacity;
     }
     
-    return (const char*)str->data;
+    ptrdiff_t result = reader->read(reader->ctx, reader->buffer + reader->end, reader->capacity - reader->end);
+    if (result < 0) {
+        reader->error = true;
+        return false;
+    }
+    if (result == 0) {
+        reader->eof = true;
+        return false;
+    }
+    reader->end += (size_t)result;
+    return true;
 }
 
-// 字符串操作实现
-
-bs_string* bs_string_substring(const bs_string* str, size_t start, size_t length) {
-    if (!str || start >= str->length) {
-        return bs_string_new("");
+static void bs_line_reader_emit(bs_line_reader* reader, size_t line_end, size_t next, bs_string* line) {
+    size_t begin = reader->start;
+    if (line_end > begin && reader->buffer[line_end - 1] == '\r') {
+        line_end--;
     }
-    
-    // 找到起始位置的字节偏移
-    size_t start_byte = 0;
-    size_t char_count = 0;
-    const uint8_t* data = str->data;
-    
-    while (char_count < start && start_byte < str->byte_length) {
-        start_byte += utf8_char_size(data + start_byte);
-        char_count++;
+    line->data = reader->buffer + begin;
+    line->byte_length = line_end - begin;
+    line->length = line_end > begin ? BS_LENGTH_UNKNOWN : 0;
+    line->encoding = BS_ENCODING_UTF8;
+    line->is_view = true;
+    line->hash_cached = false;
+    line->hash = 0;
+    reader->start = next;
+    reader->scanned = next;
+}
+
+bool bs_line_reader_next(bs_line_reader* reader, bs_string* line) {
+    if (!reader || !line || reader->error) {
+        return false;
     }
     
-    // 如果length超出了可能的范围，就调整它
-    if (start + length > str->length) {
-        length = str->length - start;
+    for (;;) {
+        // memchr在各平台的标准库中都已向量化
+        const uint8_t* newline = (const uint8_t*)memchr(reader->buffer + reader->scanned, '\n',
+                                                        reader->end - reader->scanned);
+        if (newline) {
+            size_t position = (size_t)(newline - reader->buffer);
+            bs_line_reader_emit(reader, position, position + 1, line);
+            return true;
+        }
+        reader->scanned = reader->end;
+        
+        if (reader->eof || !bs_line_reader_fill(reader)) {
+            if (reader->error || reader->start == reader->end) {
+                return false;
+            }
+            // 最后一行没有换行符
+            bs_line_reader_emit(reader, reader->end, reader->end, line);
+            return true;
+        }
     }
-    
-    // 找到结束位置的字节偏移
-    size_t end_byte = start_byte;
-    char_count = 0;
-    
-    while (char_count < length && end_byte < str->byte_length) {
-        end_byte += utf8_char_size(data + end_byte);
-        char_count++;
+}
+
+// 批量读取文件
+#define BS_LOAD_BATCH 256
+
+// 从fd的当前位置读到文件结束，str中已有filled字节。
+// exact表示str按普通文件的大小分配，读满即结束；否则读到文件结尾，文件比预计的大时扩容
+static bs_string* bs_load_rest(int fd, bs_string* str, size_t filled, bool exact, int* error) {
+    size_t capacity = str->byte_length;
+    for (;;) {
+        if (filled == capacity) {
+            if (exact) {
+                break;
+            }
+            // 缓冲区已满，先读一小块判断是否已经到达文件结尾，避免为大小正好的文件扩容
+            uint8_t probe[4096];
+#if defined(_WIN32)
+            int got = _read(fd, probe, sizeof(probe));
+#else
+            ssize_t got = read(fd, probe, sizeof(probe));
+#endif
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got < 0) {
+                *error = errno;
+                bs_string_free(str);
+                return NULL;
+            }
+            if (got == 0) {
+                break;
+            }
+            size_t new_capacity = capacity * 2 > capacity + (size_t)got ? capacity * 2 : capacity + (size_t)got;
+            uint8_t* data = (uint8_t*)realloc(str->data, new_capacity + 1);
+            if (!data) {
+                *error = ENOMEM;
+                bs_string_free(str);
+                return NULL;
+            }
+            str->data = data;
+            memcpy(str->data + filled, probe, (size_t)got);
+            filled += (size_t)got;
+            capacity = new_capacity;
+            continue;
+        }
+        
+#if defined(_WIN32)
+        size_t want = capacity - filled > 0x40000000 ? 0x40000000 : capacity - filled;
+        int got = _read(fd, str->data + filled, (unsigned)want);
+#else
+        ssize_t got = read(fd, str->data + filled, capacity - filled);
+#endif
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got < 0) {
+            *error = errno;
+            bs_string_free(str);
+            return NULL;
+        }
+        if (got == 0) {
+            break;
+        }
+        filled += (size_t)got;
     }
     
-    // 创建子字符串
-    return bs_string_new_len((const char*)(data + start_byte), end_byte - start_byte);
+    str->data[filled] = '\0';
+    str->byte_length = filled;
+    str->length = utf8_strlen((const char*)str->data, filled);
+    return str;
 }
 
-bs_string* bs_string_concat(const bs_string* str1, const bs_string* str2) {
-    if (!str1) {
-        return str2 ? bs_string_copy(str2) : bs_string_new("");
-    }
-    if (!str2) {
-        return bs_string_copy(str1);
+// 按fstat的大小分配字符串，大小未知（如/proc下的文件）时从4KB开始
+static bs_string* bs_load_alloc(int fd, bool* exact, int* error) {
+#if defined(_WIN32)
+    struct _stat64 info;
+    if (_fstat64(fd, &info) != 0) {
+#else
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+#endif
+        *error = errno;
+        return NULL;
     }
-    
-    // 分配足够大的空间来存储两个字符串
-    bs_string* result = bs_string_alloc(str1->byte_length + str2->byte_length, BS_ENCODING_UTF8);
-    if (!result) {
+    if ((unsigned long long)info.st_size >= SIZE_MAX) {
+        *error = EFBIG;
         return NULL;
     }
-    
-    // 复制两个字符串的内容
-    memcpy(result->data, str1->data, str1->byte_length);
-    memcpy(result->data + str1->byte_length, str2->data, str2->byte_length);
-    
-    result->byte_length = str1->byte_length + str2->byte_length;
-    result->length = str1->length + str2->length;
-    
-    return result;
-}
-
-bs_string* bs_string_append(bs_string* str, const bs_string* append) {
+    // 普通文件按大小读满即可，不需要再读一次确认文件结尾
+#if defined(_WIN32)
+    *exact = (info.st_mode & _S_IFREG) != 0 && info.st_size > 0;
+#else
+    *exact = S_ISREG(info.st_mode) && info.st_size > 0;
+#endif
+    size_t size = *exact ? (size_t)info.st_size : 4096;
+    bs_string* str = bs_string_alloc(size, BS_ENCODING_UTF8);
     if (!str) {
-        return append ? bs_string_copy(append) : NULL;
+        *error = ENOMEM;
+    }
+    return str;
+}
+
+static bs_string* bs_load_file_sync(const char* path, int* error) {
+#if defined(_WIN32)
+    int fd = _open(path, _O_RDONLY | _O_BINARY);
+#else
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+#endif
+    if (fd < 0) {
+        *error = errno;
+        return NULL;
     }
-    if (!append || append->byte_length == 0) {
-        return str;
+    bool exact = false;
+    bs_string* str = bs_load_alloc(fd, &exact, error);
+    if (str) {
+        str = bs_load_rest(fd, str, 0, exact, error);
     }
-    
-    // 创建一个新的字符串来存储结果
-    bs_string* result = bs_string_concat(str, append);
-    
-    // 释放原始字符串
-    bs_string_free(str);
-    
-    return result;
+#if defined(_WIN32)
+    _close(fd);
+#else
+    close(fd);
+#endif
+    return str;
 }
 
-bs_string* bs_string_append_cstr(bs_string* str, const char* append) {
-    if (!append) {
-        return str;
+#ifdef BS_HAVE_IO_URING
+typedef struct bs_uring {
+    int fd;
+    unsigned entries;
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    struct io_uring_sqe* sqes;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    struct io_uring_cqe* cqes;
+    void* sq_ring;
+    size_t sq_ring_size;
+    void* cq_ring;
+    size_t cq_ring_size;
+    size_t sqes_size;
+    bool stuck;              // 出错后无法确认已提交的请求都已完成，相关缓冲区不能再使用
+} bs_uring;
+
+static void bs_uring_exit(bs_uring* ring) {
+    if (ring->sqes) {
+        munmap(ring->sqes, ring->sqes_size);
     }
-    
-    // 创建临时字符串
-    bs_string* append_str = bs_string_new(append);
-    if (!append_str) {
-        return str;
+    if (ring->cq_ring && ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
     }
-    
-    // 追加并释放临时字符串
-    bs_string* result = bs_string_append(str, append_str);
-    bs_string_free(append_str);
-    
-    return result;
+    if (ring->sq_ring) {
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    }
+    close(ring->fd);
 }
 
-// 基本的查找操作
-bool bs_string_contains_cstr(const bs_string* str, const char* find) {
-    if (!str || !find) {
+// 建立队列，内核不支持或被seccomp禁止时返回false
+static bool bs_uring_init(bs_uring* ring, unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0) {
         return false;
     }
     
-    bs_string* find_str = bs_string_new(find);
-    if (!find_str) {
+    ring->entries = params.sq_entries;
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_ring_size > ring->sq_ring_size) {
+            ring->sq_ring_size = ring->cq_ring_size;
+        }
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        ring->sq_ring = NULL;
+        bs_uring_exit(ring);
+        return false;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ring = ring->sq_ring;
+    } else {
+        ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd,
+                             IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED) {
+            ring->cq_ring = NULL;
+            bs_uring_exit(ring);
+            return false;
+        }
+    }
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = (struct io_uring_sqe*)mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd,
+                                            IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        ring->sqes = NULL;
+        bs_uring_exit(ring);
         return false;
     }
     
-    bool result = bs_string_contains(str, find_str);
-    bs_string_free(find_str);
-    
-    return result;
+    uint8_t* sq = (uint8_t*)ring->sq_ring;
+    uint8_t* cq = (uint8_t*)ring->cq_ring;
+    ring->sq_head = (unsigned*)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned*)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned*)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    return true;
 }
 
-bool bs_string_contains(const bs_string* str, const bs_string* find) {
-    if (!str || !find) {
-        return false;
+// 取下一个提交项，调用者保证一批不超过队列长度
+static struct io_uring_sqe* bs_uring_sqe(bs_uring* ring, unsigned* pending) {
+    unsigned tail = *ring->sq_tail + *pending;
+    unsigned index = tail & *ring->sq_mask;
+    struct io_uring_sqe* sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sq_array[index] = index;
+    (*pending)++;
+    return sqe;
+}
+
+// 提交pending个请求并等待全部完成，对每个完成项调用handle
+static bool bs_uring_run(bs_uring* ring, unsigned pending, void (*handle)(void* ctx, uint64_t tag, int result),
+                         void* ctx) {
+    // 内核通过release/acquire与我们同步队列的头尾
+    unsigned base = *ring->sq_tail;
+    __atomic_store_n(ring->sq_tail, base + pending, __ATOMIC_RELEASE);
+    unsigned submitted = 0;
+    unsigned done = 0;
+    bool ok = true;
+    while (done < pending) {
+        // 出错后不再提交，但必须等已提交的请求全部完成，之后调用者才能复用缓冲区和文件描述符
+        unsigned to_submit = ok ? pending - submitted : 0;
+        unsigned wait = ok ? pending - done : submitted - done;
+        if (wait == 0) {
+            break;
+        }
+        int result = (int)syscall(__NR_io_uring_enter, ring->fd, to_submit, wait, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (result < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                continue;
+            }
+            if (!ok) {
+                ring->stuck = true;
+                return false;
+            }
+            ok = false;
+            submitted = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) - base;
+            continue;
+        }
+        // 内核取走提交项时推进队列头，出错时也能知道哪些请求已经提交
+        submitted = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) - base;
+        
+        unsigned head = *ring->cq_head;
+        unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_mask];
+            handle(ctx, cqe->user_data, cqe->res);
+            done++;
+        }
+        __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
     }
-    
-    return bs_string_find(str, find, 0) >= 0;
+    return ok;
 }
 
-int64_t bs_string_find_cstr(const bs_string* str, const char* find, size_t start_pos) {
-    if (!str || !find) {
-        return -1;
+typedef struct bs_load_slot {
+    int fd;
+    int error;
+    bool exact;
+    bs_string* str;
+    size_t filled;
+} bs_load_slot;
+
+static void bs_load_opened(void* ctx, uint64_t tag, int result) {
+    bs_load_slot* slot = &((bs_load_slot*)ctx)[tag];
+    if (result >= 0) {
+        slot->fd = result;
+    } else {
+        slot->error = -result;
     }
-    
-    bs_string* find_str = bs_string_new(find);
-    if (!find_str) {
-        return -1;
+}
+
+static void bs_load_read(void* ctx, uint64_t tag, int result) {
+    bs_load_slot* slot = &((bs_load_slot*)ctx)[tag];
+    if (result >= 0) {
+        slot->filled = (size_t)result;
+    } else {
+        slot->error = -result;
     }
-    
-    int64_t result = bs_string_find(str, find_str, start_pos);
-    bs_string_free(find_str);
-    
-    return result;
 }
 
-int64_t bs_string_find(const bs_string* str, const bs_string* find, size_t start_pos) {
-    if (!str || !find || start_pos >= str->length || find->length == 0) {
-        return -1;
+// 用io_uring读取一批文件，每个文件都会调用一次回调；队列出错时返回false，未处理的文件交给同步路径
+static bool bs_load_batch_uring(bs_uring* ring, const char* const* paths, size_t first, size_t count,
+                                bs_load_callback callback, void* user, size_t* loaded, size_t* next) {
+    bs_load_slot slots[BS_LOAD_BATCH];
+    unsigned pending = 0;
+    for (size_t i = 0; i < count; i++) {
+        slots[i].fd = -1;
+        slots[i].error = 0;
+        slots[i].str = NULL;
+        slots[i].filled = 0;
+        if (!paths[first + i]) {
+            slots[i].error = EINVAL;
+            continue;
+        }
+        struct io_uring_sqe* sqe = bs_uring_sqe(ring, &pending);
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = (uint64_t)(uintptr_t)paths[first + i];
+        sqe->open_flags = O_RDONLY | O_CLOEXEC;
+        sqe->user_data = i;
+    }
+    if (!bs_uring_run(ring, pending, bs_load_opened, slots)) {
+        // 已完成的打开请求都已收到结果，关闭得到的文件描述符后整批交给同步路径
+        for (size_t i = 0; i < count; i++) {
+            if (slots[i].fd >= 0) {
+                close(slots[i].fd);
+            }
+        }
+        return false;
     }
     
-    // 简单的Naive字符串匹配算法
-    // 在实际实现中，应该使用更高效的算法如KMP或Boyer-Moore
-    
-    // 找到起始位置的字节偏移
-    size_t start_byte = 0;
-    size_t char_count = 0;
-    
-    while (char_count < start_pos && start_byte < str->byte_length) {
-        start_byte += utf8_char_size(str->data + start_byte);
-        char_count++;
+    // 打开成功的文件按大小分配字符串，读取请求直接写入字符串的缓冲区
+    pending = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (slots[i].fd < 0) {
+            continue;
+        }
+        slots[i].str = bs_load_alloc(slots[i].fd, &slots[i].exact, &slots[i].error);
+        if (!slots[i].str) {
+            continue;
+        }
+        struct io_uring_sqe* sqe = bs_uring_sqe(ring, &pending);
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = slots[i].fd;
+        sqe->addr = (uint64_t)(uintptr_t)slots[i].str->data;
+        sqe->len = slots[i].str->byte_length > 0x7FFFF000 ? 0x7FFFF000u : (unsigned)slots[i].str->byte_length;
+        sqe->off = 0;
+        sqe->user_data = i;
     }
+    bool ok = bs_uring_run(ring, pending, bs_load_read, slots);
     
-    // 查找子字符串
-    for (size_t i = start_byte; i <= str->byte_length - find->byte_length; i++) {
-        if (memcmp(str->data + i, find->data, find->byte_length) == 0) {
-            // 找到匹配，计算字符位置
-            size_t pos = 0;
-            for (size_t j = 0; j < i; j += utf8_char_size(str->data + j)) {
-                pos++;
+    for (size_t i = 0; i < count; i++) {
+        bs_load_slot* slot = &slots[i];
+        bs_string* str = NULL;
+        int error = slot->error;
+        if (slot->str && ring->stuck) {
+            // 读取请求可能仍在内核中执行，随时会写入这个缓冲区：
+            // 关闭队列也不会同步等待请求结束，只能放弃缓冲区，重新打开文件同步读取
+            error = 0;
+            str = bs_load_file_sync(paths[first + i], &error);
+        } else if (slot->str) {
+            if (!ok || error == EINVAL || error == EOPNOTSUPP) {
+                // 队列出错或内核不支持该操作，从头同步读取
+                error = 0;
+                if (lseek(slot->fd, 0, SEEK_SET) == 0) {
+                    str = bs_load_rest(slot->fd, slot->str, 0, slot->exact, &error);
+                } else {
+                    error = errno;
+                    bs_string_free(slot->str);
+                }
+            } else if (error) {
+                bs_string_free(slot->str);
+            } else if ((slot->exact && slot->filled == slot->str->byte_length) ||
+                       lseek(slot->fd, (off_t)slot->filled, SEEK_SET) == (off_t)slot->filled) {
+                // 读取可能不完整，剩余部分同步读完
+                str = bs_load_rest(slot->fd, slot->str, slot->filled, slot->exact, &error);
+            } else {
+                error = errno;
+                bs_string_free(slot->str);
             }
-            return pos;
+        } else if (slot->fd < 0 && paths[first + i] && (error == EINVAL || error == EOPNOTSUPP)) {
+            // 内核不支持IORING_OP_OPENAT（5.6之前）
+            error = 0;
+            str = bs_load_file_sync(paths[first + i], &error);
+        }
+        if (slot->fd >= 0) {
+            close(slot->fd);
         }
+        if (str) {
+            (*loaded)++;
+        }
+        callback(user, first + i, str, str ? 0 : error);
     }
-    
-    return -1;
+    *next = first + count;
+    return ok;
 }
+#endif
 
-// 其他函数的实现会根据需要添加
-
-/**
- * 计算字符串中单词的数量
- * 单词由空格、制表符或换行符分隔
- */
-size_t bs_string_word_count(const bs_string* str) {
-    if (!str || !str->data || str->byte_length == 0) {
+size_t bs_load_files(const char* const* paths, size_t count, bs_load_callback callback, void* user) {
+    if (!paths || !callback) {
         return 0;
     }
     
-    const char* cstr = (const char*)str->data;
-    size_t count = 0;
-    bool in_word = false;
-    
-    for (size_t i = 0; i < str->byte_length; i++) {
-        // 判断当前字符是否为空白字符
-        bool is_space = isspace(cstr[i]);
-        
-        // 当从空白字符进入非空白字符时，单词计数增加
-        if (!is_space && !in_word) {
-            count++;
+    size_t loaded = 0;
+    size_t next = 0;
+#ifdef BS_HAVE_IO_URING
+    bs_uring ring;
+    if (count > 1 && bs_uring_init(&ring, BS_LOAD_BATCH)) {
+        size_t batch = ring.entries < BS_LOAD_BATCH ? ring.entries : BS_LOAD_BATCH;
+        while (next < count) {
+            size_t n = count - next < batch ? count - next : batch;
+            if (!bs_load_batch_uring(&ring, paths, next, n, callback, user, &loaded, &next)) {
+                break;
+            }
         }
-        
-        // 更新状态
-        in_word = !is_space;
+        bs_uring_exit(&ring);
     }
+#endif
     
-    return count;
+    for (; next < count; next++) {
+        int error = 0;
+        bs_string* str = paths[next] ? bs_load_file_sync(paths[next], &error) : NULL;
+        if (!paths[next]) {
+            error = EINVAL;
+        }
+        if (str) {
+            loaded++;
+        }
+        callback(user, next, str, str ? 0 : error);
+    }
+    return loaded;
 }
 
-/**
- * 将字符串首字母大写（每个单词的首字母变为大写，其余为小写）
- */
-bs_string* bs_string_capitalize(const bs_string* str) {
-    if (!str) {
+// 流式子串查找
+// 块内的匹配交给bs_find_bytes；跨块的匹配用KMP前缀表续接，
+// 每块只在开头和结尾各多处理不超过needle长度的字节
+struct bs_stream_searcher {
+    uint8_t* needle;
+    size_t* border;          // border[k]：needle前k+1字节最长的真前后缀长度
+    size_t needle_length;
+    size_t matched;          // 已输入数据的最长后缀同时是needle真前缀的长度
+    uint64_t offset;         // 已输入的总字节数
+};
+
+bs_stream_searcher* bs_stream_searcher_new(const uint8_t* needle, size_t needle_length) {
+    if (!needle && needle_length > 0) {
         return NULL;
     }
     
-    // 先创建一个字符串的副本
-    bs_string* result = bs_string_copy(str);
-    if (!result) {
+    bs_stream_searcher* searcher = (bs_stream_searcher*)malloc(sizeof(bs_stream_searcher));
+    if (!searcher) {
         return NULL;
     }
-    
-    bool capitalize_next = true;
-    uint8_t* data = result->data;
-    
-    for (size_t i = 0; i < result->byte_length;) {
-        // 只处理ASCII字符，保留非ASCII字符不变
-        if ((data[i] & 0x80) == 0) {
-            if (isalpha(data[i])) {
-                if (capitalize_next) {
-                    data[i] = toupper(data[i]);
-                    capitalize_next = false;
-                } else {
-                    data[i] = tolower(data[i]);
-                }
-            } else if (isspace(data[i]) || ispunct(data[i])) {
-                capitalize_next = true;
-            }
-            i++;
-        } else {
-            // 跳过非ASCII字符
-            i += utf8_char_size(data + i);
-            capitalize_next = false;
+    searcher->needle = (uint8_t*)malloc(needle_length ? needle_length : 1);
+    searcher->border = (size_t*)malloc((needle_length ? needle_length : 1) * sizeof(size_t));
+    if (!searcher->needle || !searcher->border) {
+        free(searcher->needle);
+        free(searcher->border);
+        free(searcher);
+        return NULL;
+    }
+    if (needle_length > 0) {
+        memcpy(searcher->needle, needle, needle_length);
+        searcher->border[0] = 0;
+    }
+    size_t k = 0;
+    for (size_t i = 1; i < needle_length; i++) {
+        while (k > 0 && needle[i] != needle[k]) {
+            k = searcher->border[k - 1];
         }
+        if (needle[i] == needle[k]) {
+            k++;
+        }
+        searcher->border[i] = k;
     }
-    
-    return result;
+    searcher->needle_length = needle_length;
+    searcher->matched = 0;
+    searcher->offset = 0;
+    return searcher;
 }
 
-/**
- * 反转字符串内容
- * 注意：这个函数需要正确处理UTF-8编码
- */
-bs_string* bs_string_reverse(const bs_string* str) {
-    if (!str) {
-        return NULL;
+void bs_stream_searcher_free(bs_stream_searcher* searcher) {
+    if (!searcher) {
+        return;
     }
-    
-    // 特殊情况：空字符串或者只有一个字符
-    if (str->byte_length <= 1) {
-        return bs_string_copy(str);
+    free(searcher->needle);
+    free(searcher->border);
+    free(searcher);
+}
+
+void bs_stream_searcher_reset(bs_stream_searcher* searcher) {
+    if (searcher) {
+        searcher->matched = 0;
+        searcher->offset = 0;
+    }
+}
+
+uint64_t bs_stream_searcher_offset(const bs_stream_searcher* searcher) {
+    return searcher ? searcher->offset : 0;
+}
+
+// KMP前进一个字节，返回新的已匹配长度，等于needle_length时表示完整匹配
+static size_t bs_stream_searcher_step(const bs_stream_searcher* searcher, size_t matched, uint8_t byte) {
+    while (matched > 0 && searcher->needle[matched] != byte) {
+        matched = searcher->border[matched - 1];
+    }
+    if (searcher->needle[matched] == byte) {
+        matched++;
+    }
+    return matched;
+}
+
+size_t bs_stream_searcher_feed(bs_stream_searcher* searcher, const uint8_t* data, size_t length,
+                               bs_match_fn callback, void* user) {
+    if (!searcher || (!data && length > 0)) {
+        return 0;
     }
     
-    // 创建一个新的字符串
-    bs_string* result = bs_string_alloc(str->byte_length, str->encoding);
-    if (!result) {
-        return NULL;
+    size_t n = searcher->needle_length;
+    uint64_t base = searcher->offset;
+    size_t count = 0;
+    searcher->offset += length;
+    if (n == 0) {
+        return 0;
     }
     
-    if (str->encoding == BS_ENCODING_UTF8) {
-        // UTF-8编码需要特殊处理，按字符反转而不是按字节
-        size_t pos = 0;
-        size_t char_count = str->length;
-        
-        // 创建一个数组来存储每个字符的字节偏移量
-        size_t* char_offsets = (size_t*)malloc((char_count + 1) * sizeof(size_t));
-        if (!char_offsets) {
-            bs_string_free(result);
-            return NULL;
+    size_t matched = searcher->matched;
+    if (length < n - 1) {
+        // 块比needle短，逐字节续接即可
+        for (size_t i = 0; i < length; i++) {
+            matched = bs_stream_searcher_step(searcher, matched, data[i]);
+            if (matched == n) {
+                if (callback) {
+                    callback(user, base + i + 1 - n);
+                }
+                count++;
+                matched = searcher->border[n - 1];
+            }
         }
-        
-        // 计算每个字符的字节偏移量
-        char_offsets[0] = 0;
-        size_t char_index = 1;
-        for (size_t i = 0; i < str->byte_length && char_index <= char_count;) {
-            size_t char_size = utf8_char_size(str->data + i);
-            i += char_size;
-            char_offsets[char_index] = i;
-            char_index++;
+        searcher->matched = matched;
+        return count;
+    }
+    
+    // 起点在之前的块中的匹配：只在部分匹配仍从块开头之前开始时续接
+    for (size_t i = 0; i < length && matched > i; i++) {
+        matched = bs_stream_searcher_step(searcher, matched, data[i]);
+        if (matched == n) {
+            if (callback) {
+                callback(user, base + i + 1 - n);
+            }
+            count++;
+            matched = searcher->border[n - 1];
         }
-        
-        // 反向复制每个字符
-        for (size_t i = char_count; i > 0; i--) {
-            size_t char_start = char_offsets[i - 1];
-            size_t char_size = (i < char_count) ? (char_offsets[i] - char_offsets[i - 1]) : (str->byte_length - char_offsets[i - 1]);
-            
-            memcpy(result->data + pos, str->data + char_start, char_size);
-            pos += char_size;
+    }
+    
+    // 完全落在本块内的匹配
+    size_t pos = 0;
+    while (pos + n <= length) {
+        size_t found = pos + bs_find_bytes(data + pos, length - pos, searcher->needle, n);
+        if (found + n > length) {
+            break;
         }
-        
-        free(char_offsets);
-    } else {
-        // 对于ASCII或其他单字节编码，可以简单地按字节反向复制
-        for (size_t i = 0; i < str->byte_length; i++) {
-            result->data[i] = str->data[str->byte_length - 1 - i];
+        if (callback) {
+            callback(user, base + found);
         }
+        count++;
+        pos = found + 1;
     }
     
-    result->length = str->length;
-    result->byte_length = str->byte_length;
-    result->data[result->byte_length] = '\0';
-    
-    return result;
+    // 为下一块重新计算已匹配长度：它不超过n-1，只取决于块末尾的n-1个字节
+    matched = 0;
+    for (size_t i = length - (n - 1); i < length; i++) {
+        matched = bs_stream_searcher_step(searcher, matched, data[i]);
+    }
+    searcher->matched = matched;
+    return count;
 }
 
 #endif // BETTER_STRING_IMPLEMENTATION
@@ -10,6 +10,7 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <optional>
@@ -18,8 +19,28 @@
 #include <cstdarg>
 #include <algorithm>
 #include <sstream>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <array>
+#include <stdexcept>
+#include <utility>
+#include <iterator>
+#include <atomic>
+#include <exception>
+#include <system_error>
+#include <cerrno>
+#include <initializer_list>
 #include <codecvt>
 
+// C++20协程：bs::AsyncGenerator、bs::async_split和bs::async_lines
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define BS_HAVE_COROUTINES 1
+#endif
+#endif
+
 // 首先包含C实现（需要在使用前定义BETTER_STRING_IMPLEMENTATION）
 #ifndef BETTER_STRING_IMPLEMENTATION
 #define BETTER_STRING_IMPLEMENTATION
@@ -28,8 +49,169 @@
 // 现在包含C实现
 #include "better_string_single.h"
 
+// 定义为1时bs::String默认开启写时复制，也可以对单个字符串调用setCopyOnWrite
+#ifndef BETTER_STRING_COW
+#define BETTER_STRING_COW 0
+#endif
+
 namespace bs {
 
+/**
+ * 惰性分割范围
+ *
+ * 按需产生字段视图（std::string_view），不复制数据也不分配字段。
+ * 被分割的字符串在迭代期间必须保持有效。
+ */
+class SplitRange {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = std::string_view;
+        using pointer = const std::string_view*;
+        using reference = const std::string_view&;
+        
+        iterator() : m_done(true) {}
+        
+        explicit iterator(const bs_split_iter& it) : m_it(it), m_done(false) {
+            advance();
+        }
+        
+        reference operator*() const {
+            return m_field;
+        }
+        
+        pointer operator->() const {
+            return &m_field;
+        }
+        
+        iterator& operator++() {
+            advance();
+            return *this;
+        }
+        
+        iterator operator++(int) {
+            iterator tmp = *this;
+            advance();
+            return tmp;
+        }
+        
+        bool operator==(const iterator& other) const {
+            // 只有结束状态之间相等，满足范围for的需要
+            return m_done && other.m_done;
+        }
+        
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+        
+    private:
+        void advance() {
+            bs_string field;
+            if (!m_done && bs_split_iter_next(&m_it, &field)) {
+                m_field = std::string_view(reinterpret_cast<const char*>(field.data), field.byte_length);
+            } else {
+                m_done = true;
+                m_field = std::string_view();
+            }
+        }
+        
+        bs_split_iter m_it;
+        std::string_view m_field;
+        bool m_done;
+    };
+    
+    SplitRange(const bs_string* str, std::string delimiter, size_t maxSplits = 0, unsigned flags = 0)
+        : m_str(str), m_delimiter(std::move(delimiter)), m_maxSplits(maxSplits), m_flags(flags) {}
+    
+    iterator begin() const {
+        bs_split_iter it;
+        bs_split_iter_init(&it, m_str, m_delimiter.c_str(), m_maxSplits, m_flags);
+        return iterator(it);
+    }
+    
+    iterator end() const {
+        return iterator();
+    }
+    
+private:
+    const bs_string* m_str;
+    std::string m_delimiter;     // 迭代器引用这里的分隔符，范围必须比迭代器活得久
+    size_t m_maxSplits;
+    unsigned m_flags;
+};
+
+/**
+ * 紧凑字符串数组
+ *
+ * bs_compact_array的RAII包装：所有字段存放在一个连续缓冲区中，
+ * 下标访问返回std::string_view，释放只需一次调用。
+ */
+class CompactArray {
+public:
+    explicit CompactArray(bs_compact_array* array = nullptr) : m_array(array) {}
+    
+    CompactArray(const CompactArray&) = delete;
+    CompactArray& operator=(const CompactArray&) = delete;
+    
+    CompactArray(CompactArray&& other) noexcept : m_array(other.m_array) {
+        other.m_array = nullptr;
+    }
+    
+    CompactArray& operator=(CompactArray&& other) noexcept {
+        if (this != &other) {
+            bs_compact_array_free(m_array);
+            m_array = other.m_array;
+            other.m_array = nullptr;
+        }
+        return *this;
+    }
+    
+    ~CompactArray() {
+        bs_compact_array_free(m_array);
+    }
+    
+    size_t size() const {
+        return m_array ? m_array->length : 0;
+    }
+    
+    bool empty() const {
+        return size() == 0;
+    }
+    
+    std::string_view operator[](size_t index) const {
+        const size_t* offsets = m_array->offsets;
+        return std::string_view(reinterpret_cast<const char*>(m_array->data) + offsets[index],
+                                offsets[index + 1] - offsets[index]);
+    }
+    
+    // 原始缓冲区和偏移，可直接交给列式处理代码
+    const uint8_t* data() const {
+        return m_array ? m_array->data : nullptr;
+    }
+    
+    const size_t* offsets() const {
+        return m_array ? m_array->offsets : nullptr;
+    }
+    
+    bs_compact_array* get() const {
+        return m_array;
+    }
+    
+private:
+    bs_compact_array* m_array;
+};
+
+namespace detail {
+struct FormatAccess;
+
+// 写时复制共享数据的引用计数
+struct SharedCount {
+    std::atomic<size_t> refs{1};
+};
+}
+
 /**
  * 字符串类
  */
@@ -42,10 +224,17 @@ public:
     
     String(const std::string& str) : m_str(bs_string_new_len(str.c_str(), str.length())) {}
     
-    String(const String& other) : m_str(bs_string_copy(other.m_str)) {}
+    /**
+     * 开启写时复制的字符串在复制时只增加引用计数，第一次修改时才复制数据
+     */
+    String(const String& other) : m_str(nullptr), m_cow(other.m_cow) {
+        copyFrom(other);
+    }
     
-    String(String&& other) noexcept : m_str(other.m_str) {
+    String(String&& other) noexcept
+        : m_str(other.m_str), m_shared(other.m_shared.load(std::memory_order_relaxed)), m_cow(other.m_cow) {
         other.m_str = nullptr;
+        other.m_shared.store(nullptr, std::memory_order_relaxed);
     }
     
     explicit String(bs_string* str, bool own = true) : m_str(own ? str : bs_string_copy(str)) {}
@@ -58,7 +247,8 @@ public:
     String& operator=(const String& other) {
         if (this != &other) {
             freeString();
-            m_str = bs_string_copy(other.m_str);
+            m_cow = other.m_cow;
+            copyFrom(other);
         }
         return *this;
     }
@@ -67,11 +257,26 @@ public:
         if (this != &other) {
             freeString();
             m_str = other.m_str;
+            m_shared.store(other.m_shared.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            m_cow = other.m_cow;
             other.m_str = nullptr;
+            other.m_shared.store(nullptr, std::memory_order_relaxed);
         }
         return *this;
     }
     
+    void swap(String& other) noexcept {
+        std::swap(m_str, other.m_str);
+        detail::SharedCount* shared = m_shared.load(std::memory_order_relaxed);
+        m_shared.store(other.m_shared.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other.m_shared.store(shared, std::memory_order_relaxed);
+        std::swap(m_cow, other.m_cow);
+    }
+    
+    friend void swap(String& a, String& b) noexcept {
+        a.swap(b);
+    }
+    
     String& operator=(const char* str) {
         freeString();
         m_str = bs_string_new(str);
@@ -114,6 +319,16 @@ public:
         return std::string(c_str(), byteLength());
     }
     
+    /**
+     * 获取引用内部数据的视图，不复制
+     */
+    std::string_view view() const {
+        if (!m_str) {
+            return std::string_view();
+        }
+        return std::string_view(reinterpret_cast<const char*>(m_str->data), m_str->byte_length);
+    }
+    
     std::u16string toUtf16() const {
         // 简单实现，使用标准库转换UTF-8到UTF-16
         std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t> converter;
@@ -136,16 +351,19 @@ public:
     }
     
     String& append(const String& str) {
+        detach();
         m_str = bs_string_append(m_str, str.m_str);
         return *this;
     }
     
     String& append(const char* str) {
+        detach();
         m_str = bs_string_append_cstr(m_str, str);
         return *this;
     }
     
     String& append(const std::string& str) {
+        detach();
         m_str = bs_string_append_cstr(m_str, str.c_str());
         return *this;
     }
@@ -171,6 +389,7 @@ public:
     
     // 修改
     String& insert(size_t position, const String& str) {
+        detach();
         bs_string* result = bs_string_insert(m_str, position, str.m_str);
         if (result != m_str) {
             bs_string_free(m_str);
@@ -180,6 +399,7 @@ public:
     }
     
     String& erase(size_t position, size_t length = std::string::npos) {
+        detach();
         if (length == std::string::npos) {
             length = this->length() - position;
         }
@@ -192,6 +412,7 @@ public:
     }
     
     String& replace(const String& from, const String& to) {
+        detach();
         bs_string* result = bs_string_replace(m_str, from.m_str, to.m_str);
         if (result != m_str) {
             bs_string_free(m_str);
@@ -201,13 +422,28 @@ public:
     }
     
     String& replaceAll(const String& from, const String& to) {
-        // 简单实现，循环替换所有匹配
-        size_t start_pos = 0;
-        while ((start_pos = find(from, start_pos)) != std::string::npos) {
-            replace(from, to);
-            start_pos += to.length();
+        // 从左到右扫描一遍拼出结果，替换进去的文本不会再被匹配
+        std::string_view text = view();
+        std::string_view pattern = from.view();
+        std::string_view replacement = to.view();
+        if (pattern.empty()) {
+            return *this;
         }
-        return *this;
+        size_t pos = text.find(pattern);
+        if (pos == std::string_view::npos) {
+            return *this;
+        }
+        
+        std::string result;
+        result.reserve(text.size());
+        size_t last = 0;
+        for (; pos != std::string_view::npos; pos = text.find(pattern, last)) {
+            result.append(text.data() + last, pos - last);
+            result.append(replacement.data(), replacement.size());
+            last = pos + pattern.size();
+        }
+        result.append(text.data() + last, text.size() - last);
+        return *this = result;
     }
     
     /**
@@ -215,6 +451,7 @@ public:
      * @return 对当前字符串的引用，用于链式调用
      */
     String& capitalize() {
+        detach();
         bs_string* result = bs_string_capitalize(m_str);
         if (result != m_str) {
             bs_string_free(m_str);
@@ -228,6 +465,7 @@ public:
      * @return 对当前字符串的引用，用于链式调用
      */
     String& reverse() {
+        detach();
         bs_string* result = bs_string_reverse(m_str);
         if (result != m_str) {
             bs_string_free(m_str);
@@ -305,36 +543,42 @@ public:
         return bs_string_ends_with(m_str, suffix.m_str);
     }
     
-    // 修饰
-    String& trim() {
-        bs_string* result = bs_string_trim(m_str);
-        if (result != m_str) {
-            bs_string_free(m_str);
-            m_str = result;
+    // 修饰（原地修剪，不重新分配内存）
+    String& trim(unsigned flags = BS_TRIM_BOTH) {
+        detach();
+        // 只传BS_TRIM_UNICODE时默认修剪两端
+        if ((flags & BS_TRIM_BOTH) == 0) {
+            flags |= BS_TRIM_BOTH;
         }
+        bs_string_trim_inplace(m_str, flags);
         return *this;
     }
     
-    String& trimLeft() {
-        bs_string* result = bs_string_trim_start(m_str);
-        if (result != m_str) {
-            bs_string_free(m_str);
-            m_str = result;
-        }
+    String& trimLeft(unsigned flags = 0) {
+        detach();
+        bs_string_trim_inplace(m_str, (flags & BS_TRIM_UNICODE) | BS_TRIM_START);
         return *this;
     }
     
-    String& trimRight() {
-        bs_string* result = bs_string_trim_end(m_str);
-        if (result != m_str) {
-            bs_string_free(m_str);
-            m_str = result;
-        }
+    String& trimRight(unsigned flags = 0) {
+        detach();
+        bs_string_trim_inplace(m_str, (flags & BS_TRIM_UNICODE) | BS_TRIM_END);
         return *this;
     }
     
+    /**
+     * 返回修剪后的视图，不复制数据
+     * @param flags bs_trim_flags的组合，默认修剪两端ASCII空白
+     * @return 引用当前字符串内存的视图，字符串修改或销毁后失效
+     */
+    std::string_view trimView(unsigned flags = BS_TRIM_BOTH) const {
+        bs_string view = bs_string_trim_view(m_str, flags);
+        return std::string_view(reinterpret_cast<const char*>(view.data), view.byte_length);
+    }
+    
     // 修改操作
     String& toLower() {
+        detach();
         bs_string* result = bs_string_to_lower(m_str);
         if (result != m_str) {
             bs_string_free(m_str);
@@ -344,6 +588,7 @@ public:
     }
     
     String& toUpper() {
+        detach();
         bs_string* result = bs_string_to_upper(m_str);
         if (result != m_str) {
             bs_string_free(m_str);
@@ -404,17 +649,74 @@ public:
         return result;
     }
     
+    /**
+     * 惰性分割，逐个产生字段视图而不复制
+     * @param delimiter 分隔符
+     * @param maxSplits 最大分割次数，0表示不限制
+     * @param flags bs_split_flags的组合，例如BS_SPLIT_SKIP_EMPTY
+     * @return 可用于范围for的SplitRange，当前字符串修改或销毁后失效
+     */
+    SplitRange splitView(const char* delimiter, size_t maxSplits = 0, unsigned flags = 0) const {
+        return SplitRange(m_str, delimiter ? delimiter : "", maxSplits, flags);
+    }
+    
+    /**
+     * 分割为紧凑数组，所有字段共享一个缓冲区
+     */
+    CompactArray splitCompact(const char* delimiter, size_t maxSplits = 0, unsigned flags = 0) const {
+        return CompactArray(bs_string_split_compact(m_str, delimiter, maxSplits, flags));
+    }
+    
+    static String join(const CompactArray& strings, const char* delimiter) {
+        return String(bs_string_join_compact(strings.get(), delimiter));
+    }
+    
     static String join(const std::vector<String>& strings, const String& delimiter) {
-        if (strings.empty()) {
+        return join(strings, delimiter.view());
+    }
+    
+    /**
+     * 连接任意范围内的字符串，先统计总长度再一次分配
+     * @param parts 元素为String、std::string、std::string_view、const char*或bs_string的范围，
+     *              会被遍历两次，因此必须是前向范围
+     * @param delimiter 分隔符
+     * @return 连接后的字符串
+     */
+    template <typename Range>
+    static String join(const Range& parts, std::string_view delimiter) {
+        size_t count = 0;
+        size_t total = 0;
+        for (const auto& part : parts) {
+            total += partView(part).size();
+            count++;
+        }
+        if (count == 0) {
             return String();
         }
+        total += delimiter.size() * (count - 1);
         
-        String result = strings[0];
-        for (size_t i = 1; i < strings.size(); ++i) {
-            result.append(delimiter).append(strings[i]);
+        bs_string* result = bs_string_alloc(total, BS_ENCODING_UTF8);
+        if (!result) {
+            throw std::bad_alloc();
         }
         
-        return result;
+        uint8_t* out = result->data;
+        bool first = true;
+        for (const auto& part : parts) {
+            if (!first && !delimiter.empty()) {
+                std::memcpy(out, delimiter.data(), delimiter.size());
+                out += delimiter.size();
+            }
+            std::string_view view = partView(part);
+            if (!view.empty()) {
+                std::memcpy(out, view.data(), view.size());
+                out += view.size();
+            }
+            first = false;
+        }
+        
+        result->length = utf8_strlen(reinterpret_cast<const char*>(result->data), total);
+        return String(result);
     }
     
     // 字符级操作
@@ -431,7 +733,7 @@ public:
     static String format(const char* format, ...) {
         va_list args;
         va_start(args, format);
-        bs_string* result = bs_string_format(format, args);
+        bs_string* result = bs_string_vformat(format, args);
         va_end(args);
         return String(result);
     }
@@ -469,6 +771,7 @@ public:
     }
     
     String& replaceRegex(const String& pattern, const String& replacement) {
+        detach();
         bs_string* result = bs_string_replace_regex(m_str, pattern.c_str(), replacement.c_str());
         if (result != m_str) {
             bs_string_free(m_str);
@@ -507,7 +810,35 @@ public:
         return result;
     }
     
-    // 获取底层C字符串指针（高级用法）
+    CompactArray regexFindAllCompact(const String& pattern) const {
+        return CompactArray(bs_string_regex_find_all_compact(m_str, pattern.c_str()));
+    }
+    
+    /**
+     * 开启或关闭写时复制，关闭时如果数据仍被共享会先复制一份
+     */
+    String& setCopyOnWrite(bool enable) {
+        if (!enable) {
+            detach();
+            delete m_shared.exchange(nullptr, std::memory_order_relaxed);
+        }
+        m_cow = enable;
+        return *this;
+    }
+    
+    bool isCopyOnWrite() const {
+        return m_cow;
+    }
+    
+    /**
+     * 共享同一份数据的String数量，未共享时为1
+     */
+    size_t useCount() const {
+        detail::SharedCount* shared = m_shared.load(std::memory_order_acquire);
+        return shared ? shared->refs.load(std::memory_order_acquire) : 1;
+    }
+    
+    // 获取底层C字符串指针（高级用法），数据被共享时应视为只读
     bs_string* getCString() const {
         return m_str;
     }
@@ -619,7 +950,7 @@ public:
         // 创建去掉最后一个字符的新字符串
         size_t len = length();
         bs_string* result = bs_string_substring(m_str, 0, len - 1);
-        bs_string_free(m_str);
+        freeString();
         m_str = result;
     }
     
@@ -637,55 +968,2219 @@ public:
     }
 
 private:
+    friend struct detail::FormatAccess;
+    
     bs_string* m_str; // 内部使用C版本的字符串类型
+    mutable std::atomic<detail::SharedCount*> m_shared{nullptr}; // 写时复制的引用计数，第一次复制时创建
+    bool m_cow = BETTER_STRING_COW != 0;
     
     // 内部工具方法
+    template <typename T>
+    static std::string_view partView(const T& part) {
+        if constexpr (std::is_same_v<T, String>) {
+            return part.view();
+        } else if constexpr (std::is_same_v<T, bs_string>) {
+            return std::string_view(reinterpret_cast<const char*>(part.data), part.byte_length);
+        } else {
+            return std::string_view(part);
+        }
+    }
+    
     void freeString() {
+        detail::SharedCount* shared = m_shared.load(std::memory_order_relaxed);
+        if (shared) {
+            m_shared.store(nullptr, std::memory_order_relaxed);
+            if (shared->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                m_str = nullptr;
+                return;
+            }
+            delete shared;
+        }
         if (m_str) {
             bs_string_free(m_str);
             m_str = nullptr;
         }
     }
+    
+    // 共享other的数据；other未开启写时复制时复制数据
+    void copyFrom(const String& other) {
+        if (!other.m_cow || !other.m_str) {
+            m_str = bs_string_copy(other.m_str);
+            return;
+        }
+        
+        detail::SharedCount* shared = other.m_shared.load(std::memory_order_acquire);
+        if (!shared) {
+            detail::SharedCount* created = new detail::SharedCount;
+            if (other.m_shared.compare_exchange_strong(shared, created, std::memory_order_acq_rel,
+                                                       std::memory_order_acquire)) {
+                shared = created;
+            } else {
+                delete created;
+            }
+        }
+        shared->refs.fetch_add(1, std::memory_order_relaxed);
+        m_str = other.m_str;
+        m_shared.store(shared, std::memory_order_relaxed);
+    }
+    
+    // 修改之前调用，数据被共享时复制一份独占的
+    void detach() {
+        detail::SharedCount* shared = m_shared.load(std::memory_order_relaxed);
+        if (!shared || shared->refs.load(std::memory_order_acquire) == 1) {
+            return;
+        }
+        bs_string* copy = bs_string_copy(m_str);
+        if (!copy) {
+            throw std::bad_alloc();
+        }
+        freeString();
+        m_str = copy;
+    }
 };
 
-// 非成员函数定义
-inline String operator+(const char* lhs, const String& rhs) {
-    return String(lhs) + rhs;
-}
+/**
+ * CSV/TSV读取器
+ *
+ * bs_csv_reader的RAII包装。字段以std::string_view返回，直接引用输入块，
+ * 在下一次调用next()或feed()之前有效。
+ */
+class CsvReader {
+public:
+    explicit CsvReader(char delimiter = ',', char quote = '"') : m_record{nullptr, 0} {
+        bs_csv_dialect dialect = {delimiter, quote};
+        m_quote = quote;
+        m_reader = bs_csv_reader_new(&dialect);
+        if (!m_reader) {
+            throw std::bad_alloc();
+        }
+    }
+    
+    CsvReader(const CsvReader&) = delete;
+    CsvReader& operator=(const CsvReader&) = delete;
+    
+    ~CsvReader() {
+        bs_csv_reader_free(m_reader);
+    }
+    
+    /**
+     * 提供下一块输入，数据在读完这一块的记录之前必须保持有效
+     */
+    void feed(std::string_view chunk, bool last = false) {
+        bs_csv_reader_feed(m_reader, chunk.data(), chunk.size(), last);
+    }
+    
+    /**
+     * 前进到下一条记录
+     * @return 没有完整记录（需要更多输入或已读完）时返回false；内存不足时抛出std::bad_alloc
+     */
+    bool next() {
+        if (bs_csv_reader_next(m_reader, &m_record)) {
+            return true;
+        }
+        if (bs_csv_reader_error(m_reader)) {
+            throw std::bad_alloc();
+        }
+        return false;
+    }
+    
+    size_t fieldCount() const {
+        return m_record.count;
+    }
+    
+    std::string_view field(size_t index) const {
+        const bs_string& value = m_record.fields[index].value;
+        return std::string_view(reinterpret_cast<const char*>(value.data), value.byte_length);
+    }
+    
+    bool quoted(size_t index) const {
+        return m_record.fields[index].quoted;
+    }
+    
+    /**
+     * 获取还原了转义引号的字段副本
+     */
+    String unescapedField(size_t index) const {
+        return String(bs_csv_unescape(&m_record.fields[index], m_quote));
+    }
+    
+private:
+    bs_csv_reader* m_reader;
+    bs_csv_record m_record;
+    char m_quote;
+};
 
-inline String operator+(const std::string& lhs, const String& rhs) {
-    return String(lhs) + rhs;
-}
+/**
+ * 类型安全的格式化
+ *
+ * bs::format("{} = {}", name, value)按参数类型格式化，占位符为{}或{N}，
+ * 用{{和}}表示花括号本身。格式串在编译期检查（C++20直接传入字面量即可；
+ * C++17需要使用BS_FORMAT_STRING宏，直接传入字面量时在运行时检查，错误时抛出
+ * std::invalid_argument）。结果先计算总长度，再一次写入最终缓冲区。
+ *
+ * 支持的参数类型：bool、char、整数、浮点数、const char*、std::string、
+ * std::string_view和bs::String。
+ */
+namespace detail {
 
-inline std::ostream& operator<<(std::ostream& os, const String& str) {
-    os << str.c_str();
-    return os;
-}
+template <typename T>
+struct type_identity {
+    using type = T;
+};
 
-inline std::istream& operator>>(std::istream& is, String& str) {
-    std::string temp;
-    is >> temp;
-    str = temp;
-    return is;
-}
+template <typename T>
+using type_identity_t = typename type_identity<T>::type;
 
-// 添加STL兼容的哈希支持
-namespace std {
-    template <>
-    struct hash<bs::String> {
-        size_t operator()(const bs::String& str) const {
-            // 使用FNV-1a哈希算法
-            const uint8_t* data = reinterpret_cast<const uint8_t*>(str.c_str());
-            size_t hash = 14695981039346656037ULL; // FNV偏移基数
-            for (size_t i = 0; i < str.byteLength(); ++i) {
-                hash ^= static_cast<size_t>(data[i]);
-                hash *= 1099511628211ULL; // FNV素数
+template <typename T>
+constexpr bool is_format_string_like_v =
+    std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view> || std::is_same_v<T, String>;
+
+template <typename T>
+constexpr bool is_formattable_v =
+    std::is_arithmetic_v<T> || std::is_same_v<T, const char*> || std::is_same_v<T, char*> ||
+    is_format_string_like_v<T>;
+
+/**
+ * 检查格式串
+ * @return 格式串正确时返回nullptr，否则返回错误描述
+ */
+constexpr const char* check_format(std::string_view fmt, size_t arg_count) {
+    size_t auto_index = 0;
+    bool has_auto = false;
+    bool has_manual = false;
+    
+    for (size_t i = 0; i < fmt.size(); i++) {
+        char c = fmt[i];
+        if (c == '}') {
+            if (i + 1 < fmt.size() && fmt[i + 1] == '}') {
+                i++;
+                continue;
             }
-            return hash;
+            return "unmatched '}' in format string";
         }
-    };
+        if (c != '{') {
+            continue;
+        }
+        if (i + 1 < fmt.size() && fmt[i + 1] == '{') {
+            i++;
+            continue;
+        }
+        
+        size_t j = i + 1;
+        size_t index = 0;
+        if (j < fmt.size() && fmt[j] >= '0' && fmt[j] <= '9') {
+            while (j < fmt.size() && fmt[j] >= '0' && fmt[j] <= '9') {
+                index = index * 10 + static_cast<size_t>(fmt[j] - '0');
+                if (index > arg_count) {
+                    return "argument index out of range";
+                }
+                j++;
+            }
+            has_manual = true;
+        } else {
+            index = auto_index++;
+            has_auto = true;
+        }
+        
+        if (j >= fmt.size()) {
+            return "unterminated '{' in format string";
+        }
+        if (fmt[j] == ':') {
+            return "format specifications are not supported";
+        }
+        if (fmt[j] != '}') {
+            return "invalid placeholder in format string";
+        }
+        if (has_auto && has_manual) {
+            return "cannot mix automatic and manual argument indexing";
+        }
+        if (index >= arg_count) {
+            return "argument index out of range";
+        }
+        i = j;
+    }
+    
+    if (has_auto && auto_index != arg_count) {
+        return "number of placeholders does not match number of arguments";
+    }
+    return nullptr;
 }
 
-} // namespace bs
+// 编译期字符串的基类，见BS_FORMAT_STRING
+struct compiled_format_base {};
+
+#if defined(__cpp_consteval) && __cpp_consteval >= 201811L
+// 常量求值中调用非constexpr函数会产生编译错误
+inline void invalid_format_string(const char*) {}
+#endif
+
+// 已格式化的参数片段
+struct FormatPiece {
+    const char* data;
+    size_t size;
+};
+
+// 整数和浮点数格式化时使用的临时空间
+struct FormatScratch {
+    char bytes[BS_FLOAT_MAX_CHARS];
+};
+
+template <typename T>
+FormatPiece make_format_piece(const T& value, FormatScratch& scratch) {
+    using U = std::decay_t<T>;
+    static_assert(is_formattable_v<U>, "bs::format: unsupported argument type");
+    
+    if constexpr (std::is_same_v<U, bool>) {
+        return value ? FormatPiece{"true", 4} : FormatPiece{"false", 5};
+    } else if constexpr (std::is_same_v<U, char>) {
+        scratch.bytes[0] = value;
+        return FormatPiece{scratch.bytes, 1};
+    } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+        return FormatPiece{scratch.bytes, bs_int_to_chars(static_cast<int64_t>(value), scratch.bytes)};
+    } else if constexpr (std::is_integral_v<U>) {
+        uint64_t magnitude = static_cast<uint64_t>(value);
+        unsigned digits = bs_count_digits(magnitude);
+        bs_write_digits(magnitude, scratch.bytes, digits);
+        return FormatPiece{scratch.bytes, digits};
+    } else if constexpr (std::is_floating_point_v<U>) {
+        return FormatPiece{scratch.bytes, bs_float_to_chars(static_cast<double>(value), scratch.bytes)};
+    } else if constexpr (std::is_array_v<T>) {
+        return FormatPiece{value, std::strlen(value)};
+    } else if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*>) {
+        if (!value) {
+            return FormatPiece{"(null)", 6};
+        }
+        return FormatPiece{value, std::strlen(value)};
+    } else if constexpr (std::is_same_v<U, String>) {
+        std::string_view view = value.view();
+        return FormatPiece{view.data(), view.size()};
+    } else {
+        return FormatPiece{value.data(), value.size()};
+    }
+}
+
+/**
+ * 按已检查过的格式串依次输出普通文本和参数片段
+ * @param emit 以(const char* data, size_t size)调用
+ */
+template <typename Emit>
+void render_format_with(std::string_view fmt, const FormatPiece* pieces, Emit&& emit) {
+    size_t auto_index = 0;
+    const char* p = fmt.data();
+    const char* end = p + fmt.size();
+    while (p < end) {
+        // 连续的普通字符一次复制
+        const char* run = p;
+        while (p < end && *p != '{' && *p != '}') {
+            p++;
+        }
+        if (p > run) {
+            emit(run, static_cast<size_t>(p - run));
+            continue;
+        }
+        
+        if (p[1] == *p) {
+            emit(p, 1);
+            p += 2;
+            continue;
+        }
+        
+        p++;
+        size_t index;
+        if (*p == '}') {
+            index = auto_index++;
+        } else {
+            index = 0;
+            while (*p != '}') {
+                index = index * 10 + static_cast<size_t>(*p - '0');
+                p++;
+            }
+        }
+        p++;
+        emit(pieces[index].data, pieces[index].size);
+    }
+}
+
+/**
+ * 按已检查过的格式串输出到缓冲区
+ * @param out 输出缓冲区，为nullptr时只计算长度
+ * @param capacity 最多写入的字节数
+ * @return 完整结果的字节数
+ */
+inline size_t render_format(std::string_view fmt, const FormatPiece* pieces, char* out, size_t capacity) {
+    size_t total = 0;
+    render_format_with(fmt, pieces, [&](const char* data, size_t size) {
+        if (out && total < capacity) {
+            std::memcpy(out + total, data, std::min(size, capacity - total));
+        }
+        total += size;
+    });
+    return total;
+}
+
+template <typename... Args, size_t... I>
+std::array<FormatPiece, sizeof...(Args)> make_format_pieces(std::array<FormatScratch, sizeof...(Args)>& scratch,
+                                                           std::index_sequence<I...>, const Args&... args) {
+    return {{make_format_piece(args, scratch[I])...}};
+}
+
+// 供格式化函数直接写入bs::String内部缓冲区
+struct FormatAccess {
+    static String adopt(bs_string* str) {
+        return String(str);
+    }
+    
+    static bs_string* raw(String& str) {
+        str.detach();
+        return str.m_str;
+    }
+};
+
+} // namespace detail
+
+/**
+ * 格式串类型，构造时检查格式串与参数个数是否匹配
+ */
+template <typename... Args>
+class basic_format_string {
+public:
+#if defined(__cpp_consteval) && __cpp_consteval >= 201811L
+    template <typename S, typename = std::enable_if_t<std::is_convertible_v<const S&, std::string_view>>>
+    consteval basic_format_string(const S& str) : m_str(str) {
+        const char* error = detail::check_format(m_str, sizeof...(Args));
+        if (error) {
+            detail::invalid_format_string(error);
+        }
+    }
+#else
+    template <typename S, typename = std::enable_if_t<std::is_convertible_v<const S&, std::string_view>>>
+    constexpr basic_format_string(const S& str) : m_str(str) {
+        const char* error = detail::check_format(m_str, sizeof...(Args));
+        if (error) {
+            throw std::invalid_argument(error);
+        }
+    }
+#endif
+    
+    template <typename S, typename = std::enable_if_t<std::is_base_of_v<detail::compiled_format_base, S>>, typename = void>
+    constexpr basic_format_string(S) : m_str(S::value()) {
+        static_assert(detail::check_format(S::value(), sizeof...(Args)) == nullptr, "bs::format: invalid format string");
+    }
+    
+    constexpr std::string_view get() const {
+        return m_str;
+    }
+    
+private:
+    std::string_view m_str;
+};
+
+template <typename... Args>
+using format_string = basic_format_string<detail::type_identity_t<Args>...>;
+
+/**
+ * 在C++17中得到编译期检查的格式串：bs::format(BS_FORMAT_STRING("{} {}"), a, b)
+ */
+#define BS_FORMAT_STRING(s)                                                     \
+    [] {                                                                        \
+        struct bs_compiled_format : ::bs::detail::compiled_format_base {        \
+            static constexpr std::string_view value() { return s; }             \
+        };                                                                      \
+        return bs_compiled_format{};                                            \
+    }()
+
+/**
+ * 计算格式化结果的字节数
+ */
+template <typename... Args>
+size_t formatted_size(format_string<Args...> fmt, const Args&... args) {
+    std::array<detail::FormatScratch, sizeof...(Args)> scratch;
+    auto pieces = detail::make_format_pieces(scratch, std::index_sequence_for<Args...>{}, args...);
+    return detail::render_format(fmt.get(), pieces.data(), nullptr, 0);
+}
+
+/**
+ * 格式化为新的字符串
+ */
+template <typename... Args>
+String format(format_string<Args...> fmt, const Args&... args) {
+    std::array<detail::FormatScratch, sizeof...(Args)> scratch;
+    auto pieces = detail::make_format_pieces(scratch, std::index_sequence_for<Args...>{}, args...);
+    
+    size_t size = detail::render_format(fmt.get(), pieces.data(), nullptr, 0);
+    bs_string* result = bs_string_alloc(size, BS_ENCODING_UTF8);
+    if (!result) {
+        throw std::bad_alloc();
+    }
+    detail::render_format(fmt.get(), pieces.data(), reinterpret_cast<char*>(result->data), size);
+    result->length = utf8_strlen(reinterpret_cast<const char*>(result->data), size);
+    return detail::FormatAccess::adopt(result);
+}
+
+/**
+ * 把格式化结果追加到已有字符串的末尾
+ * @return 追加的字节数
+ */
+template <typename... Args>
+size_t format_to(String& out, format_string<Args...> fmt, const Args&... args) {
+    std::array<detail::FormatScratch, sizeof...(Args)> scratch;
+    auto pieces = detail::make_format_pieces(scratch, std::index_sequence_for<Args...>{}, args...);
+    
+    size_t size = detail::render_format(fmt.get(), pieces.data(), nullptr, 0);
+    bs_string* str = detail::FormatAccess::raw(out);
+    size_t old_size = str->byte_length;
+    uint8_t* data = static_cast<uint8_t*>(std::realloc(str->data, old_size + size + 1));
+    if (!data) {
+        throw std::bad_alloc();
+    }
+    
+    detail::render_format(fmt.get(), pieces.data(), reinterpret_cast<char*>(data + old_size), size);
+    data[old_size + size] = '\0';
+    str->data = data;
+    str->byte_length = old_size + size;
+    str->length += utf8_strlen(reinterpret_cast<const char*>(data + old_size), size);
+    str->hash_cached = false;
+    return size;
+}
+
+/**
+ * 格式化到调用者的缓冲区，最多写入capacity字节，不写入null终止符
+ * @return 完整结果的字节数，大于capacity时表示结果被截断
+ */
+template <typename... Args>
+size_t format_to(char* buffer, size_t capacity, format_string<Args...> fmt, const Args&... args) {
+    std::array<detail::FormatScratch, sizeof...(Args)> scratch;
+    auto pieces = detail::make_format_pieces(scratch, std::index_sequence_for<Args...>{}, args...);
+    return detail::render_format(fmt.get(), pieces.data(), buffer, capacity);
+}
+
+/**
+ * 字符串构建器
+ *
+ * bs_builder的RAII包装。追加不会移动已经写入的字节，finish()一次复制得到
+ * 连续的String，flush()把各块直接写入文件描述符或文件。
+ * operator<<接受与bs::format相同的参数类型。
+ */
+class StringBuilder {
+public:
+    explicit StringBuilder(size_t chunkSize = 0) : m_builder(bs_builder_new(chunkSize)) {
+        if (!m_builder) {
+            throw std::bad_alloc();
+        }
+    }
+    
+    StringBuilder(const StringBuilder&) = delete;
+    StringBuilder& operator=(const StringBuilder&) = delete;
+    
+    StringBuilder(StringBuilder&& other) noexcept : m_builder(other.m_builder) {
+        other.m_builder = nullptr;
+    }
+    
+    StringBuilder& operator=(StringBuilder&& other) noexcept {
+        if (this != &other) {
+            bs_builder_free(m_builder);
+            m_builder = other.m_builder;
+            other.m_builder = nullptr;
+        }
+        return *this;
+    }
+    
+    ~StringBuilder() {
+        bs_builder_free(m_builder);
+    }
+    
+    StringBuilder& append(std::string_view text) {
+        return check(bs_builder_append(m_builder, text.data(), text.size()));
+    }
+    
+    StringBuilder& append(const String& str) {
+        return append(str.view());
+    }
+    
+    StringBuilder& append(char c) {
+        return check(bs_builder_append_char(m_builder, c));
+    }
+    
+    StringBuilder& appendCodepoint(char32_t codepoint) {
+        return check(bs_builder_append_codepoint(m_builder, static_cast<uint32_t>(codepoint)));
+    }
+    
+    StringBuilder& appendInt(int64_t value) {
+        return check(bs_builder_append_int(m_builder, value));
+    }
+    
+    StringBuilder& appendFloat(double value) {
+        return check(bs_builder_append_float(m_builder, value));
+    }
+    
+    /**
+     * 追加带双引号的JSON字符串
+     */
+    StringBuilder& appendJson(std::string_view text) {
+        return check(bs_builder_append_json_string(m_builder, text.data(), text.size()));
+    }
+    
+    /**
+     * 追加一个CSV字段，需要时加引号
+     */
+    StringBuilder& appendCsvField(std::string_view text, char delimiter = ',', char quote = '"') {
+        bs_csv_dialect dialect = {delimiter, quote};
+        return check(bs_builder_append_csv_field(m_builder, text.data(), text.size(), &dialect));
+    }
+    
+    template <typename T>
+    StringBuilder& operator<<(const T& value) {
+        detail::FormatScratch scratch;
+        detail::FormatPiece piece = detail::make_format_piece(value, scratch);
+        return check(bs_builder_append(m_builder, piece.data, piece.size));
+    }
+    
+    size_t size() const {
+        return bs_builder_length(m_builder);
+    }
+    
+    bool empty() const {
+        return size() == 0;
+    }
+    
+    size_t chunkCount() const {
+        return bs_builder_chunk_count(m_builder);
+    }
+    
+    /**
+     * 获取第index块内容的视图，在下一次修改之前有效
+     */
+    std::string_view chunk(size_t index) const {
+        bs_string view = bs_builder_chunk(m_builder, index);
+        return std::string_view(reinterpret_cast<const char*>(view.data), view.byte_length);
+    }
+    
+    /**
+     * 生成连续的字符串并清空构建器
+     */
+    String finish() {
+        bs_string* result = bs_builder_finish(m_builder);
+        if (!result) {
+            throw std::bad_alloc();
+        }
+        return String(result);
+    }
+    
+    /**
+     * 写入文件描述符或文件并清空构建器
+     * @return 全部写入成功时返回true
+     */
+    bool flush(int fd) {
+        return bs_builder_flush(m_builder, fd);
+    }
+    
+    bool flush(FILE* file) {
+        return bs_builder_flush_file(m_builder, file);
+    }
+    
+    void clear() {
+        bs_builder_clear(m_builder);
+    }
+    
+    bs_builder* get() const {
+        return m_builder;
+    }
+    
+private:
+    StringBuilder& check(bool ok) {
+        if (!ok) {
+            throw std::bad_alloc();
+        }
+        return *this;
+    }
+    
+    bs_builder* m_builder;
+};
+
+/**
+ * 把格式化结果追加到构建器
+ * @return 追加的字节数
+ */
+template <typename... Args>
+size_t format_to(StringBuilder& out, format_string<Args...> fmt, const Args&... args) {
+    std::array<detail::FormatScratch, sizeof...(Args)> scratch;
+    auto pieces = detail::make_format_pieces(scratch, std::index_sequence_for<Args...>{}, args...);
+    
+    size_t size = 0;
+    detail::render_format_with(fmt.get(), pieces.data(), [&](const char* data, size_t length) {
+        out.append(std::string_view(data, length));
+        size += length;
+    });
+    return size;
+}
+
+/**
+ * 适合频繁编辑的大文本，位置以字符为单位
+ */
+class Rope {
+public:
+    /**
+     * 按顺序遍历各块，得到的视图在下一次修改之前有效
+     */
+    class ChunkIterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view*;
+        using reference = const std::string_view&;
+        
+        ChunkIterator() : m_done(true) {}
+        
+        explicit ChunkIterator(const bs_rope* rope) : m_done(false) {
+            bs_rope_iter_init(&m_iter, rope);
+            ++*this;
+        }
+        
+        reference operator*() const {
+            return m_chunk;
+        }
+        
+        ChunkIterator& operator++() {
+            bs_string chunk;
+            if (bs_rope_iter_next(&m_iter, &chunk)) {
+                m_chunk = std::string_view(reinterpret_cast<const char*>(chunk.data), chunk.byte_length);
+            } else {
+                m_done = true;
+            }
+            return *this;
+        }
+        
+        bool operator==(const ChunkIterator& other) const {
+            return m_done && other.m_done;
+        }
+        
+        bool operator!=(const ChunkIterator& other) const {
+            return !(*this == other);
+        }
+        
+    private:
+        bs_rope_iter m_iter;
+        std::string_view m_chunk;
+        bool m_done;
+    };
+    
+    class ChunkRange {
+    public:
+        explicit ChunkRange(const bs_rope* rope) : m_rope(rope) {}
+        ChunkIterator begin() const { return ChunkIterator(m_rope); }
+        ChunkIterator end() const { return ChunkIterator(); }
+        
+    private:
+        const bs_rope* m_rope;
+    };
+    
+    Rope() : m_rope(bs_rope_new()) {
+        if (!m_rope) {
+            throw std::bad_alloc();
+        }
+    }
+    
+    explicit Rope(std::string_view text) : m_rope(bs_rope_from_cstr(text.data(), text.size())) {
+        if (!m_rope) {
+            throw std::bad_alloc();
+        }
+    }
+    
+    Rope(const Rope&) = delete;
+    Rope& operator=(const Rope&) = delete;
+    
+    Rope(Rope&& other) noexcept : m_rope(other.m_rope) {
+        other.m_rope = nullptr;
+    }
+    
+    Rope& operator=(Rope&& other) noexcept {
+        if (this != &other) {
+            bs_rope_free(m_rope);
+            m_rope = other.m_rope;
+            other.m_rope = nullptr;
+        }
+        return *this;
+    }
+    
+    ~Rope() {
+        bs_rope_free(m_rope);
+    }
+    
+    size_t length() const {
+        return bs_rope_length(m_rope);
+    }
+    
+    size_t byteLength() const {
+        return bs_rope_byte_length(m_rope);
+    }
+    
+    size_t lineCount() const {
+        return bs_rope_line_count(m_rope);
+    }
+    
+    bool empty() const {
+        return byteLength() == 0;
+    }
+    
+    Rope& insert(size_t index, std::string_view text) {
+        if (index > length()) {
+            throw std::out_of_range("Rope index out of range");
+        }
+        if (!bs_rope_insert(m_rope, index, text.data(), text.size())) {
+            throw std::bad_alloc();
+        }
+        return *this;
+    }
+    
+    Rope& append(std::string_view text) {
+        return insert(length(), text);
+    }
+    
+    Rope& erase(size_t index, size_t count) {
+        bs_rope_delete(m_rope, index, count);
+        return *this;
+    }
+    
+    char32_t charAt(size_t index) const {
+        if (index >= length()) {
+            throw std::out_of_range("Rope index out of range");
+        }
+        return static_cast<char32_t>(bs_rope_char_at(m_rope, index));
+    }
+    
+    String substring(size_t start, size_t count) const {
+        bs_string* result = bs_rope_substring(m_rope, start, count);
+        if (!result) {
+            throw std::bad_alloc();
+        }
+        return String(result);
+    }
+    
+    String toString() const {
+        return substring(0, length());
+    }
+    
+    size_t lineToChar(size_t line) const {
+        return bs_rope_line_to_char(m_rope, line);
+    }
+    
+    size_t charToLine(size_t index) const {
+        return bs_rope_char_to_line(m_rope, index);
+    }
+    
+    ChunkRange chunks() const {
+        return ChunkRange(m_rope);
+    }
+    
+    bs_rope* get() const {
+        return m_rope;
+    }
+    
+private:
+    bs_rope* m_rope;
+};
+
+/**
+ * 驻留字符串
+ *
+ * 引用全局驻留表中的规范字符串，只有一个指针大小，可以随意复制。
+ * 比较只比较指针，哈希值在驻留时已经算好。
+ */
+class InternedString {
+public:
+    struct Hash {
+        size_t operator()(const InternedString& str) const noexcept {
+            return static_cast<size_t>(str.hash());
+        }
+    };
+    
+    InternedString() : m_str(intern(std::string_view())) {}
+    
+    explicit InternedString(std::string_view text) : m_str(intern(text)) {}
+    
+    std::string_view view() const noexcept {
+        return std::string_view(reinterpret_cast<const char*>(m_str->data), m_str->byte_length);
+    }
+    
+    const char* c_str() const noexcept {
+        return reinterpret_cast<const char*>(m_str->data);
+    }
+    
+    size_t length() const noexcept {
+        return m_str->length;
+    }
+    
+    size_t byteLength() const noexcept {
+        return m_str->byte_length;
+    }
+    
+    uint64_t hash() const noexcept {
+        return bs_intern_hash(m_str);
+    }
+    
+    String toString() const {
+        return String(bs_string_new_len(c_str(), byteLength()));
+    }
+    
+    const bs_string* get() const noexcept {
+        return m_str;
+    }
+    
+    bool operator==(const InternedString& other) const noexcept {
+        return m_str == other.m_str;
+    }
+    
+    bool operator!=(const InternedString& other) const noexcept {
+        return m_str != other.m_str;
+    }
+    
+private:
+    static const bs_string* intern(std::string_view text) {
+        const bs_string* str = bs_intern(text.data(), text.size());
+        if (!str) {
+            throw std::bad_alloc();
+        }
+        return str;
+    }
+    
+    const bs_string* m_str;
+};
+
+/**
+ * 字符串哈希函数对象
+ *
+ * 支持String、std::string、std::string_view和const char*，同样的内容得到同样的值，
+ * 可以用于异构查找。对外部输入建表时可以设置随机种子，抵御哈希洪水攻击。
+ */
+struct Hash {
+    using is_transparent = void;
+    
+    uint64_t seed = 0;
+    
+    size_t operator()(std::string_view text) const noexcept {
+        return static_cast<size_t>(bs_hash(text.data(), text.size(), seed));
+    }
+    
+    size_t operator()(const String& str) const noexcept {
+        return (*this)(str.view());
+    }
+    
+    size_t operator()(const std::string& str) const noexcept {
+        return (*this)(std::string_view(str));
+    }
+    
+    size_t operator()(const char* str) const noexcept {
+        return (*this)(std::string_view(str));
+    }
+};
+
+/**
+ * StringMap的键存储方式
+ */
+enum class KeyStorage {
+    Owned,  // 每个键单独分配，删除时立即释放
+    Arena   // 键连续写入大块内存，删除时不回收，适合只增不删的表
+};
+
+/**
+ * 字符串哈希表
+ *
+ * 开放寻址的平铺哈希表（Swiss table）。控制字节16个一组，SSE2下一条指令比较一整组，
+ * 每个控制字节保存哈希的低7位作为指纹，指纹相同时才比较完整哈希和键。
+ * 完整的64位哈希和键一起保存，扩容时不需要重新计算。
+ *
+ * 查找接受String、std::string、std::string_view、const char*、bs_string*和InternedString，
+ * 不会为查找构造String；String等已经缓存了哈希的键直接使用缓存。
+ * 插入和扩容会移动元素，之前得到的迭代器和引用失效。
+ */
+template <typename V>
+class StringMap {
+public:
+    class Entry {
+    public:
+        std::string_view key() const noexcept {
+            return std::string_view(reinterpret_cast<const char*>(m_key->data), m_key->byte_length);
+        }
+        
+        const bs_string* keyString() const noexcept {
+            return m_key;
+        }
+        
+        V value;
+        
+    private:
+        friend class StringMap;
+        
+        template <typename... Args>
+        Entry(bs_string* key, uint64_t hash, Args&&... args)
+            : value(std::forward<Args>(args)...), m_key(key), m_hash(hash) {}
+        
+        bs_string* m_key;
+        uint64_t m_hash;
+    };
+    
+    template <bool IsConst>
+    class BasicIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Entry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const Entry*, Entry*>;
+        using reference = std::conditional_t<IsConst, const Entry&, Entry&>;
+        
+        BasicIterator() : m_ctrl(nullptr), m_end(nullptr), m_slot(nullptr) {}
+        
+        BasicIterator(const int8_t* ctrl, const int8_t* end, pointer slot) : m_ctrl(ctrl), m_end(end), m_slot(slot) {
+            skipEmpty();
+        }
+        
+        operator BasicIterator<true>() const {
+            return BasicIterator<true>(m_ctrl, m_end, m_slot);
+        }
+        
+        reference operator*() const {
+            return *m_slot;
+        }
+        
+        pointer operator->() const {
+            return m_slot;
+        }
+        
+        BasicIterator& operator++() {
+            ++m_ctrl;
+            ++m_slot;
+            skipEmpty();
+            return *this;
+        }
+        
+        BasicIterator operator++(int) {
+            BasicIterator old = *this;
+            ++*this;
+            return old;
+        }
+        
+        bool operator==(const BasicIterator& other) const {
+            return m_slot == other.m_slot;
+        }
+        
+        bool operator!=(const BasicIterator& other) const {
+            return m_slot != other.m_slot;
+        }
+        
+    private:
+        void skipEmpty() {
+            while (m_ctrl != m_end && *m_ctrl < 0) {
+                ++m_ctrl;
+                ++m_slot;
+            }
+        }
+        
+        const int8_t* m_ctrl;
+        const int8_t* m_end;
+        pointer m_slot;
+    };
+    
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+    
+    /**
+     * @param storage 键的存储方式
+     * @param seed 哈希种子，对外部输入建表时可以传入随机值
+     */
+    explicit StringMap(KeyStorage storage = KeyStorage::Owned, uint64_t seed = 0)
+        : m_ctrl(nullptr), m_slots(nullptr), m_capacity(0), m_size(0), m_growthLeft(0),
+          m_storage(storage), m_seed(seed), m_arenaPos(nullptr), m_arenaEnd(nullptr) {}
+    
+    StringMap(const StringMap&) = delete;
+    StringMap& operator=(const StringMap&) = delete;
+    
+    StringMap(StringMap&& other) noexcept : StringMap(other.m_storage, other.m_seed) {
+        swap(other);
+    }
+    
+    StringMap& operator=(StringMap&& other) noexcept {
+        if (this != &other) {
+            StringMap temp(std::move(other));
+            swap(temp);
+        }
+        return *this;
+    }
+    
+    ~StringMap() {
+        destroyEntries();
+        delete[] m_ctrl;
+        ::operator delete(m_slots);
+    }
+    
+    void swap(StringMap& other) noexcept {
+        std::swap(m_ctrl, other.m_ctrl);
+        std::swap(m_slots, other.m_slots);
+        std::swap(m_capacity, other.m_capacity);
+        std::swap(m_size, other.m_size);
+        std::swap(m_growthLeft, other.m_growthLeft);
+        std::swap(m_storage, other.m_storage);
+        std::swap(m_seed, other.m_seed);
+        m_arena.swap(other.m_arena);
+        std::swap(m_arenaPos, other.m_arenaPos);
+        std::swap(m_arenaEnd, other.m_arenaEnd);
+    }
+    
+    size_t size() const noexcept {
+        return m_size;
+    }
+    
+    bool empty() const noexcept {
+        return m_size == 0;
+    }
+    
+    size_t capacity() const noexcept {
+        return m_capacity;
+    }
+    
+    KeyStorage keyStorage() const noexcept {
+        return m_storage;
+    }
+    
+    iterator begin() {
+        return iterator(m_ctrl, m_ctrl + m_capacity, m_slots);
+    }
+    
+    iterator end() {
+        return iterator(m_ctrl + m_capacity, m_ctrl + m_capacity, m_slots + m_capacity);
+    }
+    
+    const_iterator begin() const {
+        return const_iterator(m_ctrl, m_ctrl + m_capacity, m_slots);
+    }
+    
+    const_iterator end() const {
+        return const_iterator(m_ctrl + m_capacity, m_ctrl + m_capacity, m_slots + m_capacity);
+    }
+    
+    template <typename K>
+    iterator find(const K& key) {
+        size_t index = findIndex(toKey(key));
+        return index == kNotFound ? end() : iteratorAt(index);
+    }
+    
+    template <typename K>
+    const_iterator find(const K& key) const {
+        size_t index = findIndex(toKey(key));
+        return index == kNotFound ? end() : const_iterator(m_ctrl + index, m_ctrl + m_capacity, m_slots + index);
+    }
+    
+    template <typename K>
+    bool contains(const K& key) const {
+        return findIndex(toKey(key)) != kNotFound;
+    }
+    
+    template <typename K>
+    V& at(const K& key) {
+        size_t index = findIndex(toKey(key));
+        if (index == kNotFound) {
+            throw std::out_of_range("StringMap key not found");
+        }
+        return m_slots[index].value;
+    }
+    
+    template <typename K>
+    const V& at(const K& key) const {
+        size_t index = findIndex(toKey(key));
+        if (index == kNotFound) {
+            throw std::out_of_range("StringMap key not found");
+        }
+        return m_slots[index].value;
+    }
+    
+    template <typename K>
+    V& operator[](const K& key) {
+        return tryEmplace(key).first->value;
+    }
+    
+    /**
+     * 键不存在时用args构造值并插入，已存在时不做任何事
+     * @return 指向元素的迭代器，以及是否发生了插入
+     */
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> tryEmplace(const K& key, Args&&... args) {
+        KeyRef ref = toKey(key);
+        size_t index = findIndex(ref);
+        if (index != kNotFound) {
+            return {iteratorAt(index), false};
+        }
+        index = insertNew(ref, std::forward<Args>(args)...);
+        return {iteratorAt(index), true};
+    }
+    
+    template <typename K>
+    std::pair<iterator, bool> insert(const K& key, V value) {
+        return tryEmplace(key, std::move(value));
+    }
+    
+    template <typename K>
+    std::pair<iterator, bool> insertOrAssign(const K& key, V value) {
+        KeyRef ref = toKey(key);
+        size_t index = findIndex(ref);
+        if (index != kNotFound) {
+            m_slots[index].value = std::move(value);
+            return {iteratorAt(index), false};
+        }
+        index = insertNew(ref, std::move(value));
+        return {iteratorAt(index), true};
+    }
+    
+    /**
+     * 删除键，Arena模式下键占用的内存要到clear()或析构时才回收
+     * @return 键是否存在
+     */
+    template <typename K>
+    bool erase(const K& key) {
+        size_t index = findIndex(toKey(key));
+        if (index == kNotFound) {
+            return false;
+        }
+        eraseAt(index);
+        return true;
+    }
+    
+    /**
+     * 预留至少容纳count个元素的空间，之后插入不会扩容
+     */
+    void reserve(size_t count) {
+        size_t capacity = kGroupWidth;
+        while (capacity - capacity / 8 < count) {
+            capacity *= 2;
+        }
+        if (capacity > m_capacity) {
+            rehash(capacity);
+        }
+    }
+    
+    /**
+     * 删除所有元素并释放键的内存，保留槽位数组
+     */
+    void clear() {
+        destroyEntries();
+        if (m_capacity > 0) {
+            std::memset(m_ctrl, kEmpty, m_capacity);
+        }
+        m_size = 0;
+        m_growthLeft = m_capacity - m_capacity / 8;
+        m_arena.clear();
+        m_arenaPos = nullptr;
+        m_arenaEnd = nullptr;
+    }
+    
+private:
+    static constexpr size_t kGroupWidth = 16;
+    static constexpr size_t kNotFound = static_cast<size_t>(-1);
+    static constexpr size_t kArenaBlockSize = 64 * 1024;
+    // 控制字节：最高位为1表示空槽或墓碑，否则低7位是哈希指纹
+    static constexpr int8_t kEmpty = -128;
+    static constexpr int8_t kDeleted = -2;
+    
+    struct KeyRef {
+        std::string_view text;
+        const bs_string* str;  // 可能带有缓存的哈希
+    };
+    
+    static KeyRef toKey(std::string_view key) { return {key, nullptr}; }
+    static KeyRef toKey(const char* key) { return {std::string_view(key), nullptr}; }
+    static KeyRef toKey(const std::string& key) { return {std::string_view(key), nullptr}; }
+    static KeyRef toKey(const String& key) { return {key.view(), key.getCString()}; }
+    static KeyRef toKey(const InternedString& key) { return {key.view(), key.get()}; }
+    static KeyRef toKey(const bs_string* key) {
+        return {std::string_view(reinterpret_cast<const char*>(key->data), key->byte_length), key};
+    }
+    
+    // 组内匹配结果的第i位对应组内第i个槽位
+    static uint32_t matchByte(const int8_t* group, int8_t value) {
+#ifdef BS_HAVE_SSE2
+        __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(value))));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < kGroupWidth; ++i) {
+            mask |= static_cast<uint32_t>(group[i] == value) << i;
+        }
+        return mask;
+#endif
+    }
+    
+    static uint32_t matchEmptyOrDeleted(const int8_t* group) {
+#ifdef BS_HAVE_SSE2
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < kGroupWidth; ++i) {
+            mask |= static_cast<uint32_t>(group[i] < 0) << i;
+        }
+        return mask;
+#endif
+    }
+    
+    uint64_t hashOf(const KeyRef& key) const {
+        // String和驻留字符串缓存的是种子为0的哈希，bs_string_hash读取或填充缓存
+        if (key.str && m_seed == 0) {
+            return bs_string_hash(key.str);
+        }
+        return bs_hash(key.text.data(), key.text.size(), m_seed);
+    }
+    
+    static bool keyEquals(const bs_string* key, std::string_view text) {
+        return key->byte_length == text.size() &&
+               (text.empty() || std::memcmp(key->data, text.data(), text.size()) == 0);
+    }
+    
+    iterator iteratorAt(size_t index) {
+        return iterator(m_ctrl + index, m_ctrl + m_capacity, m_slots + index);
+    }
+    
+    size_t findIndex(const KeyRef& key) const {
+        if (m_size == 0) {
+            return kNotFound;
+        }
+        uint64_t hash = hashOf(key);
+        int8_t fingerprint = static_cast<int8_t>(hash & 0x7F);
+        size_t groupMask = m_capacity / kGroupWidth - 1;
+        size_t group = static_cast<size_t>(hash >> 7) & groupMask;
+        // 三角数步长，组数是2的幂时能访问到每一组
+        for (size_t step = 1;; ++step) {
+            const int8_t* ctrl = m_ctrl + group * kGroupWidth;
+            for (uint32_t bits = matchByte(ctrl, fingerprint); bits != 0; bits &= bits - 1) {
+                size_t index = group * kGroupWidth + bs_ctz32(bits);
+                const Entry& entry = m_slots[index];
+                if (entry.m_hash == hash && keyEquals(entry.m_key, key.text)) {
+                    return index;
+                }
+            }
+            if (matchByte(ctrl, kEmpty) != 0) {
+                return kNotFound;
+            }
+            group = (group + step) & groupMask;
+        }
+    }
+    
+    // 沿探测序列找到第一个空槽或墓碑
+    static size_t findInsertSlot(const int8_t* ctrl, size_t capacity, uint64_t hash) {
+        size_t groupMask = capacity / kGroupWidth - 1;
+        size_t group = static_cast<size_t>(hash >> 7) & groupMask;
+        for (size_t step = 1;; ++step) {
+            uint32_t bits = matchEmptyOrDeleted(ctrl + group * kGroupWidth);
+            if (bits != 0) {
+                return group * kGroupWidth + bs_ctz32(bits);
+            }
+            group = (group + step) & groupMask;
+        }
+    }
+    
+    template <typename... Args>
+    size_t insertNew(const KeyRef& key, Args&&... args) {
+        if (m_growthLeft == 0) {
+            // 墓碑占了一半以上的空间时原地重建，否则扩容一倍
+            if (m_capacity > 0 && m_size <= (m_capacity - m_capacity / 8) / 2) {
+                rehash(m_capacity);
+            } else {
+                rehash(m_capacity == 0 ? kGroupWidth : m_capacity * 2);
+            }
+        }
+        uint64_t hash = hashOf(key);
+        size_t index = findInsertSlot(m_ctrl, m_capacity, hash);
+        bs_string* str = makeKey(key.text, hash);
+        try {
+            new (&m_slots[index]) Entry(str, hash, std::forward<Args>(args)...);
+        } catch (...) {
+            freeKey(str);
+            throw;
+        }
+        if (m_ctrl[index] == kEmpty) {
+            --m_growthLeft;
+        }
+        m_ctrl[index] = static_cast<int8_t>(hash & 0x7F);
+        ++m_size;
+        return index;
+    }
+    
+    void eraseAt(size_t index) {
+        freeKey(m_slots[index].m_key);
+        m_slots[index].~Entry();
+        // 组内还有空槽说明这一组从未满过，没有探测序列越过它，可以直接置空
+        if (matchByte(m_ctrl + (index & ~(kGroupWidth - 1)), kEmpty) != 0) {
+            m_ctrl[index] = kEmpty;
+            ++m_growthLeft;
+        } else {
+            m_ctrl[index] = kDeleted;
+        }
+        --m_size;
+    }
+    
+    void rehash(size_t capacity) {
+        int8_t* ctrl = new int8_t[capacity];
+        Entry* slots = static_cast<Entry*>(::operator new(capacity * sizeof(Entry)));
+        std::memset(ctrl, kEmpty, capacity);
+        for (size_t i = 0; i < m_capacity; ++i) {
+            if (m_ctrl[i] < 0) {
+                continue;
+            }
+            Entry& entry = m_slots[i];
+            size_t index = findInsertSlot(ctrl, capacity, entry.m_hash);
+            new (&slots[index]) Entry(std::move(entry));
+            entry.~Entry();
+            ctrl[index] = m_ctrl[i];
+        }
+        delete[] m_ctrl;
+        ::operator delete(m_slots);
+        m_ctrl = ctrl;
+        m_slots = slots;
+        m_capacity = capacity;
+        m_growthLeft = capacity - capacity / 8 - m_size;
+    }
+    
+    void destroyEntries() {
+        for (size_t i = 0; i < m_capacity; ++i) {
+            if (m_ctrl[i] >= 0) {
+                freeKey(m_slots[i].m_key);
+                m_slots[i].~Entry();
+            }
+        }
+    }
+    
+    bs_string* makeKey(std::string_view text, uint64_t hash) {
+        bs_string* str;
+        if (m_storage == KeyStorage::Owned) {
+            str = bs_string_new_len(text.data(), text.size());
+            if (!str) {
+                throw std::bad_alloc();
+            }
+        } else {
+            // bs_string头和字节连续存放在内存块里
+            str = static_cast<bs_string*>(arenaAlloc(sizeof(bs_string) + text.size() + 1));
+            str->data = reinterpret_cast<uint8_t*>(str + 1);
+            if (!text.empty()) {
+                std::memcpy(str->data, text.data(), text.size());
+            }
+            str->data[text.size()] = '\0';
+            str->length = utf8_strlen(text.data(), text.size());
+            str->byte_length = text.size();
+            str->encoding = BS_ENCODING_UTF8;
+            str->is_view = true;
+        }
+        str->hash_cached = m_seed == 0;
+        str->hash = m_seed == 0 ? hash : 0;
+        return str;
+    }
+    
+    void freeKey(bs_string* str) {
+        if (m_storage == KeyStorage::Owned) {
+            bs_string_free(str);
+        }
+    }
+    
+    void* arenaAlloc(size_t size) {
+        size_t align = alignof(bs_string);
+        size_t offset = static_cast<size_t>(-reinterpret_cast<uintptr_t>(m_arenaPos)) & (align - 1);
+        if (!m_arenaPos || static_cast<size_t>(m_arenaEnd - m_arenaPos) < offset + size) {
+            size_t blockSize = std::max(kArenaBlockSize, size);
+            m_arena.emplace_back(new char[blockSize]);
+            m_arenaPos = m_arena.back().get();
+            m_arenaEnd = m_arenaPos + blockSize;
+            offset = 0;
+        }
+        void* result = m_arenaPos + offset;
+        m_arenaPos += offset + size;
+        return result;
+    }
+    
+    int8_t* m_ctrl;
+    Entry* m_slots;
+    size_t m_capacity;  // 0或16的2的幂倍
+    size_t m_size;
+    size_t m_growthLeft;  // 负载因子达到7/8之前还能占用的空槽数
+    KeyStorage m_storage;
+    uint64_t m_seed;
+    std::vector<std::unique_ptr<char[]>> m_arena;
+    char* m_arenaPos;
+    char* m_arenaEnd;
+};
+
+namespace detail {
+
+// 复制各字符串的bs_string头到连续数组中排序，再按排序结果移动String，
+// 头的下标就是元素原来的位置。移动后的String为空，按空字符串处理
+template <typename RandomIt>
+void sortStrings(RandomIt first, RandomIt last, size_t threads) {
+    size_t count = static_cast<size_t>(last - first);
+    if (count < 2) {
+        return;
+    }
+    static const uint8_t empty[1] = {0};
+    std::vector<bs_string> headers(count);
+    std::vector<bs_string*> order(count);
+    for (size_t i = 0; i < count; ++i) {
+        const bs_string* str = first[i].getCString();
+        if (str) {
+            headers[i] = *str;
+        } else {
+            headers[i] = bs_string{const_cast<uint8_t*>(empty), 0, 0, BS_ENCODING_UTF8, true, false, 0};
+        }
+        order[i] = &headers[i];
+    }
+    if (threads == 1) {
+        bs_string_sort(order.data(), count);
+    } else {
+        bs_string_sort_parallel(order.data(), count, threads);
+    }
+    
+    // 按置换环移动元素，每个元素只移动一次
+    std::vector<bool> placed(count, false);
+    for (size_t i = 0; i < count; ++i) {
+        if (placed[i]) {
+            continue;
+        }
+        String temp(std::move(first[i]));
+        size_t j = i;
+        for (;;) {
+            placed[j] = true;
+            size_t source = static_cast<size_t>(order[j] - headers.data());
+            if (source == i) {
+                first[j] = std::move(temp);
+                break;
+            }
+            first[j] = std::move(first[source]);
+            j = source;
+        }
+    }
+}
+
+} // namespace detail
+
+/**
+ * 按码点顺序排序String序列，结果与std::sort加operator<相同（不保证稳定）
+ * 比较直接作用于连续存放的排序键，公共前缀不会重复比较
+ */
+template <typename RandomIt>
+void sort(RandomIt first, RandomIt last) {
+    detail::sortStrings(first, last, 1);
+}
+
+/**
+ * 多线程版本的sort，threads为0时使用CPU核心数
+ */
+template <typename RandomIt>
+void parallelSort(RandomIt first, RandomIt last, size_t threads = 0) {
+    detail::sortStrings(first, last, threads);
+}
+
+/**
+ * 线程池
+ *
+ * bs_thread_pool的RAII包装，只能移动。threads为0时使用CPU核心数，
+ * 为1时所有任务在调用线程上按顺序执行，便于测试。
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = 0) : m_pool(bs_thread_pool_new(threads)) {
+        if (!m_pool) {
+            throw std::bad_alloc();
+        }
+    }
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    ThreadPool(ThreadPool&& other) noexcept : m_pool(other.m_pool) {
+        other.m_pool = nullptr;
+    }
+    
+    ThreadPool& operator=(ThreadPool&& other) noexcept {
+        if (this != &other) {
+            bs_thread_pool_free(m_pool);
+            m_pool = other.m_pool;
+            other.m_pool = nullptr;
+        }
+        return *this;
+    }
+    
+    ~ThreadPool() {
+        bs_thread_pool_free(m_pool);
+    }
+    
+    size_t size() const {
+        return bs_thread_pool_size(m_pool);
+    }
+    
+    /**
+     * 并行执行fn(begin, end)覆盖[0, count)，grain为0时自动分块
+     * fn抛出的第一个异常在所有块结束后重新抛出
+     */
+    template <typename F>
+    void parallelFor(size_t count, F&& fn, size_t grain = 0) {
+        struct Context {
+            explicit Context(F& f) : fn(f) {}
+            F& fn;
+            std::exception_ptr error;
+            std::atomic<bool> failed{false};
+        } context(fn);
+        bs_thread_pool_for(m_pool, count, grain, [](void* ctx, size_t begin, size_t end) {
+            Context& context = *static_cast<Context*>(ctx);
+            if (context.failed.load(std::memory_order_relaxed)) {
+                return;
+            }
+            try {
+                context.fn(begin, end);
+            } catch (...) {
+                if (!context.failed.exchange(true)) {
+                    context.error = std::current_exception();
+                }
+            }
+        }, &context);
+        if (context.error) {
+            std::rethrow_exception(context.error);
+        }
+    }
+    
+    bs_thread_pool* get() const {
+        return m_pool;
+    }
+    
+private:
+    bs_thread_pool* m_pool;
+};
+
+namespace detail {
+
+// 把String序列包装成bs_string_array交给C接口，移动后的String按空字符串处理
+template <typename Convert>
+CompactArray transformStrings(const std::vector<String>& strings, Convert convert) {
+    static bs_string empty = {const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>("")), 0, 0, BS_ENCODING_UTF8,
+                              true, false, 0};
+    std::vector<bs_string*> items(strings.size());
+    for (size_t i = 0; i < strings.size(); ++i) {
+        bs_string* str = strings[i].getCString();
+        items[i] = str ? str : &empty;
+    }
+    bs_string_array array = {items.data(), items.size()};
+    bs_compact_array* result = convert(&array);
+    if (!result) {
+        throw std::bad_alloc();
+    }
+    return CompactArray(result);
+}
+
+} // namespace detail
+
+/**
+ * 批量转换，结果存放在一个连续缓冲区中，pool为nullptr时在调用线程上执行
+ */
+inline CompactArray toLower(const std::vector<String>& strings, ThreadPool* pool = nullptr) {
+    return detail::transformStrings(strings, [pool](const bs_string_array* array) {
+        return bs_string_array_to_lower(array, pool ? pool->get() : nullptr);
+    });
+}
+
+inline CompactArray toUpper(const std::vector<String>& strings, ThreadPool* pool = nullptr) {
+    return detail::transformStrings(strings, [pool](const bs_string_array* array) {
+        return bs_string_array_to_upper(array, pool ? pool->get() : nullptr);
+    });
+}
+
+inline CompactArray trim(const std::vector<String>& strings, unsigned flags = BS_TRIM_BOTH,
+                         ThreadPool* pool = nullptr) {
+    return detail::transformStrings(strings, [flags, pool](const bs_string_array* array) {
+        return bs_string_array_trim(array, flags, pool ? pool->get() : nullptr);
+    });
+}
+
+namespace detail {
+
+// 引用外部内存的bs_string头，只用于按字节查找，不计算字符长度
+inline bs_string byteView(std::string_view text) {
+    return bs_string{reinterpret_cast<uint8_t*>(const_cast<char*>(text.data())), text.size(), text.size(),
+                     BS_ENCODING_UTF8, true, false, 0};
+}
+
+} // namespace detail
+
+/**
+ * 并行查找所有出现位置，返回升序的字节偏移，互相重叠的出现位置都计入
+ * pool为nullptr或文本较小时顺序查找
+ */
+inline std::vector<size_t> findAll(std::string_view haystack, std::string_view needle, ThreadPool* pool = nullptr) {
+    bs_string text = detail::byteView(haystack);
+    bs_string pattern = detail::byteView(needle);
+    bs_match_list* list = bs_string_find_all(&text, &pattern, pool ? pool->get() : nullptr);
+    if (!list) {
+        throw std::bad_alloc();
+    }
+    std::vector<size_t> positions(list->positions, list->positions + list->length);
+    bs_match_list_free(list);
+    return positions;
+}
+
+inline size_t count(std::string_view haystack, std::string_view needle, ThreadPool* pool = nullptr) {
+    bs_string text = detail::byteView(haystack);
+    bs_string pattern = detail::byteView(needle);
+    return bs_string_count(&text, &pattern, pool ? pool->get() : nullptr);
+}
+
+inline bool contains(std::string_view haystack, std::string_view needle, ThreadPool* pool = nullptr) {
+    bs_string text = detail::byteView(haystack);
+    bs_string pattern = detail::byteView(needle);
+    return bs_string_contains_parallel(&text, &pattern, pool ? pool->get() : nullptr);
+}
+
+/**
+ * 只读映射的文件内容，不复制数据，析构时解除映射
+ * get()返回的bs_string可以传给所有只读的C函数
+ */
+class MappedString {
+public:
+    explicit MappedString(const char* path, unsigned flags = BS_MAP_SEQUENTIAL)
+        : m_str(bs_string_map_file(path, flags)) {
+        if (!m_str) {
+            throw std::system_error(errno, std::generic_category(), path ? path : "");
+        }
+    }
+    
+    explicit MappedString(const std::string& path, unsigned flags = BS_MAP_SEQUENTIAL)
+        : MappedString(path.c_str(), flags) {}
+    
+    MappedString(const MappedString&) = delete;
+    MappedString& operator=(const MappedString&) = delete;
+    
+    MappedString(MappedString&& other) noexcept : m_str(other.m_str) {
+        other.m_str = nullptr;
+    }
+    
+    MappedString& operator=(MappedString&& other) noexcept {
+        if (this != &other) {
+            bs_string_unmap(m_str);
+            m_str = other.m_str;
+            other.m_str = nullptr;
+        }
+        return *this;
+    }
+    
+    ~MappedString() {
+        bs_string_unmap(m_str);
+    }
+    
+    std::string_view view() const noexcept {
+        return m_str ? std::string_view(reinterpret_cast<const char*>(m_str->data), m_str->byte_length)
+                     : std::string_view();
+    }
+    
+    const char* data() const noexcept {
+        return m_str ? reinterpret_cast<const char*>(m_str->data) : "";
+    }
+    
+    size_t byteLength() const noexcept {
+        return m_str ? m_str->byte_length : 0;
+    }
+    
+    // 第一次调用时统计字符数
+    size_t length() const {
+        return bs_string_length(m_str);
+    }
+    
+    bool empty() const noexcept {
+        return byteLength() == 0;
+    }
+    
+    // 复制为拥有内存的字符串
+    String toString() const {
+        bs_string* copy = bs_string_copy(m_str);
+        if (!copy) {
+            throw std::bad_alloc();
+        }
+        return String(copy);
+    }
+    
+    const bs_string* get() const noexcept {
+        return m_str;
+    }
+    
+private:
+    bs_string* m_str;
+};
+
+/**
+ * 按行读取文件描述符、FILE*或输入流，不拥有数据源
+ * 返回的行是内部缓冲区的视图，在下一次调用next前有效
+ */
+class LineReader {
+public:
+    explicit LineReader(int fd, size_t bufferSize = 0) : m_reader(bs_line_reader_new_fd(fd, bufferSize)) {
+        if (!m_reader) {
+            throw std::bad_alloc();
+        }
+    }
+    
+    explicit LineReader(FILE* file, size_t bufferSize = 0) : m_reader(bs_line_reader_new_file(file, bufferSize)) {
+        if (!m_reader) {
+            throw std::bad_alloc();
+        }
+    }
+    
+    explicit LineReader(std::istream& stream, size_t bufferSize = 0)
+        : m_reader(bs_line_reader_new(readStream, &stream, bufferSize)) {
+        if (!m_reader) {
+            throw std::bad_alloc();
+        }
+    }
+    
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+    
+    LineReader(LineReader&& other) noexcept : m_reader(other.m_reader) {
+        other.m_reader = nullptr;
+    }
+    
+    LineReader& operator=(LineReader&& other) noexcept {
+        if (this != &other) {
+            bs_line_reader_free(m_reader);
+            m_reader = other.m_reader;
+            other.m_reader = nullptr;
+        }
+        return *this;
+    }
+    
+    ~LineReader() {
+        bs_line_reader_free(m_reader);
+    }
+    
+    // 读到一行返回true；结束或出错返回false，用error()区分
+    bool next(std::string_view& line) {
+        bs_string view;
+        if (!bs_line_reader_next(m_reader, &view)) {
+            return false;
+        }
+        line = std::string_view(reinterpret_cast<const char*>(view.data), view.byte_length);
+        return true;
+    }
+    
+    bool error() const {
+        return bs_line_reader_error(m_reader);
+    }
+    
+private:
+    // 流的异常不能穿过C代码，出错时按读取失败处理
+    static ptrdiff_t readStream(void* ctx, uint8_t* buffer, size_t capacity) {
+        std::istream& stream = *static_cast<std::istream*>(ctx);
+        try {
+            stream.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(capacity));
+        } catch (...) {
+            return -1;
+        }
+        std::streamsize count = stream.gcount();
+        if (count == 0 && stream.bad()) {
+            return -1;
+        }
+        return static_cast<ptrdiff_t>(count);
+    }
+    
+    bs_line_reader* m_reader;
+};
+
+namespace detail {
+
+// 把各段依次转换为bs_iovec，每批最多BS_IOV_BATCH项，批量写出
+template <typename Iterator, typename ToView>
+bool writeViews(int fd, Iterator first, Iterator last, ToView toView) {
+    bs_iovec batch[BS_IOV_BATCH];
+    while (first != last) {
+        size_t n = 0;
+        for (; first != last && n < BS_IOV_BATCH; ++first) {
+            std::string_view part = toView(*first);
+            if (!part.empty()) {
+                batch[n].data = reinterpret_cast<const uint8_t*>(part.data());
+                batch[n].length = part.size();
+                n++;
+            }
+        }
+        if (!bs_writev_all(fd, batch, n)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace detail
+
+/**
+ * 用writev把多段数据写入文件描述符，不先拼接
+ * @return 全部写入返回true；出错返回false，errno说明原因
+ */
+inline bool writev(int fd, std::initializer_list<std::string_view> parts) {
+    return detail::writeViews(fd, parts.begin(), parts.end(), [](std::string_view part) { return part; });
+}
+
+inline bool writev(int fd, const std::vector<std::string_view>& parts) {
+    return detail::writeViews(fd, parts.begin(), parts.end(), [](std::string_view part) { return part; });
+}
+
+inline bool writev(int fd, const std::vector<String>& strings) {
+    return detail::writeViews(fd, strings.begin(), strings.end(), [](const String& str) { return str.view(); });
+}
+
+/**
+ * 批量读取文件，第i项是paths[i]的内容，读取失败的文件为std::nullopt
+ * Linux上使用io_uring成批提交，其他平台逐个读取
+ */
+inline std::vector<std::optional<String>> loadFiles(const std::vector<std::string>& paths) {
+    std::vector<const char*> cpaths(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        cpaths[i] = paths[i].c_str();
+    }
+    std::vector<std::optional<String>> files(paths.size());
+    bs_load_files(cpaths.data(), cpaths.size(), [](void* user, size_t index, bs_string* str, int) {
+        if (str) {
+            (*static_cast<std::vector<std::optional<String>>*>(user))[index].emplace(str);
+        }
+    }, &files);
+    return files;
+}
+
+/**
+ * 流式子串查找，逐块输入数据，报告全局字节偏移，跨块的匹配也会报告
+ * 只保存与needle大小相当的状态，reset()后可用于下一个数据流
+ */
+class StreamSearcher {
+public:
+    explicit StreamSearcher(std::string_view needle)
+        : m_searcher(bs_stream_searcher_new(reinterpret_cast<const uint8_t*>(needle.data()), needle.size())) {
+        if (!m_searcher) {
+            throw std::bad_alloc();
+        }
+    }
+    
+    StreamSearcher(const StreamSearcher&) = delete;
+    StreamSearcher& operator=(const StreamSearcher&) = delete;
+    
+    StreamSearcher(StreamSearcher&& other) noexcept : m_searcher(other.m_searcher) {
+        other.m_searcher = nullptr;
+    }
+    
+    StreamSearcher& operator=(StreamSearcher&& other) noexcept {
+        if (this != &other) {
+            bs_stream_searcher_free(m_searcher);
+            m_searcher = other.m_searcher;
+            other.m_searcher = nullptr;
+        }
+        return *this;
+    }
+    
+    ~StreamSearcher() {
+        bs_stream_searcher_free(m_searcher);
+    }
+    
+    /**
+     * 输入下一块数据，对每个在本块内结束的匹配调用onMatch(uint64_t offset)
+     * @return 本块内结束的匹配数量
+     */
+    template <typename F>
+    size_t feed(std::string_view chunk, F&& onMatch) {
+        return bs_stream_searcher_feed(m_searcher, reinterpret_cast<const uint8_t*>(chunk.data()), chunk.size(),
+                                       [](void* user, uint64_t offset) {
+                                           (*static_cast<std::remove_reference_t<F>*>(user))(offset);
+                                       }, &onMatch);
+    }
+    
+    size_t feed(std::string_view chunk) {
+        return bs_stream_searcher_feed(m_searcher, reinterpret_cast<const uint8_t*>(chunk.data()), chunk.size(), nullptr, nullptr);
+    }
+    
+    void reset() noexcept {
+        bs_stream_searcher_reset(m_searcher);
+    }
+    
+    // 已输入的总字节数
+    uint64_t offset() const noexcept {
+        return bs_stream_searcher_offset(m_searcher);
+    }
+    
+private:
+    bs_stream_searcher* m_searcher;
+};
+
+#ifdef BS_HAVE_COROUTINES
+/**
+ * 异步生成器：消费者用co_await next()取下一个值，结束时得到std::nullopt
+ * 生成器内部可以co_await其他异步操作，挂起时控制权回到恢复它的消费者的调用者
+ */
+template <typename T>
+class AsyncGenerator {
+public:
+    struct promise_type;
+    using Handle = std::coroutine_handle<promise_type>;
+    
+    // 产出值或结束时直接切换回等待的消费者
+    struct TransferToConsumer {
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(Handle handle) noexcept { return handle.promise().consumer; }
+        void await_resume() const noexcept {}
+    };
+    
+    struct promise_type {
+        std::optional<T> current;
+        std::exception_ptr error;
+        std::coroutine_handle<> consumer;
+        
+        AsyncGenerator get_return_object() { return AsyncGenerator(Handle::from_promise(*this)); }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        TransferToConsumer final_suspend() const noexcept { return {}; }
+        TransferToConsumer yield_value(T value) noexcept(std::is_nothrow_move_constructible_v<T>) {
+            current.emplace(std::move(value));
+            return {};
+        }
+        void return_void() const noexcept {}
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+    };
+    
+    AsyncGenerator(const AsyncGenerator&) = delete;
+    AsyncGenerator& operator=(const AsyncGenerator&) = delete;
+    
+    AsyncGenerator(AsyncGenerator&& other) noexcept : m_handle(other.m_handle) {
+        other.m_handle = nullptr;
+    }
+    
+    AsyncGenerator& operator=(AsyncGenerator&& other) noexcept {
+        if (this != &other) {
+            if (m_handle) {
+                m_handle.destroy();
+            }
+            m_handle = other.m_handle;
+            other.m_handle = nullptr;
+        }
+        return *this;
+    }
+    
+    ~AsyncGenerator() {
+        if (m_handle) {
+            m_handle.destroy();
+        }
+    }
+    
+    /**
+     * 返回可等待对象，结果是std::optional<T>；生成器抛出的异常在这里重新抛出
+     * 上一次得到的值在再次调用next前有效
+     */
+    auto next() {
+        struct Awaiter {
+            Handle handle;
+            
+            bool await_ready() const noexcept { return !handle || handle.done(); }
+            
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) noexcept {
+                handle.promise().consumer = consumer;
+                handle.promise().current.reset();
+                return handle;
+            }
+            
+            std::optional<T> await_resume() {
+                if (!handle) {
+                    return std::nullopt;
+                }
+                if (handle.promise().error) {
+                    std::rethrow_exception(std::exchange(handle.promise().error, nullptr));
+                }
+                if (handle.done()) {
+                    return std::nullopt;
+                }
+                return std::move(handle.promise().current);
+            }
+        };
+        return Awaiter{m_handle};
+    }
+    
+private:
+    explicit AsyncGenerator(Handle handle) : m_handle(handle) {}
+    
+    Handle m_handle;
+};
+
+/**
+ * 立即就绪的可等待对象，同步的数据源可以直接返回它
+ */
+template <typename T>
+struct Ready {
+    T value;
+    
+    bool await_ready() const noexcept { return true; }
+    void await_suspend(std::coroutine_handle<>) const noexcept {}
+    T await_resume() { return std::move(value); }
+};
+
+/**
+ * 内存中的分块数据源，用于测试或已经在内存中的数据
+ * 每次调用返回下一块，没有更多数据时返回std::nullopt
+ */
+class MemoryChunkSource {
+public:
+    explicit MemoryChunkSource(std::vector<std::string> chunks) : m_chunks(std::move(chunks)) {}
+    
+    // 把text切成chunkSize字节的块，text必须在使用期间保持有效
+    MemoryChunkSource(std::string_view text, size_t chunkSize)
+        : m_text(text), m_chunkSize(chunkSize ? chunkSize : 1), m_fromText(true) {}
+    
+    Ready<std::optional<std::string_view>> operator()() {
+        if (!m_fromText) {
+            if (m_next >= m_chunks.size()) {
+                return {std::nullopt};
+            }
+            return {std::string_view(m_chunks[m_next++])};
+        }
+        if (m_offset >= m_text.size()) {
+            return {std::nullopt};
+        }
+        std::string_view chunk = m_text.substr(m_offset, m_chunkSize);
+        m_offset += chunk.size();
+        return {chunk};
+    }
+    
+private:
+    std::vector<std::string> m_chunks;
+    size_t m_next = 0;
+    std::string_view m_text;
+    size_t m_chunkSize = 0;
+    size_t m_offset = 0;
+    bool m_fromText = false;
+};
+
+namespace detail {
+
+// 分割分块到达的数据：完全落在一块中的字段直接产出该块的视图，
+// 只有跨块的字段复制到carry中，分隔符本身也可能跨块
+template <typename Source>
+AsyncGenerator<std::string_view> splitChunks(Source source, std::string delimiter, unsigned flags, bool lines) {
+    const size_t delimiterLength = delimiter.size();
+    const bool skipEmpty = (flags & BS_SPLIT_SKIP_EMPTY) != 0;
+    std::string carry;
+    
+    for (;;) {
+        std::optional<std::string_view> next = co_await source();
+        if (!next) {
+            break;
+        }
+        std::string_view chunk = *next;
+        size_t position = 0;
+        
+        if (!carry.empty() && delimiterLength > 1) {
+            // 起点在carry末尾的分隔符最多有delimiterLength - 1个字节在carry中
+            size_t tail = std::min(carry.size(), delimiterLength - 1);
+            std::string window = carry.substr(carry.size() - tail);
+            window.append(chunk.substr(0, delimiterLength - 1));
+            size_t found = window.find(delimiter);
+            if (found != std::string::npos && found < tail) {
+                carry.resize(carry.size() - tail + found);
+                position = found + delimiterLength - tail;
+                std::string_view field(carry);
+                if (lines && !field.empty() && field.back() == '\r') {
+                    field.remove_suffix(1);
+                }
+                if (!skipEmpty || !field.empty()) {
+                    co_yield field;
+                }
+                carry.clear();
+            }
+        }
+        
+        for (;;) {
+            size_t found = chunk.find(delimiter, position);
+            if (found == std::string_view::npos) {
+                break;
+            }
+            std::string_view field = chunk.substr(position, found - position);
+            if (!carry.empty()) {
+                carry.append(field);
+                field = carry;
+            }
+            if (lines && !field.empty() && field.back() == '\r') {
+                field.remove_suffix(1);
+            }
+            if (!skipEmpty || !field.empty()) {
+                co_yield field;
+            }
+            carry.clear();
+            position = found + delimiterLength;
+        }
+        carry.append(chunk.substr(position));
+    }
+    
+    // 最后一个字段；按行读取时以换行结尾的数据没有额外的空行
+    std::string_view field(carry);
+    if (lines && !field.empty() && field.back() == '\r') {
+        field.remove_suffix(1);
+    }
+    if (lines ? !carry.empty() : (!skipEmpty || !field.empty())) {
+        co_yield field;
+    }
+}
+
+} // namespace detail
+
+/**
+ * 按分隔符分割分块到达的数据，产出字段的视图
+ * source()返回可等待对象，结果是下一块数据（std::optional<std::string_view>），结束时为std::nullopt；
+ * 一块数据在下一次调用source()前必须保持有效。字段在取下一个值前有效。
+ * 字段规则与bs_split_iter相同，flags可以是BS_SPLIT_SKIP_EMPTY
+ */
+template <typename Source>
+AsyncGenerator<std::string_view> async_split(Source source, std::string_view delimiter, unsigned flags = 0) {
+    if (delimiter.empty()) {
+        throw std::invalid_argument("async_split delimiter must not be empty");
+    }
+    return detail::splitChunks(std::move(source), std::string(delimiter), flags, false);
+}
+
+/**
+ * 按行产出视图，不含行尾的"\n"或"\r\n"，与bs_line_reader一致
+ */
+template <typename Source>
+AsyncGenerator<std::string_view> async_lines(Source source) {
+    return detail::splitChunks(std::move(source), std::string("\n"), 0, true);
+}
+#endif // BS_HAVE_COROUTINES
+
+// 非成员函数定义
+inline String operator+(const char* lhs, const String& rhs) {
+    return String(lhs) + rhs;
+}
+
+inline String operator+(const std::string& lhs, const String& rhs) {
+    return String(lhs) + rhs;
+}
+
+inline std::ostream& operator<<(std::ostream& os, const String& str) {
+    os << str.c_str();
+    return os;
+}
+
+inline std::istream& operator>>(std::istream& is, String& str) {
+    std::string temp;
+    is >> temp;
+    str = temp;
+    return is;
+}
+
+} // namespace bs
+
+// 添加STL兼容的哈希支持
+namespace std {
+    template <>
+    struct hash<bs::String> {
+        size_t operator()(const bs::String& str) const noexcept {
+            return static_cast<size_t>(bs_string_hash(str.getCString()));
+        }
+    };
+    
+    template <>
+    struct hash<bs::InternedString> {
+        size_t operator()(const bs::InternedString& str) const noexcept {
+            return static_cast<size_t>(str.hash());
+        }
+    };
+}
 
 #endif // BETTER_STRING_SINGLE_HPP 
\ No newline at end of file